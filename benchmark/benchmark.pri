@@ -0,0 +1,9 @@
+CONFIG += c++14 console
+
+CONFIG -= app_bundle
+
+QT += core gui
+
+INCLUDEPATH += $$PWD/../include
+
+LIBS += -L$$PWD/../lib -ldeepdf
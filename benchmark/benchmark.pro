@@ -0,0 +1,12 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    docscaling \
+    compositing \
+    stretching \
+    fileaccess \
+    incrementalsave \
+    textindex \
+    textmemory \
+    thumbnails \
+    imagecache
@@ -0,0 +1,376 @@
+/**
+ * 扫描线合成SSE2内核的一致性检查和性能测试
+ * 对每个有SSE2内核的普通混合路径,比较SSE2和标量实现的合成结果是否逐字节相同:
+ * Argb到Argb和Argb到Rgb32遍历源颜色,背景颜色和透明度的全部字节组合,
+ * 带裁剪的路径遍历裁剪值和透明度的全部组合,蒙版路径遍历蒙版值,蒙版透明度和背景透明度的全部组合,
+ * 最后用随机宽度和随机对齐的行检查每行末尾不足4个像素的部分
+ * 一致性检查通过后测量每个路径标量和SSE2实现的吞吐量
+ *
+ * 用法: deepdf-compositing [-w 行宽] [-r 重复次数] [-q 只做一致性检查]
+ * 结果不一致时返回1
+ */
+#include "core/fxcrt/fx_memory.h"
+#include "core/fxge/dib/cfx_scanlinecompositor.h"
+#include "core/fxge/dib/fx_dib_sse2.h"
+#include "core/fxge/fx_dib.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Row = std::vector<uint8_t>;
+
+/**
+ * @brief 一条有SSE2内核的合成路径
+ */
+struct Case {
+    const char *name;
+    FXDIB_Format destFormat;
+    FXDIB_Format srcFormat;
+    int srcBpp;
+    bool clip;
+};
+
+const Case kArgb2Argb = {"argb->argb", FXDIB_Argb, FXDIB_Argb, 4, false};
+const Case kArgb2ArgbClip = {"argb->argb clip", FXDIB_Argb, FXDIB_Argb, 4, true};
+const Case kRgb322Argb = {"rgb32->argb", FXDIB_Argb, FXDIB_Rgb32, 4, false};
+const Case kArgb2Rgb32 = {"argb->rgb32", FXDIB_Rgb32, FXDIB_Argb, 4, false};
+const Case kArgb2Rgb32Clip = {"argb->rgb32 clip", FXDIB_Rgb32, FXDIB_Argb, 4, true};
+const Case kByteMask2Argb = {"bytemask->argb", FXDIB_Argb, FXDIB_8bppMask, 1, false};
+
+const Case *const kCases[] = {&kArgb2Argb, &kArgb2ArgbClip, &kRgb322Argb, &kArgb2Rgb32, &kArgb2Rgb32Clip, &kByteMask2Argb};
+
+/**
+ * @brief 一行的合成输入 蒙版路径的颜色和透明度来自maskColor
+ */
+struct Line {
+    Row dest;
+    Row src;
+    Row clip;
+    uint32_t maskColor = 0;
+    int width = 0;
+
+    void resize(const Case &c, int pixels)
+    {
+        width = pixels;
+        dest.resize(pixels * 4);
+        src.resize(pixels * c.srcBpp);
+        clip.resize(pixels);
+    }
+};
+
+void composite(const Case &c, CFX_ScanlineCompositor &compositor, uint8_t *dest, const Line &line)
+{
+    if (c.srcFormat == FXDIB_8bppMask)
+        compositor.CompositeByteMaskLine(dest, line.src.data(), line.width, nullptr, nullptr);
+    else
+        compositor.CompositeRgbBitmapLine(dest, line.src.data(), line.width, c.clip ? line.clip.data() : nullptr, nullptr, nullptr);
+}
+
+/**
+ * @brief 分别用标量和SSE2实现合成line,结果不同时打印第一个不同的像素
+ * @param offset 目标行相对16字节对齐的偏移
+ */
+bool check(const Case &c, const Line &line, int offset = 0)
+{
+    Row results[2];
+
+    for (int sse2 = 0; sse2 < 2; ++sse2) {
+        FXDIB_SetSSE2Enabled(sse2 != 0);
+
+        CFX_ScanlineCompositor compositor;
+        compositor.Init(c.destFormat, c.srcFormat, line.width, nullptr, line.maskColor, BlendMode::kNormal, c.clip, false);
+
+        results[sse2].assign(offset, 0);
+        results[sse2].insert(results[sse2].end(), line.dest.begin(), line.dest.end());
+        composite(c, compositor, results[sse2].data() + offset, line);
+    }
+
+    if (results[0] == results[1])
+        return true;
+
+    for (int i = 0; i < line.width; ++i) {
+        const uint8_t *scalar = results[0].data() + offset + i * 4;
+        const uint8_t *sse2 = results[1].data() + offset + i * 4;
+
+        if (memcmp(scalar, sse2, 4) == 0)
+            continue;
+
+        const uint8_t *dest = line.dest.data() + i * 4;
+        const uint8_t *src = line.src.data() + i * c.srcBpp;
+
+        fprintf(stderr, "%s: pixel %d of %d differs\n", c.name, i, line.width);
+        fprintf(stderr, "  dest   %3d %3d %3d %3d\n", dest[0], dest[1], dest[2], dest[3]);
+        if (c.srcBpp == 4)
+            fprintf(stderr, "  src    %3d %3d %3d %3d\n", src[0], src[1], src[2], src[3]);
+        else
+            fprintf(stderr, "  mask   %3d color %08x\n", src[0], line.maskColor);
+        if (c.clip)
+            fprintf(stderr, "  clip   %3d\n", line.clip[i]);
+        fprintf(stderr, "  scalar %3d %3d %3d %3d\n", scalar[0], scalar[1], scalar[2], scalar[3]);
+        fprintf(stderr, "  sse2   %3d %3d %3d %3d\n", sse2[0], sse2[1], sse2[2], sse2[3]);
+        break;
+    }
+
+    return false;
+}
+
+/**
+ * @brief 颜色通道遍历全部(源,背景)字节组合所需的像素数 每个像素有3个颜色通道
+ */
+constexpr int kColorPairPixels = (256 * 256 + 2) / 3;
+
+/**
+ * @brief 第i个颜色通道的(源,背景)字节组合
+ */
+inline void colorPair(int i, uint8_t &src, uint8_t &dest)
+{
+    src = static_cast<uint8_t>((i & 0xffff) >> 8);
+    dest = static_cast<uint8_t>(i & 0xff);
+}
+
+/**
+ * @brief Argb到Argb和Argb到Rgb32: 遍历源透明度,背景透明度和全部颜色字节组合
+ */
+bool sweepColors(const Case &c)
+{
+    Line line;
+    line.resize(c, kColorPairPixels);
+
+    //Rgb32背景的第4个字节不是透明度,只需要遍历一次
+    const int backAlphas = c.destFormat == FXDIB_Argb ? 256 : 1;
+
+    for (int i = 0; i < kColorPairPixels; ++i) {
+        for (int channel = 0; channel < 3; ++channel)
+            colorPair(i * 3 + channel, line.src[i * 4 + channel], line.dest[i * 4 + channel]);
+
+        line.dest[i * 4 + 3] = static_cast<uint8_t>(i);
+    }
+
+    for (int srcAlpha = 0; srcAlpha < 256; ++srcAlpha) {
+        for (int backAlpha = 0; backAlpha < backAlphas; ++backAlpha) {
+            for (int i = 0; i < kColorPairPixels; ++i) {
+                line.src[i * 4 + 3] = static_cast<uint8_t>(srcAlpha);
+
+                if (backAlphas > 1)
+                    line.dest[i * 4 + 3] = static_cast<uint8_t>(backAlpha);
+            }
+
+            if (!check(c, line))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 带裁剪的路径: 遍历裁剪值,源透明度和背景透明度,颜色随机
+ */
+bool sweepClip(const Case &c, std::mt19937 &random)
+{
+    Line line;
+    line.resize(c, 256);
+
+    for (int clip = 0; clip < 256; ++clip) {
+        for (int srcAlpha = 0; srcAlpha < 256; ++srcAlpha) {
+            for (int i = 0; i < 256; ++i) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    line.src[i * 4 + channel] = static_cast<uint8_t>(random());
+                    line.dest[i * 4 + channel] = static_cast<uint8_t>(random());
+                }
+
+                line.src[i * 4 + 3] = static_cast<uint8_t>(srcAlpha);
+                line.dest[i * 4 + 3] = static_cast<uint8_t>(i);
+                line.clip[i] = static_cast<uint8_t>(clip);
+            }
+
+            if (!check(c, line))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 蒙版路径: 遍历蒙版透明度,蒙版值和背景透明度,蒙版颜色取16组,背景颜色随机
+ */
+bool sweepMask(const Case &c, std::mt19937 &random)
+{
+    Line line;
+    line.resize(c, 256 * 256);
+
+    for (int maskAlpha = 0; maskAlpha < 256; ++maskAlpha) {
+        for (int color = 0; color < 256; color += 17) {
+            line.maskColor = ArgbEncode(maskAlpha, color, 255 - color, (color * 7) & 0xff);
+
+            for (int i = 0; i < line.width; ++i) {
+                line.src[i] = static_cast<uint8_t>(i >> 8);
+
+                for (int channel = 0; channel < 3; ++channel)
+                    line.dest[i * 4 + channel] = static_cast<uint8_t>(random());
+
+                line.dest[i * 4 + 3] = static_cast<uint8_t>(i);
+            }
+
+            if (!check(c, line))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 透明度偏向0和255 这两个值在内核里有单独的分支
+ */
+uint8_t randomAlpha(std::mt19937 &random)
+{
+    switch (random() % 4) {
+    case 0:
+        return 0;
+    case 1:
+        return 255;
+    default:
+        return static_cast<uint8_t>(random());
+    }
+}
+
+void fillRandom(const Case &c, Line &line, std::mt19937 &random)
+{
+    for (auto &value : line.dest)
+        value = static_cast<uint8_t>(random());
+
+    for (auto &value : line.src)
+        value = static_cast<uint8_t>(random());
+
+    for (auto &value : line.clip)
+        value = randomAlpha(random);
+
+    for (int i = 0; i < line.width; ++i) {
+        line.dest[i * 4 + 3] = randomAlpha(random);
+
+        if (c.srcBpp == 4)
+            line.src[i * 4 + 3] = randomAlpha(random);
+        else
+            line.src[i] = randomAlpha(random);
+    }
+
+    line.maskColor = ArgbEncode(randomAlpha(random), random() & 0xff, random() & 0xff, random() & 0xff);
+}
+
+/**
+ * @brief 随机宽度和对齐 覆盖每行末尾由标量代码处理的部分
+ */
+bool checkRandomRows(const Case &c, std::mt19937 &random)
+{
+    Line line;
+
+    for (int i = 0; i < 20000; ++i) {
+        line.resize(c, 1 + random() % 67);
+        fillRandom(c, line, random);
+
+        if (!check(c, line, random() % 16))
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief 返回每秒合成的像素数(百万)
+ */
+double measure(const Case &c, const Line &line, int repeat, bool sse2)
+{
+    FXDIB_SetSSE2Enabled(sse2);
+
+    CFX_ScanlineCompositor compositor;
+    compositor.Init(c.destFormat, c.srcFormat, line.width, nullptr, line.maskColor, BlendMode::kNormal, c.clip, false);
+
+    Row dest = line.dest;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int r = 0; r < repeat; ++r) {
+        //每次从同一背景开始,否则背景很快变为不透明
+        memcpy(dest.data(), line.dest.data(), dest.size());
+        composite(c, compositor, dest.data(), line);
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return line.width * static_cast<double>(repeat) / elapsed.count() / 1e6;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int width = 2048;
+    int repeat = 20000;
+    bool checkOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            checkOnly = true;
+        } else {
+            fprintf(stderr, "usage: %s [-w width] [-r repeat] [-q]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (width <= 0 || repeat <= 0) {
+        fprintf(stderr, "usage: %s [-w width] [-r repeat] [-q]\n", argv[0]);
+        return 1;
+    }
+
+    FXMEM_InitializePartitionAlloc();
+
+    if (!FXDIB_IsSSE2Enabled()) {
+        printf("SSE2 kernels are not available on this CPU or build, nothing to compare\n");
+        return 0;
+    }
+
+    std::mt19937 random(20201017);
+
+    const bool exact = sweepColors(kArgb2Argb) && sweepClip(kArgb2ArgbClip, random) && sweepColors(kArgb2Rgb32)
+                       && sweepClip(kArgb2Rgb32Clip, random) && sweepMask(kByteMask2Argb, random);
+
+    if (!exact)
+        return 1;
+
+    for (const Case *c : kCases) {
+        if (!checkRandomRows(*c, random))
+            return 1;
+    }
+
+    printf("SSE2 and scalar results are identical\n");
+
+    if (checkOnly)
+        return 0;
+
+    printf("%-18s %12s %12s %8s\n", "path", "scalar Mpx/s", "sse2 Mpx/s", "speedup");
+
+    for (const Case *c : kCases) {
+        Line line;
+        line.resize(*c, width);
+        fillRandom(*c, line, random);
+
+        const double scalar = measure(*c, line, repeat, false);
+        const double sse2 = measure(*c, line, repeat, true);
+
+        printf("%-18s %12.1f %12.1f %8.2f\n", c->name, scalar, sse2, sse2 / scalar);
+    }
+
+    return 0;
+}
@@ -0,0 +1,10 @@
+TARGET = deepdf-compositing
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+include($$PWD/../pdfium.pri)
+
+SOURCES += \
+    $$PWD/compositing.cpp
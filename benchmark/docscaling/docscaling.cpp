@@ -0,0 +1,168 @@
+/**
+ * 多文档并发渲染的扩展性测试
+ * 每个线程独立打开一份文档并逐页渲染,线程数从1倍增到核心数,
+ * 输出每秒渲染页数和相对单线程的加速比;加速比接近线程数说明不同文档之间没有互相阻塞
+ *
+ * 用法: deepdf-docscaling [-t 最大线程数] [-p 每个文档渲染页数] [-r 重复次数] file.pdf [file.pdf ...]
+ * 多个文件时线程轮流使用
+ */
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#include <cstdio>
+#include <memory>
+
+namespace {
+
+struct Options {
+    QStringList files;
+    int maxThreads = 0;
+    int pages = 20;
+    int repeat = 1;
+};
+
+class RenderThread : public QThread
+{
+public:
+    RenderThread(const QString &file, const Options &options) : m_file(file), m_options(options)
+    {
+    }
+
+    int renderedPages() const
+    {
+        return m_renderedPages;
+    }
+
+protected:
+    void run() override
+    {
+        //每个线程各自的文档,只共享pdfium内部的字体等全局状态
+        DPdfDoc doc(m_file);
+
+        if (!doc.isValid())
+            return;
+
+        const int pages = qMin(m_options.pages, doc.pageCount());
+
+        for (int r = 0; r < m_options.repeat; ++r) {
+            for (int i = 0; i < pages; ++i) {
+                DPdfPage *page = doc.page(i, 96, 96);
+
+                if (nullptr == page)
+                    continue;
+
+                const QSizeF &size = page->sizeF();
+
+                const QImage &image = page->image(qRound(size.width()), qRound(size.height()));
+
+                if (!image.isNull())
+                    ++m_renderedPages;
+            }
+        }
+    }
+
+private:
+    QString m_file;
+    Options m_options;
+    int m_renderedPages = 0;
+};
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if ((arg == QLatin1String("-t") || arg == QLatin1String("-p") || arg == QLatin1String("-r")) && i + 1 < args.size()) {
+            const int value = args[++i].toInt();
+
+            if (arg == QLatin1String("-t"))
+                options.maxThreads = value;
+            else if (arg == QLatin1String("-p"))
+                options.pages = value;
+            else
+                options.repeat = value;
+        } else {
+            options.files.append(arg);
+        }
+    }
+
+    return !options.files.isEmpty() && options.pages > 0 && options.repeat > 0;
+}
+
+/**
+ * @brief 同时运行threads个线程,返回每秒渲染页数
+ */
+double measure(int threads, const Options &options)
+{
+    QVector<std::shared_ptr<RenderThread>> workers;
+
+    for (int i = 0; i < threads; ++i)
+        workers.append(std::make_shared<RenderThread>(options.files[i % options.files.size()], options));
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const auto &worker : workers)
+        worker->start();
+
+    int renderedPages = 0;
+
+    for (const auto &worker : workers) {
+        worker->wait();
+        renderedPages += worker->renderedPages();
+    }
+
+    const qint64 elapsed = qMax<qint64>(1, timer.elapsed());
+
+    return renderedPages * 1000.0 / elapsed;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-t threads] [-p pages] [-r repeat] file.pdf [file.pdf ...]\n", argv[0]);
+        return 1;
+    }
+
+    if (options.maxThreads <= 0)
+        options.maxThreads = QThread::idealThreadCount();
+
+    //预热 字体和系统字体列表只在第一次加载
+    measure(1, options);
+
+    //1,2,4...直到核心数
+    QVector<int> threadCounts;
+
+    for (int threads = 1; threads < options.maxThreads; threads *= 2)
+        threadCounts.append(threads);
+
+    threadCounts.append(options.maxThreads);
+
+    printf("threads  pages/s  speedup\n");
+
+    double base = 0;
+
+    for (int threads : threadCounts) {
+        const double rate = measure(threads, options);
+
+        if (threads == 1)
+            base = rate;
+
+        printf("%7d  %7.1f  %7.2f\n", threads, rate, base > 0 ? rate / base : 0.0);
+    }
+
+    return 0;
+}
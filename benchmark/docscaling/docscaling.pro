@@ -0,0 +1,8 @@
+TARGET = deepdf-docscaling
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/docscaling.cpp
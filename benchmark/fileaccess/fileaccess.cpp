@@ -0,0 +1,195 @@
+/**
+ * 按需读取(READ_FILE)和内存映射(MAPPED_FILE)两种加载方式的对比测试
+ * 每次打开前用POSIX_FADV_DONTNEED把文件移出页缓存,模拟冷启动,
+ * 打开文档,取得所有页面大小并渲染首页,输出耗时,read系统调用次数和读取字节数(/proc/self/io)以及缺页次数
+ * 映射方式的数据通过缺页读入,不计入read次数
+ *
+ * 用法: deepdf-fileaccess [-r 重复次数] [-w 不清除页缓存] file.pdf [file.pdf ...]
+ */
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QStringList>
+
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+namespace {
+
+struct Options {
+    QStringList files;
+    int repeat = 3;
+    bool warm = false;
+};
+
+/**
+ * @brief 一次打开的开销
+ */
+struct Cost {
+    qint64 msecs = 0;
+    qint64 readCalls = 0;       //read类系统调用次数
+    qint64 readBytes = 0;       //read类系统调用读取的字节数
+    qint64 majorFaults = 0;     //需要读磁盘的缺页
+    qint64 minorFaults = 0;     //页已在页缓存中的缺页
+
+    void add(const Cost &other)
+    {
+        msecs += other.msecs;
+        readCalls += other.readCalls;
+        readBytes += other.readBytes;
+        majorFaults += other.majorFaults;
+        minorFaults += other.minorFaults;
+    }
+};
+
+/**
+ * @brief 读取/proc/self/io和getrusage的计数,耗时不填
+ */
+Cost counters()
+{
+    Cost cost;
+
+    QFile io(QStringLiteral("/proc/self/io"));
+
+    if (io.open(QIODevice::ReadOnly)) {
+        for (const QByteArray &line : io.readAll().split('\n')) {
+            if (line.startsWith("syscr:"))
+                cost.readCalls = line.mid(6).trimmed().toLongLong();
+            else if (line.startsWith("rchar:"))
+                cost.readBytes = line.mid(6).trimmed().toLongLong();
+        }
+    }
+
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        cost.majorFaults = usage.ru_majflt;
+        cost.minorFaults = usage.ru_minflt;
+    }
+
+    return cost;
+}
+
+/**
+ * @brief 把文件移出页缓存 只对未修改的页生效,不需要root权限
+ */
+void dropPageCache(const QString &file)
+{
+    const int fd = ::open(QFile::encodeName(file).constData(), O_RDONLY);
+
+    if (fd < 0)
+        return;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+}
+
+/**
+ * @brief 打开文档,取得所有页面大小并渲染首页
+ * @return 文档无法打开时返回false
+ */
+bool openDocument(const QString &file, DPdfDoc::LoadMode mode, Cost &cost)
+{
+    const Cost &before = counters();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    {
+        DPdfDoc doc(file, QString(), mode);
+
+        if (!doc.isValid())
+            return false;
+
+        doc.pageSizes();
+
+        DPdfPage *page = doc.page(0, 96, 96);
+
+        if (nullptr != page) {
+            const QSizeF &size = page->sizeF();
+            page->image(qRound(size.width()), qRound(size.height()));
+        }
+    }
+
+    cost.msecs = timer.elapsed();
+
+    const Cost &after = counters();
+
+    //QFile读取/proc/self/io本身的一次read计入before之后,影响可以忽略
+    cost.readCalls = after.readCalls - before.readCalls;
+    cost.readBytes = after.readBytes - before.readBytes;
+    cost.majorFaults = after.majorFaults - before.majorFaults;
+    cost.minorFaults = after.minorFaults - before.minorFaults;
+
+    return true;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-r") && i + 1 < args.size())
+            options.repeat = args[++i].toInt();
+        else if (arg == QLatin1String("-w"))
+            options.warm = true;
+        else
+            options.files.append(arg);
+    }
+
+    return !options.files.isEmpty() && options.repeat > 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-r repeat] [-w] file.pdf [file.pdf ...]\n", argv[0]);
+        return 1;
+    }
+
+    const DPdfDoc::LoadMode modes[] = {DPdfDoc::READ_FILE, DPdfDoc::MAPPED_FILE};
+    const char *const modeNames[] = {"read", "mapped"};
+
+    printf("%-7s %9s %10s %12s %10s %10s\n", "mode", "open ms", "read calls", "read bytes", "major flt", "minor flt");
+
+    for (int m = 0; m < 2; ++m) {
+        Cost total;
+
+        for (int r = 0; r < options.repeat; ++r) {
+            for (const QString &file : options.files) {
+                if (!options.warm)
+                    dropPageCache(file);
+
+                Cost cost;
+
+                if (!openDocument(file, modes[m], cost)) {
+                    fprintf(stderr, "cannot open %s\n", qPrintable(file));
+                    return 1;
+                }
+
+                total.add(cost);
+            }
+        }
+
+        //每次打开的平均值
+        const int runs = options.repeat * options.files.size();
+
+        printf("%-7s %9.1f %10lld %12lld %10lld %10lld\n", modeNames[m], total.msecs / double(runs), total.readCalls / runs,
+               total.readBytes / runs, total.majorFaults / runs, total.minorFaults / runs);
+    }
+
+    return 0;
+}
@@ -0,0 +1,8 @@
+TARGET = deepdf-fileaccess
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/fileaccess.cpp
@@ -0,0 +1,146 @@
+/**
+ * 文档级解码图片缓存的性能测试和一致性检查
+ * 同时打开两份文档,一份使用解码图片缓存,一份关闭缓存(预算为0),页面缓存预算都为0,和阅读时页面缓存已满一样每页都重新解析,
+ * 逐页渲染多轮(第二轮起相当于来回翻页),输出每轮两者的耗时和缓存的命中,未命中,缓存图片数,占用和释放次数
+ * 两份文档渲染的每一页必须完全相同,不同时返回1
+ *
+ * 用法: deepdf-imagecache [-p 页数] [-r 轮数] [-d 分辨率] [-b 缓存预算MB] file.pdf
+ * 没有指定预算时使用默认预算
+ */
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+
+#include <cstdio>
+
+namespace {
+
+struct Options {
+    QString file;
+    int pages = 50;
+    int repeat = 2;
+    int dpi = 96;
+    int budget = -1;
+};
+
+/**
+ * @brief 渲染一页并累计耗时
+ */
+QImage renderPage(DPdfDoc &doc, int index, int dpi, qint64 &msecs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QImage image;
+
+    DPdfPage *page = doc.page(index, dpi, dpi);
+
+    if (nullptr != page) {
+        const QSizeF &size = page->sizeF();
+        image = page->image(qRound(size.width()), qRound(size.height()));
+    }
+
+    msecs += timer.elapsed();
+
+    return image;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-p") && i + 1 < args.size())
+            options.pages = args[++i].toInt();
+        else if (arg == QLatin1String("-r") && i + 1 < args.size())
+            options.repeat = args[++i].toInt();
+        else if (arg == QLatin1String("-d") && i + 1 < args.size())
+            options.dpi = args[++i].toInt();
+        else if (arg == QLatin1String("-b") && i + 1 < args.size())
+            options.budget = args[++i].toInt();
+        else if (options.file.isEmpty())
+            options.file = arg;
+        else
+            return false;
+    }
+
+    return !options.file.isEmpty() && options.pages > 0 && options.repeat > 0 && options.dpi > 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-p pages] [-r repeat] [-d dpi] [-b budget MB] file.pdf\n", argv[0]);
+        return 1;
+    }
+
+    DPdfDoc cached(options.file);
+    DPdfDoc uncached(options.file);
+
+    if (!cached.isValid() || !uncached.isValid()) {
+        fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+        return 1;
+    }
+
+    cached.setPageCacheBudget(0);
+    uncached.setPageCacheBudget(0);
+
+    if (options.budget >= 0)
+        cached.setImageCacheBudget(qint64(options.budget) * 1024 * 1024);
+
+    uncached.setImageCacheBudget(0);
+
+    const int pages = qMin(options.pages, cached.pageCount());
+
+    printf("%s, %d pages at %d dpi, image cache budget %lld bytes\n", qPrintable(options.file), pages, options.dpi,
+           cached.imageCacheBudget());
+    printf("%5s %11s %11s %8s %8s %8s %12s %10s\n", "round", "cached ms", "no cache ms", "hits", "misses", "images", "cache bytes",
+           "evictions");
+
+    bool exact = true;
+
+    for (int r = 0; r < options.repeat; ++r) {
+        qint64 cachedTime = 0;
+        qint64 uncachedTime = 0;
+
+        const DPdfDoc::ImageCacheStats &before = cached.imageCacheStats();
+
+        for (int i = 0; i < pages; ++i) {
+            //交替先后顺序,减少系统页缓存等对先渲染者的不利影响
+            const bool cachedFirst = (i + r) % 2 == 0;
+
+            QImage a;
+            QImage b;
+
+            if (cachedFirst) {
+                a = renderPage(cached, i, options.dpi, cachedTime);
+                b = renderPage(uncached, i, options.dpi, uncachedTime);
+            } else {
+                b = renderPage(uncached, i, options.dpi, uncachedTime);
+                a = renderPage(cached, i, options.dpi, cachedTime);
+            }
+
+            if (a != b) {
+                fprintf(stderr, "round %d page %d: the rendering with the image cache differs\n", r, i);
+                exact = false;
+            }
+        }
+
+        const DPdfDoc::ImageCacheStats &after = cached.imageCacheStats();
+
+        printf("%5d %11lld %11lld %8lld %8lld %8d %12lld %10lld\n", r, cachedTime, uncachedTime, after.hits - before.hits,
+               after.misses - before.misses, after.images, after.usage, after.evictions - before.evictions);
+    }
+
+    return exact ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+TARGET = deepdf-imagecache
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/imagecache.cpp
@@ -0,0 +1,187 @@
+/**
+ * 增量保存和整体重写的对比测试
+ * 在文档副本的首页添加一个高亮注释后分别用save()和saveIncremental()保存,
+ * 输出保存耗时,写入字节数(/proc/self/io的wchar)和保存后的文件大小,
+ * 并重新打开保存的文件检查新注释都在,保存结果不正确时返回1
+ *
+ * 用法: deepdf-incrementalsave [-r 重复次数] file.pdf
+ * 每次重复在同一副本上再添加一个注释并保存,可以看到连续增量保存时文件的增长
+ */
+#include "dpdfannot.h"
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QColor>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+namespace {
+
+struct Options {
+    QString file;
+    int repeat = 3;
+};
+
+/**
+ * @brief 本进程已写入的字节数
+ */
+qint64 writtenBytes()
+{
+    QFile io(QStringLiteral("/proc/self/io"));
+
+    if (!io.open(QIODevice::ReadOnly))
+        return 0;
+
+    for (const QByteArray &line : io.readAll().split('\n')) {
+        if (line.startsWith("wchar:"))
+            return line.mid(6).trimmed().toLongLong();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 首页的高亮注释数
+ * @return 文档无法打开返回-1
+ */
+int highlightCount(const QString &file)
+{
+    DPdfDoc doc(file);
+
+    if (!doc.isValid())
+        return -1;
+
+    DPdfPage *page = doc.page(0, 72, 72);
+
+    if (nullptr == page)
+        return -1;
+
+    int count = 0;
+
+    for (DPdfAnnot *annot : page->annots()) {
+        if (annot->type() == DPdfAnnot::AHighlight)
+            ++count;
+    }
+
+    return count;
+}
+
+/**
+ * @brief 在首页添加一个高亮注释后保存 每次的位置不同
+ * @return 保存失败返回false
+ */
+bool annotateAndSave(const QString &file, bool incremental, int round, qint64 &msecs, qint64 &bytes)
+{
+    DPdfDoc doc(file);
+
+    if (!doc.isValid())
+        return false;
+
+    DPdfPage *page = doc.page(0, 72, 72);
+
+    if (nullptr == page)
+        return false;
+
+    const QRectF rect(36, 36 + round * 24 % qMax(1, qRound(page->sizeF().height()) - 72), 200, 18);
+
+    if (nullptr == page->createHightLightAnnot({rect}, QStringLiteral("benchmark"), QColor(Qt::yellow)))
+        return false;
+
+    const qint64 written = writtenBytes();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool saved = incremental ? doc.saveIncremental() : doc.save();
+
+    msecs = timer.elapsed();
+    bytes = writtenBytes() - written;
+
+    return saved;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-r") && i + 1 < args.size())
+            options.repeat = args[++i].toInt();
+        else if (options.file.isEmpty())
+            options.file = arg;
+        else
+            return false;
+    }
+
+    return !options.file.isEmpty() && options.repeat > 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-r repeat] file.pdf\n", argv[0]);
+        return 1;
+    }
+
+    QTemporaryDir dir;
+
+    if (!dir.isValid()) {
+        fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+
+    const int original = highlightCount(options.file);
+
+    if (original < 0) {
+        fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+        return 1;
+    }
+
+    printf("%s, %lld bytes\n", qPrintable(options.file), QFileInfo(options.file).size());
+    printf("%-12s %5s %9s %14s %14s\n", "mode", "round", "save ms", "bytes written", "file size");
+
+    const char *const modeNames[] = {"full", "incremental"};
+
+    for (int incremental = 0; incremental < 2; ++incremental) {
+        const QString &copy = dir.filePath(QStringLiteral("copy%1.pdf").arg(incremental));
+
+        if (!QFile::copy(options.file, copy)) {
+            fprintf(stderr, "cannot copy %s\n", qPrintable(options.file));
+            return 1;
+        }
+
+        for (int round = 0; round < options.repeat; ++round) {
+            qint64 msecs = 0;
+            qint64 bytes = 0;
+
+            if (!annotateAndSave(copy, incremental != 0, round, msecs, bytes)) {
+                fprintf(stderr, "%s save failed in round %d\n", modeNames[incremental], round);
+                return 1;
+            }
+
+            printf("%-12s %5d %9lld %14lld %14lld\n", modeNames[incremental], round, msecs, bytes, QFileInfo(copy).size());
+        }
+
+        //保存的文件可以打开,并且每次添加的注释都在
+        const int count = highlightCount(copy);
+
+        if (count != original + options.repeat) {
+            fprintf(stderr, "%s: expected %d highlights after saving, found %d\n", modeNames[incremental], original + options.repeat, count);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,8 @@
+TARGET = deepdf-incrementalsave
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/incrementalsave.cpp
@@ -0,0 +1,5 @@
+#直接调用pdfium内部实现的测试 pdfium的符号由libdeepdf导出
+
+INCLUDEPATH += $$PWD/../src/3rdparty/pdfium/pdfium
+
+DEFINES += __QT__
@@ -0,0 +1,300 @@
+/**
+ * 图像缩放(CStretchEngine)SSE2内核的一致性检查和性能测试
+ * 用随机内容的位图,随机缩放比例,翻转和裁剪区域,分别以标量和SSE2实现缩放,比较结果是否逐字节相同,
+ * 覆盖不插值,双线性和双三次插值,双三次插值的权重有负值
+ * 一致性检查通过后测量8位,24位和32位位图在0.1x,0.5x和2x缩放下标量和SSE2实现的耗时
+ *
+ * 用法: deepdf-stretching [-s 宽x高] [-r 重复次数] [-n 随机检查次数] [-q 只做一致性检查]
+ * 结果不一致时返回1
+ */
+#include "core/fxcrt/fx_memory.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "core/fxge/dib/cfx_bitmapstorer.h"
+#include "core/fxge/dib/cfx_dibitmap.h"
+#include "core/fxge/dib/cstretchengine.h"
+#include "core/fxge/dib/fx_dib_sse2.h"
+#include "core/fxge/fx_dib.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace {
+
+/**
+ * @brief 源格式 缩放后的格式和CFX_ImageStretcher的选择一致
+ */
+struct Format {
+    const char *name;
+    FXDIB_Format src;
+    FXDIB_Format dest;
+    bool palette;
+};
+
+const Format kFormats[] = {
+    {"1bpp", FXDIB_1bppRgb, FXDIB_8bppRgb, false},
+    {"8bpp", FXDIB_8bppRgb, FXDIB_8bppRgb, false},
+    {"8bpp mask", FXDIB_8bppMask, FXDIB_8bppMask, false},
+    {"8bpp palette", FXDIB_8bppRgb, FXDIB_Rgb, true},
+    {"24bpp", FXDIB_Rgb, FXDIB_Rgb, false},
+    {"32bpp", FXDIB_Rgb32, FXDIB_Rgb32, false},
+    {"32bpp argb", FXDIB_Argb, FXDIB_Argb, false},
+};
+
+/**
+ * @brief 一次缩放的参数 宽高为负表示翻转,clip是目标坐标里要输出的部分
+ */
+struct Stretch {
+    int destWidth = 0;
+    int destHeight = 0;
+    FX_RECT clip;
+    FXDIB_ResampleOptions options;
+};
+
+RetainPtr<CFX_DIBitmap> createBitmap(const Format &format, int width, int height, std::mt19937 &random)
+{
+    auto bitmap = pdfium::MakeRetain<CFX_DIBitmap>();
+
+    if (!bitmap->Create(width, height, format.src))
+        return nullptr;
+
+    uint8_t *buffer = bitmap->GetBuffer();
+
+    //大片相同的值和随机值混合,前者在插值后仍可能取到0和255
+    for (uint32_t i = 0; i < bitmap->GetPitch() * static_cast<uint32_t>(height); ++i)
+        buffer[i] = random() % 3 == 0 ? static_cast<uint8_t>((i / 64) % 2 * 255) : static_cast<uint8_t>(random());
+
+    if (format.palette) {
+        for (int i = 0; i < 256; ++i)
+            bitmap->SetPaletteArgb(i, ArgbEncode(255, random() & 0xff, random() & 0xff, random() & 0xff));
+    }
+
+    return bitmap;
+}
+
+/**
+ * @brief 和CFX_ImageStretcher一样缩放source,失败返回空
+ */
+RetainPtr<CFX_DIBitmap> stretch(const Format &format, const RetainPtr<CFX_DIBitmap> &source, const Stretch &params, bool sse2)
+{
+    FXDIB_SetSSE2Enabled(sse2);
+
+    CFX_BitmapStorer storer;
+
+    if (!storer.SetInfo(params.clip.Width(), params.clip.Height(), format.dest, nullptr))
+        return nullptr;
+
+    CStretchEngine engine(&storer, format.dest, params.destWidth, params.destHeight, params.clip, source, params.options);
+
+    if (!engine.StartStretchHorz())
+        return nullptr;
+
+    engine.Continue(nullptr);
+
+    return storer.Detach();
+}
+
+/**
+ * @brief 比较两个缩放结果的有效字节 每行末尾的对齐填充不比较
+ */
+bool sameBitmap(const RetainPtr<CFX_DIBitmap> &a, const RetainPtr<CFX_DIBitmap> &b, int &row)
+{
+    if (!a || !b)
+        return !a && !b;
+
+    if (a->GetWidth() != b->GetWidth() || a->GetHeight() != b->GetHeight())
+        return false;
+
+    const int bytes = (a->GetWidth() * a->GetBPP() + 7) / 8;
+
+    for (row = 0; row < a->GetHeight(); ++row) {
+        if (memcmp(a->GetScanline(row), b->GetScanline(row), bytes) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+const char *optionName(const FXDIB_ResampleOptions &options)
+{
+    if (options.bNoSmoothing)
+        return "nosmoothing";
+
+    if (options.bInterpolateBicubic)
+        return "bicubic";
+
+    if (options.bInterpolateBilinear)
+        return "bilinear";
+
+    return "default";
+}
+
+/**
+ * @brief 随机缩放比例(0.05x到3x,两个方向独立),翻转,裁剪和插值方式
+ */
+Stretch randomStretch(int srcWidth, int srcHeight, std::mt19937 &random)
+{
+    std::uniform_real_distribution<double> scale(0.05, 3.0);
+
+    Stretch params;
+    params.destWidth = std::max(1, static_cast<int>(srcWidth * scale(random)));
+    params.destHeight = std::max(1, static_cast<int>(srcHeight * scale(random)));
+
+    const int left = random() % 4 == 0 ? static_cast<int>(random() % params.destWidth) : 0;
+    const int top = random() % 4 == 0 ? static_cast<int>(random() % params.destHeight) : 0;
+    const int right = random() % 4 == 0 ? left + 1 + static_cast<int>(random() % (params.destWidth - left)) : params.destWidth;
+    const int bottom = random() % 4 == 0 ? top + 1 + static_cast<int>(random() % (params.destHeight - top)) : params.destHeight;
+    params.clip = FX_RECT(left, top, right, bottom);
+
+    if (random() % 4 == 0)
+        params.destWidth = -params.destWidth;
+
+    if (random() % 4 == 0)
+        params.destHeight = -params.destHeight;
+
+    switch (random() % 4) {
+    case 0:
+        params.options.bNoSmoothing = true;
+        break;
+    case 1:
+        params.options.bInterpolateBilinear = true;
+        break;
+    case 2:
+        params.options.bInterpolateBicubic = true;
+        break;
+    default:
+        break;
+    }
+
+    return params;
+}
+
+bool checkRandomStretches(int count, std::mt19937 &random)
+{
+    for (int i = 0; i < count; ++i) {
+        const Format &format = kFormats[i % (sizeof(kFormats) / sizeof(kFormats[0]))];
+        const int srcWidth = 1 + random() % 300;
+        const int srcHeight = 1 + random() % 300;
+
+        RetainPtr<CFX_DIBitmap> source = createBitmap(format, srcWidth, srcHeight, random);
+
+        if (!source) {
+            fprintf(stderr, "%s: cannot create a %dx%d bitmap\n", format.name, srcWidth, srcHeight);
+            return false;
+        }
+
+        const Stretch params = randomStretch(srcWidth, srcHeight, random);
+
+        int row = 0;
+
+        if (!sameBitmap(stretch(format, source, params, false), stretch(format, source, params, true), row)) {
+            fprintf(stderr, "%s %s: %dx%d -> %dx%d clip (%d,%d)-(%d,%d) differs at row %d\n", format.name,
+                    optionName(params.options), srcWidth, srcHeight, params.destWidth, params.destHeight, params.clip.left,
+                    params.clip.top, params.clip.right, params.clip.bottom, row);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 交替运行标量和SSE2实现repeat次,返回各自最快一次的毫秒数 交替运行减少机器负载变化的影响
+ */
+void measure(const Format &format, const RetainPtr<CFX_DIBitmap> &source, const Stretch &params, int repeat, double best[2])
+{
+    for (int r = 0; r < repeat; ++r) {
+        for (int sse2 = 0; sse2 < 2; ++sse2) {
+            const auto start = std::chrono::steady_clock::now();
+
+            stretch(format, source, params, sse2 != 0);
+
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            if (r == 0 || elapsed.count() < best[sse2])
+                best[sse2] = elapsed.count();
+        }
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    int width = 2400;
+    int height = 3200;
+    int repeat = 7;
+    int count = 600;
+    bool checkOnly = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2)
+                width = 0;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            checkOnly = true;
+        } else {
+            width = 0;
+            break;
+        }
+    }
+
+    if (width <= 0 || height <= 0 || repeat <= 0 || count < 0) {
+        fprintf(stderr, "usage: %s [-s WIDTHxHEIGHT] [-r repeat] [-n checks] [-q]\n", argv[0]);
+        return 1;
+    }
+
+    FXMEM_InitializePartitionAlloc();
+
+    if (!FXDIB_IsSSE2Enabled()) {
+        printf("SSE2 kernels are not available on this CPU or build, nothing to compare\n");
+        return 0;
+    }
+
+    std::mt19937 random(20201017);
+
+    if (!checkRandomStretches(count, random))
+        return 1;
+
+    printf("SSE2 and scalar results are identical in %d stretches\n", count);
+
+    if (checkOnly)
+        return 0;
+
+    //和页面渲染时缩放图片一样不指定插值方式,缩小时自动使用双线性插值
+    const Format *formats[] = {&kFormats[1], &kFormats[4], &kFormats[5]};
+    const double scales[] = {0.1, 0.5, 2.0};
+
+    printf("%dx%d source, best of %d\n", width, height, repeat);
+    printf("%-6s %5s %10s %10s %8s\n", "format", "scale", "scalar ms", "sse2 ms", "speedup");
+
+    for (const Format *format : formats) {
+        RetainPtr<CFX_DIBitmap> source = createBitmap(*format, width, height, random);
+
+        if (!source) {
+            fprintf(stderr, "%s: cannot create a %dx%d bitmap\n", format->name, width, height);
+            return 1;
+        }
+
+        for (double scale : scales) {
+            Stretch params;
+            params.destWidth = static_cast<int>(width * scale);
+            params.destHeight = static_cast<int>(height * scale);
+            params.clip = FX_RECT(0, 0, params.destWidth, params.destHeight);
+
+            double best[2] = {0, 0};
+            measure(*format, source, params, repeat, best);
+
+            printf("%-6s %4.1fx %10.1f %10.1f %8.2f\n", format->name, scale, best[0], best[1], best[0] / best[1]);
+        }
+    }
+
+    return 0;
+}
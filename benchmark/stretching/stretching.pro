@@ -0,0 +1,10 @@
+TARGET = deepdf-stretching
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+include($$PWD/../pdfium.pri)
+
+SOURCES += \
+    $$PWD/stretching.cpp
@@ -0,0 +1,236 @@
+/**
+ * 全文索引的性能测试和一致性检查
+ * 先在没有索引时搜索每个关键字,再建立索引(索引文件写入临时目录)后重新搜索,
+ * 输出建立索引的耗时,索引文件大小,重新打开文档后从文件加载索引的耗时,以及每个关键字有无索引时的搜索耗时
+ * 有无索引的搜索结果(页面,位置和长度)必须相同,不同时返回1
+ *
+ * 用法: deepdf-textindex [-k 关键字]... [-r 重复次数] file.pdf
+ * 没有指定关键字时使用几个常见词,一个词的一部分和一个不存在的词
+ */
+#include "dpdfdoc.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <cstdio>
+
+namespace {
+
+struct Options {
+    QString file;
+    QStringList keywords;
+    int repeat = 3;
+};
+
+typedef QMap<int, QVector<DPdfSearchHit>> Results;
+
+/**
+ * @brief 搜索repeat次,返回最快一次的毫秒数
+ * @return 搜索无法开始或没有完成返回-1
+ */
+qint64 search(DPdfDoc &doc, const QString &keyword, int repeat, Results &results)
+{
+    qint64 best = -1;
+
+    for (int r = 0; r < repeat; ++r) {
+        QElapsedTimer timer;
+        timer.start();
+
+        QScopedPointer<DPdfSearchTask> task(doc.search(keyword));
+
+        if (task.isNull())
+            return -1;
+
+        task->wait();
+
+        const qint64 elapsed = timer.elapsed();
+
+        if (task->status() != DPdfSearchTask::FINISHED)
+            return -1;
+
+        results = task->results();
+
+        if (best < 0 || elapsed < best)
+            best = elapsed;
+    }
+
+    return best;
+}
+
+/**
+ * @brief 比较两次搜索的页面,位置和长度 区域由同一页面计算,不再比较
+ */
+bool sameResults(const Results &a, const Results &b)
+{
+    if (a.keys() != b.keys())
+        return false;
+
+    for (auto it = a.begin(); it != a.end(); ++it) {
+        const QVector<DPdfSearchHit> &hits = b.value(it.key());
+
+        if (hits.size() != it.value().size())
+            return false;
+
+        for (int i = 0; i < hits.size(); ++i) {
+            if (hits[i].charIndex != it.value()[i].charIndex || hits[i].charCount != it.value()[i].charCount)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int hitCount(const Results &results)
+{
+    int count = 0;
+
+    for (const QVector<DPdfSearchHit> &hits : results)
+        count += hits.size();
+
+    return count;
+}
+
+/**
+ * @brief 启用索引并等待后台建立完成
+ * @return 建立并写入索引文件的毫秒数,超时返回-1
+ */
+qint64 loadIndex(DPdfDoc &doc, const QString &indexDir)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (doc.loadTextIndex(indexDir))
+        return timer.elapsed();
+
+    //textIndexReady()在索引文件写入后触发
+    QEventLoop loop;
+    QObject::connect(&doc, &DPdfDoc::textIndexReady, &loop, &QEventLoop::quit);
+    QTimer::singleShot(3600 * 1000, &loop, &QEventLoop::quit);
+    loop.exec();
+
+    return doc.hasTextIndex() ? timer.elapsed() : -1;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-k") && i + 1 < args.size())
+            options.keywords.append(args[++i]);
+        else if (arg == QLatin1String("-r") && i + 1 < args.size())
+            options.repeat = args[++i].toInt();
+        else if (options.file.isEmpty())
+            options.file = arg;
+        else
+            return false;
+    }
+
+    if (options.keywords.isEmpty())
+        options.keywords << QStringLiteral("the") << QStringLiteral("and") << QStringLiteral("document") << QStringLiteral("docu") << QStringLiteral("zqxjvk");
+
+    return !options.file.isEmpty() && options.repeat > 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-k keyword]... [-r repeat] file.pdf\n", argv[0]);
+        return 1;
+    }
+
+    QTemporaryDir indexDir;
+
+    if (!indexDir.isValid()) {
+        fprintf(stderr, "cannot create a temporary directory\n");
+        return 1;
+    }
+
+    DPdfDoc doc(options.file);
+
+    if (!doc.isValid()) {
+        fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+        return 1;
+    }
+
+    QVector<Results> unindexed;
+    QVector<qint64> unindexedTimes;
+
+    for (const QString &keyword : options.keywords) {
+        Results results;
+
+        unindexedTimes.append(search(doc, keyword, options.repeat, results));
+        unindexed.append(results);
+    }
+
+    const qint64 buildTime = loadIndex(doc, indexDir.path());
+
+    if (buildTime < 0) {
+        fprintf(stderr, "building the index timed out\n");
+        return 1;
+    }
+
+    qint64 indexSize = 0;
+
+    for (const QFileInfo &info : QDir(indexDir.path()).entryInfoList(QDir::Files))
+        indexSize += info.size();
+
+    //新的文档对象从索引文件加载
+    qint64 loadTime = -1;
+
+    {
+        DPdfDoc reopened(options.file);
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if (reopened.loadTextIndex(indexDir.path()))
+            loadTime = timer.elapsed();
+    }
+
+    printf("%s, %d pages\n", qPrintable(options.file), doc.pageCount());
+    printf("index built in %lld ms, %lld bytes on disk, ", buildTime, indexSize);
+
+    if (loadTime < 0)
+        printf("not loaded from disk\n");
+    else
+        printf("loaded from disk in %lld ms\n", loadTime);
+
+    printf("%-16s %8s %8s %12s %10s\n", "keyword", "hits", "pages", "no index ms", "index ms");
+
+    bool exact = true;
+
+    for (int i = 0; i < options.keywords.size(); ++i) {
+        Results results;
+
+        const qint64 indexedTime = search(doc, options.keywords[i], options.repeat, results);
+
+        if (indexedTime < 0 || unindexedTimes[i] < 0) {
+            fprintf(stderr, "searching \"%s\" failed\n", qPrintable(options.keywords[i]));
+            return 1;
+        }
+
+        printf("%-16s %8d %8d %12lld %10lld\n", qPrintable(options.keywords[i]), hitCount(results), results.size(),
+               unindexedTimes[i], indexedTime);
+
+        if (!sameResults(unindexed[i], results)) {
+            fprintf(stderr, "\"%s\": results with the index differ from a full search\n", qPrintable(options.keywords[i]));
+            exact = false;
+        }
+    }
+
+    return exact ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+TARGET = deepdf-textindex
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/textindex.cpp
@@ -0,0 +1,158 @@
+/**
+ * 文本页内存占用测试
+ * 逐页加载文本页(相当于用户逐页滚动时选择文字或搜索),输出堆内存增长,页面缓存估算的占用和每个字符的平均占用
+ * 分两轮: 文本页数上限等于页数(全部保留,反映每个文本页的实际大小)和默认上限(反映滚动过程中内存是否有界)
+ *
+ * 用法: deepdf-textmemory [-p 页数] [-l 第二轮的文本页数上限] file.pdf
+ */
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <cstdio>
+
+#include <malloc.h>
+
+namespace {
+
+struct Options {
+    QString file;
+    int pages = 0;
+    int limit = 0;
+};
+
+/**
+ * @brief 堆上已分配的字节数 包括mmap分配的大块
+ */
+qint64 heapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+#else
+    const struct mallinfo info = mallinfo();
+#endif
+
+    return static_cast<qint64>(info.uordblks) + static_cast<qint64>(info.hblkhd);
+}
+
+/**
+ * @brief 一轮的结果
+ */
+struct Usage {
+    int pages = 0;
+    qint64 chars = 0;
+    qint64 msecs = 0;
+    qint64 heapGrowth = 0;      //结束时相对打开后的堆增长
+    qint64 peakGrowth = 0;      //过程中的最大堆增长
+    DPdfDoc::PageCacheStats stats;
+};
+
+/**
+ * @brief 打开文档,以textPageLimit为文本页数上限逐页加载文本页
+ * @return 文档无法打开返回false
+ */
+bool walkPages(const Options &options, int textPageLimit, Usage &usage)
+{
+    DPdfDoc doc(options.file);
+
+    if (!doc.isValid())
+        return false;
+
+    //只比较文本页,不让字节预算提前释放页面
+    doc.setPageCacheBudget(Q_INT64_C(1) << 40);
+    doc.setTextPageCacheLimit(textPageLimit);
+
+    usage.pages = options.pages > 0 ? qMin(options.pages, doc.pageCount()) : doc.pageCount();
+
+    const qint64 heap = heapInUse();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < usage.pages; ++i) {
+        DPdfPage *page = doc.page(i, 72, 72);
+
+        if (nullptr == page)
+            continue;
+
+        usage.chars += page->countChars();
+        usage.peakGrowth = qMax(usage.peakGrowth, heapInUse() - heap);
+    }
+
+    usage.msecs = timer.elapsed();
+    usage.heapGrowth = heapInUse() - heap;
+    usage.stats = doc.pageCacheStats();
+
+    return true;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-p") && i + 1 < args.size())
+            options.pages = args[++i].toInt();
+        else if (arg == QLatin1String("-l") && i + 1 < args.size())
+            options.limit = args[++i].toInt();
+        else if (options.file.isEmpty())
+            options.file = arg;
+        else
+            return false;
+    }
+
+    return !options.file.isEmpty() && options.pages >= 0 && options.limit >= 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-p pages] [-l limit] file.pdf\n", argv[0]);
+        return 1;
+    }
+
+    int pageCount = 0;
+    int defaultLimit = 0;
+
+    {
+        DPdfDoc doc(options.file);
+
+        if (!doc.isValid()) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+            return 1;
+        }
+
+        pageCount = doc.pageCount();
+        defaultLimit = doc.textPageCacheLimit();
+    }
+
+    const int limits[] = {qMax(1, pageCount), options.limit > 0 ? options.limit : defaultLimit};
+
+    printf("%s, %d pages\n", qPrintable(options.file), pageCount);
+    printf("%8s %6s %10s %8s %10s %12s %12s %12s %9s\n", "limit", "pages", "chars", "ms", "textpages", "cache bytes", "heap growth",
+           "heap peak", "bytes/chr");
+
+    for (int limit : limits) {
+        Usage usage;
+
+        if (!walkPages(options, limit, usage)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+            return 1;
+        }
+
+        printf("%8d %6d %10lld %8lld %10d %12lld %12lld %12lld %9.1f\n", limit, usage.pages, usage.chars, usage.msecs,
+               usage.stats.textPages, usage.stats.usage, usage.heapGrowth, usage.peakGrowth,
+               usage.chars > 0 ? usage.heapGrowth / double(usage.chars) : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,8 @@
+TARGET = deepdf-textmemory
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/textmemory.cpp
@@ -0,0 +1,149 @@
+/**
+ * 缩略图渲染时按显示大小解码图片的测试
+ * 先渲染指定宽度的缩略图,再用新的文档对象按指定分辨率渲染同样的页面,
+ * 输出每页耗时,解码图片的总字节数和进程的内存峰值
+ * 图片按绘制大小解码时,缩略图一轮的解码字节数和内存峰值应远小于整页一轮,扫描文档尤其明显
+ *
+ * 用法: deepdf-thumbnails [-p 页数] [-w 缩略图宽度] [-d 整页分辨率] file.pdf
+ * 解码字节数取自文档的解码图片缓存,测试时放大其预算使所有解码结果都留在缓存中,内联图片和超大图片不计入
+ * 内存峰值只增不减,因此先渲染缩略图
+ */
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QStringList>
+
+#include <cstdio>
+
+#include <sys/resource.h>
+
+namespace {
+
+struct Options {
+    QString file;
+    int pages = 50;
+    int width = 200;
+    int dpi = 150;
+};
+
+/**
+ * @brief 一轮渲染的结果
+ */
+struct Result {
+    int pages = 0;
+    qint64 msecs = 0;
+    qint64 peakKBytes = 0;      //到本轮结束时进程的内存峰值
+    DPdfDoc::ImageCacheStats stats;
+};
+
+qint64 peakMemory()
+{
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief 打开文档并渲染前几页 thumbnail为true时按options.width渲染缩略图,否则按options.dpi渲染整页
+ * @return 文档无法打开返回false
+ */
+bool renderPages(const Options &options, bool thumbnail, Result &result)
+{
+    DPdfDoc doc(options.file);
+
+    if (!doc.isValid())
+        return false;
+
+    //每页都重新解析和解码,解码结果全部留在图片缓存中以便统计
+    doc.setPageCacheBudget(0);
+    doc.setImageCacheBudget(Q_INT64_C(1) << 40);
+
+    const int pages = qMin(options.pages, doc.pageCount());
+
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < pages; ++i) {
+        DPdfPage *page = doc.page(i, options.dpi, options.dpi);
+
+        if (nullptr == page)
+            continue;
+
+        const QSizeF &size = page->sizeF();
+
+        if (size.isEmpty())
+            continue;
+
+        const int width = thumbnail ? options.width : qRound(size.width());
+        const int height = thumbnail ? qRound(options.width * size.height() / size.width()) : qRound(size.height());
+
+        if (!page->image(width, qMax(1, height)).isNull())
+            ++result.pages;
+    }
+
+    result.msecs = timer.elapsed();
+    result.peakKBytes = peakMemory();
+    result.stats = doc.imageCacheStats();
+
+    return true;
+}
+
+bool parseOptions(const QStringList &args, Options &options)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString &arg = args[i];
+
+        if (arg == QLatin1String("-p") && i + 1 < args.size())
+            options.pages = args[++i].toInt();
+        else if (arg == QLatin1String("-w") && i + 1 < args.size())
+            options.width = args[++i].toInt();
+        else if (arg == QLatin1String("-d") && i + 1 < args.size())
+            options.dpi = args[++i].toInt();
+        else if (options.file.isEmpty())
+            options.file = arg;
+        else
+            return false;
+    }
+
+    return !options.file.isEmpty() && options.pages > 0 && options.width > 0 && options.dpi > 0;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    Options options;
+
+    if (!parseOptions(app.arguments(), options)) {
+        fprintf(stderr, "usage: %s [-p pages] [-w width] [-d dpi] file.pdf\n", argv[0]);
+        return 1;
+    }
+
+    const char *const phaseNames[] = {"thumbnail", "full"};
+
+    printf("%s, %dpx thumbnails, full pages at %d dpi\n", qPrintable(options.file), options.width, options.dpi);
+    printf("%-10s %6s %10s %8s %14s %12s\n", "render", "pages", "ms/page", "images", "decoded bytes", "peak KB");
+
+    for (int phase = 0; phase < 2; ++phase) {
+        Result result;
+
+        if (!renderPages(options, phase == 0, result)) {
+            fprintf(stderr, "cannot open %s\n", qPrintable(options.file));
+            return 1;
+        }
+
+        printf("%-10s %6d %10.1f %8d %14lld %12lld\n", phaseNames[phase], result.pages,
+               result.pages > 0 ? result.msecs / double(result.pages) : 0.0, result.stats.images, result.stats.usage,
+               result.peakKBytes);
+    }
+
+    return 0;
+}
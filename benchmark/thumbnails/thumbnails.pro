@@ -0,0 +1,8 @@
+TARGET = deepdf-thumbnails
+
+TEMPLATE = app
+
+include($$PWD/../benchmark.pri)
+
+SOURCES += \
+    $$PWD/thumbnails.cpp
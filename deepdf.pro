@@ -1,3 +1,10 @@
 TEMPLATE = subdirs
 
 SUBDIRS += src
+
+#性能测试和一致性检查 qmake CONFIG+=benchmark
+CONFIG(benchmark) {
+    SUBDIRS += benchmark
+
+    benchmark.depends = src
+}
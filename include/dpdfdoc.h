@@ -2,14 +2,18 @@
 #define DPDFDOC_H
 
 #include "dpdfglobal.h"
+#include "dpdfsearchtask.h"
 
 #include <QObject>
 #include <QMap>
+#include <QStringList>
 #include <QVector>
 #include <QPointF>
+#include <QSizeF>
 #include <QVariant>
 #include <QScopedPointer>
 
+class QIODevice;
 class DPdfPage;
 class DPdfDocHandler;
 class DPdfDocPrivate;
@@ -29,6 +33,53 @@ public:
         FILE_NOT_FOUND_ERROR
     };
 
+    /**
+     * @brief 文档加载方式
+     * READ_FILE 按需读取文件
+     * MAPPED_FILE 将文件映射到内存,解析时不再每次读取都进行lseek()和read()系统调用,同一文件的多个文档共享页缓存,
+     * 适合大文件,文档打开期间文件不能被截断
+     */
+    enum LoadMode {
+        READ_FILE = 0,
+        MAPPED_FILE
+    };
+
+    /**
+     * @brief 文字导出格式
+     * TEXT_PLAIN UTF-8纯文本,换行为\n,每页以换页符\f结束
+     * TEXT_JSON JSON Lines,每页一行 {"page","width","height","blocks":[{"rect","lines":[{"rect","text"}]}]},区域为[x,y,w,h] (in pixel)
+     */
+    enum TextFormat {
+        TEXT_PLAIN = 0,
+        TEXT_JSON
+    };
+
+    /**
+     * @brief 已解析页面缓存的使用情况
+     */
+    struct PageCacheStats {
+        int cachedPages = 0;        //持有解析数据(页面内容,文本页或区域索引)的页面数
+        int textPages = 0;          //持有文本页的页面数
+        qint64 usage = 0;           //估算占用 字节
+        qint64 budget = 0;          //内存预算 字节
+        int pageLimit = 0;          //页面数上限 0为不限
+        qint64 hits = 0;            //使用页面内容时已解析的次数
+        qint64 misses = 0;          //使用页面内容时需要解析的次数
+        qint64 evictions = 0;       //因超出预算或数量上限释放解析数据的次数
+    };
+
+    /**
+     * @brief 文档级解码图片缓存的使用情况 各页共用,同一图片在多页重复出现时只解码一次
+     */
+    struct ImageCacheStats {
+        int images = 0;             //缓存的解码图片数
+        qint64 usage = 0;           //解码图片占用 字节
+        qint64 budget = 0;          //内存预算 字节
+        qint64 hits = 0;            //绘制图片时无需解码的次数
+        qint64 misses = 0;          //绘制图片时需要解码的次数
+        qint64 evictions = 0;       //因超出预算释放解码图片的次数
+    };
+
     struct Section;
     typedef QVector< Section > Outline;
     typedef QMap<QString, QVariant> Properies;
@@ -40,7 +91,24 @@ public:
         Outline children;
     };
 
-    DPdfDoc(QString filename, QString password = QString());
+    DPdfDoc(QString filename, QString password = QString(), LoadMode mode = READ_FILE);
+
+    /**
+     * @brief 从设备打开文档,解析时按需读取,顺序设备(如网络流)会先读取全部数据
+     * 此类文档没有文件路径,只能通过saveAs()保存
+     * @param device 已以只读方式打开,可随机访问的设备需在文档存活期间保持打开且不被其他地方读写
+     * @param password
+     */
+    explicit DPdfDoc(QIODevice *device, QString password = QString());
+
+    /**
+     * @brief 渐进加载 数据逐步到达(如正在下载),通过addData()/appendData()写入
+     * 数据足够时触发loaded(),线性化文档只需文件头部和首页数据即可打开并渲染首页,之后各页可用时触发pageAvailable()
+     * 此类文档没有文件路径,只能通过saveAs()保存
+     * @param totalSize 文件总大小
+     * @param password
+     */
+    explicit DPdfDoc(qint64 totalSize, QString password = QString());
 
     virtual ~DPdfDoc();
 
@@ -68,6 +136,22 @@ public:
      */
     int pageCount() const;
 
+    /**
+     * @brief 所有页面的大小和旋转 一次遍历页面树得到,继承的MediaBox,CropBox和Rotate已处理,不创建页面
+     * 结果随文档缓存,之后的调用和页面创建直接使用;渐进加载时未到达的页面大小为空且不缓存
+     * @param xRes 横向分辨率 72时单位为point
+     * @param yRes 纵向分辨率
+     * @param rotations 不为空时返回每页的旋转 0,1,2,3对应顺时针0,90,180,270度
+     * @return 按页索引,已受旋转影响的宽高
+     */
+    QVector<QSizeF> pageSizes(qreal xRes = 72, qreal yRes = 72, QVector<int> *rotations = nullptr);
+
+    /**
+     * @brief 在后台线程计算所有页面的大小并缓存,完成后触发pageSizesReady() 渐进加载时有页面未到达则不缓存也不触发
+     * @return 已有缓存返回true,不再计算
+     */
+    bool loadPageSizes();
+
     /**
      * @brief 文档状态
      * @return
@@ -77,10 +161,147 @@ public:
     /**
      * @brief 创建新的page返回
      * @param i
-     * @return
+     * @return 渐进加载时页面数据未到达返回nullptr
      */
     DPdfPage *page(int i, qreal xRes, qreal yRes);
 
+    /**
+     * @brief 设置已解析页面缓存的内存预算,页面解析内容和渲染缓存(解码后的图片)在多次image()之间复用,
+     * 超出预算时释放最久未使用页面的解析数据,再次使用时自动重新加载
+     * @param bytes 字节数
+     */
+    void setPageCacheBudget(qint64 bytes);
+
+    /**
+     * @brief 已解析页面缓存的内存预算
+     * @return 字节数
+     */
+    qint64 pageCacheBudget() const;
+
+    /**
+     * @brief 设置同时保留解析数据的页面数上限,与内存预算同时生效,超出时释放最久未使用页面的解析数据
+     * DPdfPage对象本身一直有效,再次使用时自动重新加载
+     * @param count 页面数 小于等于0不限
+     */
+    void setPageCacheLimit(int count);
+
+    /**
+     * @brief 同时保留解析数据的页面数上限
+     * @return 0为不限
+     */
+    int pageCacheLimit() const;
+
+    /**
+     * @brief 已解析页面缓存的当前使用情况
+     * @return
+     */
+    PageCacheStats pageCacheStats() const;
+
+    /**
+     * @brief 设置同时保留文本页(字符信息)的页面数,超出时释放最久未使用页面的文本页,页面内容和渲染缓存不受影响
+     * 文本页同时计入setPageCacheBudget()的内存预算
+     * @param count 页面数 至少保留一页
+     */
+    void setTextPageCacheLimit(int count);
+
+    /**
+     * @brief 同时保留文本页的页面数上限
+     * @return
+     */
+    int textPageCacheLimit() const;
+
+    /**
+     * @brief 设置文档级解码图片缓存的内存预算,各页共用,关闭页面或释放页面解析数据后仍然保留,
+     * 超出预算时释放最久未使用的图片
+     * @param bytes 字节数 0为不缓存
+     */
+    void setImageCacheBudget(qint64 bytes);
+
+    /**
+     * @brief 文档级解码图片缓存的内存预算
+     * @return 字节数
+     */
+    qint64 imageCacheBudget() const;
+
+    /**
+     * @brief 文档级解码图片缓存的当前使用情况 文档未加载时只有预算
+     * @return
+     */
+    ImageCacheStats imageCacheStats() const;
+
+    /**
+     * @brief 全文搜索 在后台线程中逐页搜索,结果按页序通过任务的found()信号逐页送出,可随时取消
+     * @param text 搜索关键字
+     * @param flags 区分大小写,整个单词
+     * @param maxHits 结果数上限,达到后停止搜索,小于等于0不限
+     * @param xRes 结果区域使用的分辨率,与page()一致
+     * @param yRes
+     * @return 调用者负责释放,文档无效或关键字为空时返回nullptr
+     */
+    DPdfSearchTask *search(const QString &text, DPdfSearchTask::Flags flags = DPdfSearchTask::NONE, int maxHits = -1, qreal xRes = 72, qreal yRes = 72);
+
+    /**
+     * @brief 导出整个文档的文字 多个线程提取,按页序写入device,阻塞直到完成
+     * 页面临时加载,写出后立即释放,不创建DPdfPage,内存占用与页数无关;无法解析的页面输出为空页
+     * @param device 已以写方式打开
+     * @param format
+     * @param xRes TEXT_JSON中区域使用的分辨率
+     * @param yRes
+     * @return 文档无效,渐进加载时有页面数据未到达,或写入失败返回false
+     */
+    bool exportText(QIODevice *device, TextFormat format = TEXT_PLAIN, qreal xRes = 72, qreal yRes = 72);
+
+    /**
+     * @brief 多模式全文搜索 与search()相同在后台多线程逐页搜索,每页的文字只扫描一遍即匹配所有字面模式
+     * 只有字面模式时可以利用全文索引跳过页面
+     * @param literals 字面模式
+     * @param regexps 正则模式 (QRegularExpression语法)
+     * @param flags 区分大小写,整个单词 对两类模式都生效
+     * @param maxHits 结果数上限,达到后停止搜索,小于等于0不限
+     * @param xRes 结果区域使用的分辨率,与page()一致
+     * @param yRes
+     * @param errors 不为空时接收无效正则的错误信息,每个一条,包含模式编号和错误位置
+     * @return 调用者负责释放,文档无效,有无效的正则或没有有效模式时返回nullptr;结果的DPdfSearchHit::pattern为模式编号,字面模式在前,正则模式在后
+     */
+    DPdfSearchTask *searchPatterns(const QStringList &literals, const QStringList &regexps = QStringList(),
+                                   DPdfSearchTask::Flags flags = DPdfSearchTask::NONE, int maxHits = -1, qreal xRes = 72, qreal yRes = 72,
+                                   QStringList *errors = nullptr);
+
+    /**
+     * @brief 启用全文索引 有索引后search()跳过不可能命中的页面,大文档上重复搜索无需每次提取所有页面的文字
+     * 索引文件按文档路径命名,文件大小,修改时间或内容变化后自动作废重建
+     * @param indexDir 索引文件所在目录,为空或文档没有文件路径时索引只保留在内存中
+     * @return 已有索引或加载了有效的索引文件返回true;否则在后台建立,完成后触发textIndexReady()
+     */
+    bool loadTextIndex(const QString &indexDir = QString());
+
+    /**
+     * @brief 全文索引是否可用
+     * @return
+     */
+    bool hasTextIndex() const;
+
+    /**
+     * @brief 渐进加载时写入已到达的数据,支持按范围请求下载的乱序数据
+     * @param offset 数据在文件中的偏移
+     * @param data
+     */
+    void addData(qint64 offset, const QByteArray &data);
+
+    /**
+     * @brief 渐进加载时追加顺序到达的数据
+     * @param data
+     */
+    void appendData(const QByteArray &data);
+
+    /**
+     * @brief 页面数据是否已全部到达,可以渲染 非渐进加载的文档始终可用
+     * 渐进加载时未到达的数据会通过dataRequested()请求
+     * @param index
+     * @return
+     */
+    bool isPageAvailable(int index);
+
     /**
      * @brief 目录
      * @return
@@ -120,6 +341,43 @@ public:
      */
     bool saveAs(const QString &filePath);
 
+    /**
+     * @brief 增量保存到当前文件 只在文件末尾追加新建和修改过的注释相关对象,不重写整个文件
+     * 文件不支持追加(结构被修复,使用交叉引用流,已被整体保存覆盖等)时退化为save()
+     * @return
+     */
+    bool saveIncremental();
+
+signals:
+    /**
+     * @brief 渐进加载时文档数据足够,文档已打开(status()为SUCCESS)或无法打开
+     * @param status
+     */
+    void loaded(DPdfDoc::Status status);
+
+    /**
+     * @brief 渐进加载时页面数据已全部到达,可以通过page()获取并渲染
+     * @param index
+     */
+    void pageAvailable(int index);
+
+    /**
+     * @brief 渐进加载时需要的数据段,按范围请求下载时可优先获取
+     * @param offset
+     * @param size
+     */
+    void dataRequested(qint64 offset, qint64 size);
+
+    /**
+     * @brief 后台建立的全文索引已可用
+     */
+    void textIndexReady();
+
+    /**
+     * @brief 后台计算的页面大小已缓存,pageSizes()不再遍历页面树
+     */
+    void pageSizesReady();
+
 public:
     /**
      * @brief 尝试加载文档是否成功
@@ -129,7 +387,19 @@ public:
      */
     static Status tryLoadFile(const QString &filename, const QString &password = QString());
 
+    /**
+     * @brief 从内存打开文档,不拷贝数据,文档持有data的共享引用
+     * 不提供构造函数重载,避免DPdfDoc("file.pdf")在QString和QByteArray之间产生歧义
+     * 此类文档没有文件路径,只能通过saveAs()保存
+     * @param data 文档数据
+     * @param password
+     * @return 调用者负责释放,通过status()判断是否打开成功
+     */
+    static DPdfDoc *fromData(const QByteArray &data, const QString &password = QString());
+
 private:
+    DPdfDoc();
+
     Q_DISABLE_COPY(DPdfDoc)
     QScopedPointer<DPdfDocPrivate> d_ptr;
 };
@@ -31,11 +31,11 @@ private:
     void destory();
 };
 
-//pdfium即使不同文档之间loadpage和renderpage也不是线程安全，需要加锁
+//pdfium同一文档内不是线程安全的，需要加文档锁；不同文档之间共享的字体等全局状态由pdfium内部的CFX_FontLock保护，不同文档可以并行加载和渲染
 class DPdfMutexLocker : public QMutexLocker
 {
 public:
-    DPdfMutexLocker(const QString &tmpLog);
+    DPdfMutexLocker(QMutex *docMutex, const QString &tmpLog);
     ~DPdfMutexLocker();
 
     QString m_log;
@@ -3,13 +3,51 @@
 
 #include <QObject>
 #include <QImage>
+#include <QPair>
+#include <QRectF>
 #include <QScopedPointer>
+#include <QVector>
 
 #include "dpdfglobal.h"
+#include "dpdfsearchtask.h"
 
 class DPdfAnnot;
+class DPdfRenderTask;
 class DPdfPagePrivate;
 class DPdfDocHandler;
+class DPdfDocPrivate;
+
+/**
+ * @brief 整页文本布局 各数组与text按UTF-16单元一一对应,text中的匹配位置可直接用于取字符区域
+ */
+struct DPdfTextLayout {
+    //整页文本 与text()一致,换行处为pdfium生成的\r\n,不含控制字符,超出BMP的字符为代理对
+    QString text;
+
+    //每个单元对应的字符索引,与charAt(),textRect()一致;代理对的两个单元相同
+    QVector<int> charIndices;
+
+    //字符区域 (in pixel)
+    QVector<QRectF> charRects;
+
+    //按字体上下沿计算的字符区域,同一行高度一致 (in pixel)
+    QVector<QRectF> looseRects;
+
+    //字号 (in point)
+    QVector<float> fontSizes;
+
+    //每行首字符的索引,不含第一行
+    QVector<int> lineBreaks;
+
+    //每个单词首字符的索引,以空白和换行分隔
+    QVector<int> wordBreaks;
+
+    int count() const
+    {
+        return text.size();
+    }
+};
+
 class DEEPDF_EXPORT DPdfPage : public QObject
 {
     Q_OBJECT
@@ -46,6 +84,15 @@ public:
      */
     QImage image(int width, int height, QRect slice = QRect());
 
+    /**
+     * @brief 异步获取原图,在文档的渲染线程中执行,可通过返回的任务取消
+     * @param width (in pixel)
+     * @param height (in pixel)
+     * @param slice 要取的切片,默认为全图 (in pixel)
+     * @return 调用者负责释放,文档无效时返回nullptr
+     */
+    DPdfRenderTask *imageAsync(int width, int height, QRect slice = QRect());
+
     /**
      * @brief 字符数
      * @return
@@ -60,6 +107,14 @@ public:
      */
     bool textRect(int index, QRectF &textrect);
 
+    /**
+     * @brief 该位置上的字符 通过空间索引查找,不逐个比较所有字符
+     * @param pos (in pixel)
+     * @param tolerance 没有字符包含该点时,查找外扩tolerance后包含该点且边缘最近的字符 (in pixel)
+     * @return 字符索引,没有时返回-1
+     */
+    int charAt(const QPointF &pos, qreal tolerance = 0);
+
     /**
      * @brief 获取多个字符文本范围
      * @param index
@@ -68,6 +123,15 @@ public:
      */
     QVector<QRectF> textRects(int index, int charCount);
 
+    /**
+     * @brief 批量获取多个字符范围的文本区域 只加锁一次,每个范围内同一行的区域合并为一个
+     * 用于高亮全部搜索结果或跨行选择,避免逐个范围调用textRects()
+     * @param ranges 字符范围 (起始索引,字符数)
+     * @param offsets 不为空时返回每个范围的第一个区域在结果中的位置,末尾追加结果总数,大小为ranges.size()+1
+     * @return (in pixel)
+     */
+    QVector<QRectF> textRects(const QVector<QPair<int, int>> &ranges, QVector<int> *offsets = nullptr);
+
     /**
      * @brief 获取本页所有文字和周围空间区域
      * @param charCount 文本字符数
@@ -82,6 +146,12 @@ public:
      */
     void allTextRects(int &charCount, QStringList &texts, QVector<QRectF> &rects);
 
+    /**
+     * @brief 一次取出本页所有文字及其区域,字号,行和单词边界 不为每个字符单独分配内存
+     * @return
+     */
+    DPdfTextLayout textLayout();
+
     /**
      * @brief 根据范围获取文本
      * @param rect (in pixel)
@@ -148,12 +218,30 @@ public:
      */
     QVector<QRectF> search(const QString &text, bool matchCase = false, bool wholeWords = false);
 
+    /**
+     * @brief 多模式搜索 所有字面模式在一遍扫描中匹配,适合同时查找大量关键字,账号,编号等
+     * @param literals 字面模式
+     * @param regexps 正则模式 (QRegularExpression语法)
+     * @param flags 区分大小写,整个单词 对两类模式都生效
+     * @param errors 不为空时接收无效正则的错误信息,每个一条,包含模式编号和错误位置
+     * @return 按位置排序的结果,DPdfSearchHit::pattern为模式编号,字面模式在前,正则模式在后;有无效的正则时为空
+     */
+    QVector<DPdfSearchHit> searchPatterns(const QStringList &literals, const QStringList &regexps = QStringList(),
+                                          DPdfSearchTask::Flags flags = DPdfSearchTask::NONE, QStringList *errors = nullptr);
+
     /**
      * @brief 获取当前支持操作的所有注释
      * @return 注释列表，只会列出已支持的注释
      */
     QList<DPdfAnnot *> annots();
 
+    /**
+     * @brief 该位置上的注释和链接 通过空间索引查找,不逐个调用pointIn()
+     * @param pos 与DPdfAnnot::pointIn()一致
+     * @return 按页面中的顺序
+     */
+    QList<DPdfAnnot *> annotsAt(const QPointF &pos);
+
     /**
      * @brief 获取当前支持操作的所有链接
      * @return
@@ -187,7 +275,7 @@ signals:
     void annotRemoved(DPdfAnnot *dAnnot);
 
 private:
-    DPdfPage(DPdfDocHandler *handler, int pageIndex, qreal xRes = 72, qreal yRes = 72);
+    DPdfPage(DPdfDocPrivate *doc, int pageIndex, qreal xRes = 72, qreal yRes = 72);
 
     QScopedPointer<DPdfPagePrivate> d_ptr;
 };
@@ -0,0 +1,90 @@
+#ifndef DPDFRENDERTASK_H
+#define DPDFRENDERTASK_H
+
+#include <QObject>
+#include <QImage>
+#include <QScopedPointer>
+
+#include "dpdfglobal.h"
+
+class DPdfDocPrivate;
+class DPdfPagePrivate;
+class DPdfRenderTaskPrivate;
+/**
+ * @brief 异步渲染任务 由DPdfPage::imageAsync()创建,在文档的渲染线程中分段渲染,可随时取消
+ * 信号在任务所在线程中触发,创建后再连接不会丢失信号;调用者负责释放,释放时自动取消并等待渲染线程退出该任务
+ */
+class DEEPDF_EXPORT DPdfRenderTask : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(DPdfRenderTask)
+    friend class DPdfPage;
+    friend class DPdfDocPrivate;
+
+public:
+    enum Status {
+        WAITING = 0,        //等待渲染线程
+        RUNNING,            //渲染中
+        FINISHED,           //渲染完成
+        CANCELLED,          //已取消
+        FAILED              //渲染失败
+    };
+
+    ~DPdfRenderTask() override;
+
+    /**
+     * @brief 页索引
+     * @return
+     */
+    int pageIndex() const;
+
+    /**
+     * @brief 当前状态
+     * @return
+     */
+    Status status() const;
+
+    /**
+     * @brief 渲染进度 按已处理的页面对象数计算
+     * @return 0-100
+     */
+    int progress() const;
+
+    /**
+     * @brief 渲染结果 仅状态为FINISHED时有效
+     * @return
+     */
+    QImage image() const;
+
+    /**
+     * @brief 取消渲染,未开始的任务直接移出队列,进行中的任务在下一个暂停检查点停止
+     * 页面滚出可视区域时调用,避免继续占用CPU
+     */
+    void cancel();
+
+    /**
+     * @brief 阻塞等待任务结束(完成,取消或失败)
+     * @param msecs 超时 负数为一直等待
+     * @return 超时返回false
+     */
+    bool wait(int msecs = -1);
+
+signals:
+    /**
+     * @brief 渲染进度变化
+     * @param progress 0-100
+     */
+    void progressChanged(int progress);
+
+    /**
+     * @brief 任务结束,通过status()区分完成,取消或失败
+     */
+    void finished();
+
+private:
+    DPdfRenderTask(DPdfDocPrivate *doc, DPdfPagePrivate *page, int width, int height, const QRect &slice);
+
+    QScopedPointer<DPdfRenderTaskPrivate> d_ptr;
+};
+
+#endif // DPDFRENDERTASK_H
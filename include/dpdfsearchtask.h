@@ -0,0 +1,129 @@
+#ifndef DPDFSEARCHTASK_H
+#define DPDFSEARCHTASK_H
+
+#include <QObject>
+#include <QMap>
+#include <QMetaType>
+#include <QRectF>
+#include <QScopedPointer>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "dpdfglobal.h"
+
+/**
+ * @brief 一处搜索结果
+ */
+struct DPdfSearchHit {
+    //在页面文本中的起始位置,与DPdfPage::textLayout()的text一致
+    int charIndex = -1;
+
+    int charCount = 0;
+
+    //命中的模式编号 多模式搜索时字面模式在前,正则模式在后;单关键字搜索时为0
+    int pattern = 0;
+
+    //按行合并的字符区域 (in pixel)
+    QVector<QRectF> rects;
+};
+
+Q_DECLARE_METATYPE(DPdfSearchHit)
+
+class DPdfDocPrivate;
+class DPdfPatternMatcher;
+class DPdfSearchTaskPrivate;
+/**
+ * @brief 全文搜索任务 由DPdfDoc::search()创建,多个线程并行搜索各页,结果按页序通过found()逐页送出
+ * 页面文字的提取需要文档锁,各页依次进行;匹配和区域计算在锁外并行
+ * 信号在任务所在线程中触发,创建后再连接不会丢失信号;调用者负责释放,释放时自动取消并等待搜索线程退出
+ */
+class DEEPDF_EXPORT DPdfSearchTask : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(DPdfSearchTask)
+    friend class DPdfDoc;
+    friend class DPdfDocPrivate;
+
+public:
+    enum Flag {
+        NONE = 0x0,
+        MATCH_CASE = 0x1,           //区分大小写
+        WHOLE_WORDS = 0x2           //整个单词
+    };
+    Q_DECLARE_FLAGS(Flags, Flag)
+
+    enum Status {
+        RUNNING = 0,        //搜索中
+        FINISHED,           //所有页面已搜索完,或已达到结果数上限
+        CANCELLED,          //已取消
+        INCOMPLETE          //已到达的页面已搜索完,渐进加载时有页面数据未到达未被搜索,见unsearchedPages()
+    };
+
+    ~DPdfSearchTask() override;
+
+    /**
+     * @brief 搜索关键字 多模式搜索时为空
+     * @return
+     */
+    QString text() const;
+
+    /**
+     * @brief 当前状态
+     * @return
+     */
+    Status status() const;
+
+    /**
+     * @brief 已送出的结果数
+     * @return
+     */
+    int hitCount() const;
+
+    /**
+     * @brief 已送出的所有结果
+     * @return 页索引->该页结果,只包含有结果的页
+     */
+    QMap<int, QVector<DPdfSearchHit>> results() const;
+
+    /**
+     * @brief 渐进加载时数据未到达而未被搜索的页面 页面到达后需重新搜索
+     * @return 按页序排列
+     */
+    QList<int> unsearchedPages() const;
+
+    /**
+     * @brief 取消搜索,正在搜索的页面完成后停止
+     */
+    void cancel();
+
+    /**
+     * @brief 阻塞等待任务结束(完成或取消)
+     * @param msecs 超时 负数为一直等待
+     * @return 超时返回false
+     */
+    bool wait(int msecs = -1);
+
+signals:
+    /**
+     * @brief 一页的搜索结果,按页序依次触发,没有结果的页不触发
+     * @param pageIndex
+     * @param hits
+     */
+    void found(int pageIndex, const QVector<DPdfSearchHit> &hits);
+
+    /**
+     * @brief 任务结束,通过status()区分完成,取消或有页面未搜索
+     */
+    void finished();
+
+private:
+    DPdfSearchTask(DPdfDocPrivate *doc, const QString &text, Flags flags, int maxHits, qreal xRes, qreal yRes);
+
+    DPdfSearchTask(DPdfDocPrivate *doc, const QSharedPointer<const DPdfPatternMatcher> &matcher, int maxHits, qreal xRes, qreal yRes);
+
+    QScopedPointer<DPdfSearchTaskPrivate> d_ptr;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(DPdfSearchTask::Flags)
+
+#endif // DPDFSEARCHTASK_H
@@ -0,0 +1,105 @@
+#ifndef DPDFTILERENDERER_H
+#define DPDFTILERENDERER_H
+
+#include "dpdfglobal.h"
+
+#include <QObject>
+#include <QImage>
+#include <QRect>
+#include <QScopedPointer>
+
+class DPdfDoc;
+class DPdfTileRendererPrivate;
+/**
+ * @brief 分块渲染 将页面按固定大小切块渲染,渲染结果存入进程内共享的分块缓存(按文档,页,分辨率,缩放,块索引区分),
+ * 平移和缩放时只需合成已缓存的分块,并在后台线程中预取相邻分块和相邻页面
+ */
+class DEEPDF_EXPORT DPdfTileRenderer : public QObject
+{
+    Q_OBJECT
+    Q_DECLARE_PRIVATE(DPdfTileRenderer)
+
+public:
+    /**
+     * @param doc 文档,需比渲染器存活更久
+     * @param xRes 获取页面使用的分辨率,缩放1.0对应DPdfPage::sizeF()
+     * @param yRes
+     */
+    explicit DPdfTileRenderer(DPdfDoc *doc, qreal xRes = 72, qreal yRes = 72, QObject *parent = nullptr);
+
+    ~DPdfTileRenderer() override;
+
+    /**
+     * @brief 分块边长 默认256
+     * @param size (in pixel)
+     */
+    void setTileSize(int size);
+
+    int tileSize() const;
+
+    /**
+     * @brief 获取单个分块,未缓存时同步渲染
+     * @param pageIndex
+     * @param scale 缩放 1.0对应DPdfPage::sizeF()
+     * @param column
+     * @param row
+     * @return 页面边缘的分块小于分块边长
+     */
+    QImage tile(int pageIndex, qreal scale, int column, int row);
+
+    /**
+     * @brief 合成页面指定区域,优先使用缓存的分块,并预取周边分块
+     * @param pageIndex
+     * @param scale
+     * @param rect 页面缩放后坐标中的区域 (in pixel)
+     * @return
+     */
+    QImage image(int pageIndex, qreal scale, const QRect &rect);
+
+    /**
+     * @brief 在后台线程预取区域周边一圈分块及相邻页面对应区域的分块
+     * @param pageIndex
+     * @param scale
+     * @param rect (in pixel)
+     */
+    void prefetch(int pageIndex, qreal scale, const QRect &rect);
+
+    /**
+     * @brief 取消尚未开始的预取任务,视口快速移动时调用
+     */
+    void cancelPrefetch();
+
+    /**
+     * @brief 设置共享分块缓存的内存预算,所有渲染器共用
+     * @param bytes
+     */
+    static void setCacheBudget(qint64 bytes);
+
+    static qint64 cacheBudget();
+
+    /**
+     * @brief 清除共享缓存中属于该文档的分块,文档内容改变后调用
+     * 清除前已开始的渲染结果不会再存入缓存
+     * @param doc
+     */
+    static void clearCache(const DPdfDoc *doc);
+
+    /**
+     * @brief 只清除该文档一页的分块 DPdfPage的注释修改会自动调用
+     * @param doc
+     * @param pageIndex
+     */
+    static void clearCache(const DPdfDoc *doc, int pageIndex);
+
+signals:
+    /**
+     * @brief 后台预取的分块已渲染并存入缓存,可能在渲染线程中触发
+     */
+    void tileReady(int pageIndex, qreal scale, int column, int row);
+
+private:
+    Q_DISABLE_COPY(DPdfTileRenderer)
+    QScopedPointer<DPdfTileRendererPrivate> d_ptr;
+};
+
+#endif // DPDFTILERENDERER_H
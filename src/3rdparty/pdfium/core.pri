@@ -110,6 +110,7 @@ HEADERS += \
     $$PWD/pdfium/core/fpdfapi/parser/fpdf_parser_utility.h \
     $$PWD/pdfium/core/fpdfapi/render/charposlist.h \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_devicebuffer.h \
+    $$PWD/pdfium/core/fpdfapi/render/cpdf_docimagecache.h \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_docrenderdata.h \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_imagecacheentry.h \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_imageloader.h \
@@ -217,6 +218,7 @@ HEADERS += \
     $$PWD/pdfium/core/fxcrt/cfx_bitstream.h \
     $$PWD/pdfium/core/fxcrt/cfx_datetime.h \
     $$PWD/pdfium/core/fxcrt/cfx_fixedbufgrow.h \
+    $$PWD/pdfium/core/fxcrt/cfx_memorymappedfile.h \
     $$PWD/pdfium/core/fxcrt/cfx_readonlymemorystream.h \
     $$PWD/pdfium/core/fxcrt/cfx_seekablestreamproxy.h \
     $$PWD/pdfium/core/fxcrt/cfx_timer.h \
@@ -261,6 +263,7 @@ HEADERS += \
     $$PWD/pdfium/core/fxge/dib/cfx_imagetransformer.h \
     $$PWD/pdfium/core/fxge/dib/cfx_scanlinecompositor.h \
     $$PWD/pdfium/core/fxge/dib/cstretchengine.h \
+    $$PWD/pdfium/core/fxge/dib/fx_dib_sse2.h \
     $$PWD/pdfium/core/fxge/dib/scanlinecomposer_iface.h \
     $$PWD/pdfium/core/fxge/fontdata/chromefontdata/chromefontdata.h \
     $$PWD/pdfium/core/fxge/cfx_cliprgn.h \
@@ -272,6 +275,7 @@ HEADERS += \
     $$PWD/pdfium/core/fxge/cfx_folderfontinfo.h \
     $$PWD/pdfium/core/fxge/cfx_font.h \
     $$PWD/pdfium/core/fxge/cfx_fontcache.h \
+    $$PWD/pdfium/core/fxge/cfx_fontlock.h \
     $$PWD/pdfium/core/fxge/cfx_fontmapper.h \
     $$PWD/pdfium/core/fxge/cfx_fontmgr.h \
     $$PWD/pdfium/core/fxge/cfx_gemodule.h \
@@ -463,6 +467,7 @@ SOURCES += \
     $$PWD/pdfium/core/fpdfapi/parser/fpdf_parser_utility.cpp \
     $$PWD/pdfium/core/fpdfapi/render/charposlist.cpp \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_devicebuffer.cpp \
+    $$PWD/pdfium/core/fpdfapi/render/cpdf_docimagecache.cpp \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_docrenderdata.cpp \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_imagecacheentry.cpp \
     $$PWD/pdfium/core/fpdfapi/render/cpdf_imageloader.cpp \
@@ -556,6 +561,7 @@ SOURCES += \
     $$PWD/pdfium/core/fxcrt/cfx_binarybuf.cpp \
     $$PWD/pdfium/core/fxcrt/cfx_bitstream.cpp \
     $$PWD/pdfium/core/fxcrt/cfx_datetime.cpp \
+    $$PWD/pdfium/core/fxcrt/cfx_memorymappedfile.cpp \
     $$PWD/pdfium/core/fxcrt/cfx_readonlymemorystream.cpp \
     $$PWD/pdfium/core/fxcrt/cfx_seekablestreamproxy.cpp \
     $$PWD/pdfium/core/fxcrt/cfx_timer.cpp \
@@ -587,6 +593,7 @@ SOURCES += \
     $$PWD/pdfium/core/fxge/dib/cfx_scanlinecompositor.cpp \
     $$PWD/pdfium/core/fxge/dib/cstretchengine.cpp \
     $$PWD/pdfium/core/fxge/dib/fx_dib_main.cpp \
+    $$PWD/pdfium/core/fxge/dib/fx_dib_sse2.cpp \
     $$PWD/pdfium/core/fxge/fontdata/chromefontdata/FoxitDingbats.cpp \
     $$PWD/pdfium/core/fxge/fontdata/chromefontdata/FoxitFixed.cpp \
     $$PWD/pdfium/core/fxge/fontdata/chromefontdata/FoxitFixedBold.cpp \
@@ -611,6 +618,7 @@ SOURCES += \
     $$PWD/pdfium/core/fxge/cfx_folderfontinfo.cpp \
     $$PWD/pdfium/core/fxge/cfx_font.cpp \
     $$PWD/pdfium/core/fxge/cfx_fontcache.cpp \
+    $$PWD/pdfium/core/fxge/cfx_fontlock.cpp \
     $$PWD/pdfium/core/fxge/cfx_fontmapper.cpp \
     $$PWD/pdfium/core/fxge/cfx_fontmgr.cpp \
     $$PWD/pdfium/core/fxge/cfx_gemodule.cpp \
@@ -43,6 +43,12 @@ class CFX_FileBufferArchive final : public IFX_ArchiveStream {
 
   FX_FILESIZE CurrentOffset() const override { return offset_; }
 
+  // Makes offsets relative to a file that already holds |offset| bytes.
+  void SetStartOffset(FX_FILESIZE offset) {
+    ASSERT(offset_ == 0);
+    offset_ = offset;
+  }
+
  private:
   bool Flush();
 
@@ -212,12 +218,22 @@ bool CPDF_Creator::WriteNewObjs() {
 void CPDF_Creator::InitNewObjNumOffsets() {
   for (const auto& pair : *m_pDocument) {
     const uint32_t objnum = pair.first;
-    if (m_IsIncremental ||
-        pair.second->GetObjNum() == CPDF_Object::kInvalidObjNum) {
+    if (pair.second->GetObjNum() == CPDF_Object::kInvalidObjNum)
       continue;
-    }
-    if (m_pParser && m_pParser->IsValidObjectNumber(objnum) &&
-        !m_pParser->IsObjectFree(objnum)) {
+    // Only an update section is written for incremental saves, the original
+    // objects stay in place unless they are known to have changed.
+    if (m_IsIncremental && !m_IsUpdateOnly)
+      continue;
+    if (m_IsUpdateOnly) {
+      // An update section holds the objects created since the previous save
+      // and the older ones that are known to have changed.
+      if (objnum <= m_LastSavedObjNum &&
+          !std::binary_search(m_ModifiedObjNums.begin(),
+                              m_ModifiedObjNums.end(), objnum)) {
+        continue;
+      }
+    } else if (m_pParser && m_pParser->IsValidObjectNumber(objnum) &&
+               !m_pParser->IsObjectFree(objnum)) {
       continue;
     }
     m_NewObjNumArray.insert(std::lower_bound(m_NewObjNumArray.begin(),
@@ -253,7 +269,8 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage1() {
       }
       m_iStage = Stage::kInitWriteObjs20;
     } else {
-      m_SavedOffset = m_pParser->GetSyntax()->GetDocumentSize();
+      if (!m_IsUpdateOnly)
+        m_SavedOffset = m_pParser->GetSyntax()->GetDocumentSize();
       m_iStage = Stage::kWriteIncremental15;
     }
   }
@@ -494,7 +511,8 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage4() {
     return Stage::kInvalid;
   }
   if (m_IsIncremental) {
-    FX_FILESIZE prev = m_pParser->GetLastXRefOffset();
+    FX_FILESIZE prev =
+        m_IsUpdateOnly ? m_PrevXRefOffset : m_pParser->GetLastXRefOffset();
     if (prev) {
       if (!m_Archive->WriteString("/Prev "))
         return Stage::kInvalid;
@@ -576,6 +594,32 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage4() {
   return m_iStage;
 }
 
+bool CPDF_Creator::CreateIncrementalUpdate(
+    FX_FILESIZE file_size,
+    FX_FILESIZE prev_xref,
+    uint32_t last_saved_objnum,
+    std::vector<uint32_t> modified_objnums) {
+  // Update sections are written with a classic xref table, which cannot
+  // follow a cross-reference stream.
+  if (!m_pParser || m_pParser->GetLastXRefOffset() == 0 ||
+      m_pParser->IsXRefStream() || file_size <= 0 || prev_xref <= 0) {
+    return false;
+  }
+
+  m_ModifiedObjNums = std::move(modified_objnums);
+  std::sort(m_ModifiedObjNums.begin(), m_ModifiedObjNums.end());
+  m_LastSavedObjNum = last_saved_objnum;
+  m_IsUpdateOnly = true;
+  m_SavedOffset = file_size;
+  m_PrevXRefOffset = prev_xref;
+
+  // |m_Archive| is always the CFX_FileBufferArchive created in the
+  // constructor, and nothing has been written to it yet.
+  static_cast<CFX_FileBufferArchive*>(m_Archive.get())
+      ->SetStartOffset(file_size);
+  return Create(FPDFCREATE_INCREMENTAL | FPDFCREATE_NO_ORIGINAL);
+}
+
 bool CPDF_Creator::Create(uint32_t flags) {
   m_IsIncremental = !!(flags & FPDFCREATE_INCREMENTAL);
   m_IsOriginal = !(flags & FPDFCREATE_NO_ORIGINAL);
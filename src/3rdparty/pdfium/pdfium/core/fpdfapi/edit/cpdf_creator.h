@@ -36,6 +36,18 @@ class CPDF_Creator {
   bool Create(uint32_t flags);
   bool SetFileVersion(int32_t fileVersion);
 
+  // Writes only the update section of an incremental save, laid out as if
+  // appended to a file of |file_size| bytes whose last cross-reference
+  // section starts at |prev_xref|. Objects numbered above
+  // |last_saved_objnum| are new since that file was written and are always
+  // written; |modified_objnums| lists older objects that changed.
+  bool CreateIncrementalUpdate(FX_FILESIZE file_size,
+                               FX_FILESIZE prev_xref,
+                               uint32_t last_saved_objnum,
+                               std::vector<uint32_t> modified_objnums);
+  FX_FILESIZE GetXRefStart() const { return m_XrefStart; }
+  FX_FILESIZE GetCurrentOffset() const { return m_Archive->CurrentOffset(); }
+
  private:
   enum class Stage {
     kInvalid = -1,
@@ -86,11 +98,15 @@ class CPDF_Creator {
   FX_FILESIZE m_XrefStart = 0;
   std::map<uint32_t, FX_FILESIZE> m_ObjectOffsets;
   std::vector<uint32_t> m_NewObjNumArray;  // Sorted, ascending.
+  std::vector<uint32_t> m_ModifiedObjNums;  // Sorted, ascending.
+  FX_FILESIZE m_PrevXRefOffset = 0;
+  uint32_t m_LastSavedObjNum = 0;
   RetainPtr<CPDF_Array> m_pIDArray;
   int32_t m_FileVersion = 0;
   bool m_bSecurityChanged = false;
   bool m_IsIncremental = false;
   bool m_IsOriginal = false;
+  bool m_IsUpdateOnly = false;
 };
 
 #endif  // CORE_FPDFAPI_EDIT_CPDF_CREATOR_H_
@@ -23,6 +23,7 @@
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_safe_types.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/fx_font.h"
 #include "third_party/base/span.h"
 #include "third_party/base/stl_util.h"
@@ -479,6 +480,9 @@ FX_RECT CPDF_CIDFont::GetCharBBox(uint32_t charcode) {
   if (charcode < 256 && m_CharBBox[charcode].right != -1)
     return m_CharBBox[charcode];
 
+  // Loads glyphs from a face that may be shared with other documents.
+  CFX_FontLock lock;
+
   FX_RECT rect;
   bool bVert = false;
   int glyph_index = GlyphFromCharCode(charcode, &bVert);
@@ -647,6 +651,8 @@ int CPDF_CIDFont::GetVerticalGlyph(int index, bool* pVertGlyph) {
 }
 
 int CPDF_CIDFont::GlyphFromCharCode(uint32_t charcode, bool* pVertGlyph) {
+  // Selects charmaps on a face that may be shared with other documents.
+  CFX_FontLock lock;
   if (pVertGlyph)
     *pVertGlyph = false;
 
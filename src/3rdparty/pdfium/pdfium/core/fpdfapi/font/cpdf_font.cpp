@@ -26,6 +26,7 @@
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fxcrt/fx_safe_types.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
@@ -292,6 +293,7 @@ RetainPtr<CPDF_Font> CPDF_Font::GetStockFont(CPDF_Document* pDoc,
   if (!font_id.has_value())
     return nullptr;
 
+  CFX_FontLock lock;
   auto* pFontGlobals = CPDF_FontGlobals::GetInstance();
   RetainPtr<CPDF_Font> pFont = pFontGlobals->Find(pDoc, font_id.value());
   if (pFont)
@@ -311,6 +313,8 @@ RetainPtr<CPDF_Font> CPDF_Font::GetStockFont(CPDF_Document* pDoc,
 RetainPtr<CPDF_Font> CPDF_Font::Create(CPDF_Document* pDoc,
                                        CPDF_Dictionary* pFontDict,
                                        FormFactoryIface* pFactory) {
+  // Loading goes through the shared font manager and CMap caches.
+  CFX_FontLock lock;
   ByteString type = pFontDict->GetStringFor("Subtype");
   RetainPtr<CPDF_Font> pFont;
   if (type == "TrueType") {
@@ -12,6 +12,7 @@
 #include "core/fpdfapi/cmaps/Korea1/cmaps_korea1.h"
 #include "core/fpdfapi/font/cfx_stockfontarray.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "third_party/base/stl_util.h"
 
 namespace {
@@ -56,6 +57,7 @@ void CPDF_FontGlobals::LoadEmbeddedMaps() {
 RetainPtr<CPDF_Font> CPDF_FontGlobals::Find(
     CPDF_Document* pDoc,
     CFX_FontMapper::StandardFont index) {
+  CFX_FontLock lock;
   auto it = m_StockMap.find(pDoc);
   if (it == m_StockMap.end() || !it->second)
     return nullptr;
@@ -66,12 +68,14 @@ RetainPtr<CPDF_Font> CPDF_FontGlobals::Find(
 void CPDF_FontGlobals::Set(CPDF_Document* pDoc,
                            CFX_FontMapper::StandardFont index,
                            const RetainPtr<CPDF_Font>& pFont) {
+  CFX_FontLock lock;
   if (!pdfium::Contains(m_StockMap, pDoc))
     m_StockMap[pDoc] = std::make_unique<CFX_StockFontArray>();
   m_StockMap[pDoc]->SetFont(index, pFont);
 }
 
 void CPDF_FontGlobals::Clear(CPDF_Document* pDoc) {
+  CFX_FontLock lock;
   m_StockMap.erase(pDoc);
 }
 
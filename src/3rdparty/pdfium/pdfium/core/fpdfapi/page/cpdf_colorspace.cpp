@@ -228,7 +228,6 @@ class CPDF_ICCBasedCS final : public CPDF_ColorSpace {
 
   RetainPtr<CPDF_ColorSpace> m_pAlterCS;
   RetainPtr<CPDF_IccProfile> m_pProfile;
-  mutable std::vector<uint8_t, FxAllocAllocator<uint8_t>> m_pCache;
   std::vector<float> m_pRanges;
 };
 
@@ -1009,24 +1008,9 @@ void CPDF_ICCBasedCS::TranslateImageLine(uint8_t* pDestBuf,
     return;
   }
 
-  if (m_pCache.empty()) {
-    m_pCache =
-        pdfium::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(nMaxColors, 3);
-    auto temp_src = pdfium::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(
-        nMaxColors, nComponents);
-    size_t src_index = 0;
-    for (int i = 0; i < nMaxColors; i++) {
-      uint32_t color = i;
-      uint32_t order = nMaxColors / 52;
-      for (uint32_t c = 0; c < nComponents; c++) {
-        temp_src[src_index++] = static_cast<uint8_t>(color / order * 5);
-        color %= order;
-        order /= 52;
-      }
-    }
-    IccModule::TranslateScanline(m_pProfile->transform(), m_pCache.data(),
-                                 temp_src.data(), nMaxColors);
-  }
+  // The table belongs to the profile, which the document keeps, so it is
+  // built once per profile rather than once per colorspace.
+  const uint8_t* pCache = m_pProfile->GetLookupTable();
   for (int i = 0; i < pixels; i++) {
     int index = 0;
     for (uint32_t c = 0; c < nComponents; c++) {
@@ -1034,9 +1018,9 @@ void CPDF_ICCBasedCS::TranslateImageLine(uint8_t* pDestBuf,
       pSrcBuf++;
     }
     index *= 3;
-    *pDestBuf++ = m_pCache[index];
-    *pDestBuf++ = m_pCache[index + 1];
-    *pDestBuf++ = m_pCache[index + 2];
+    *pDestBuf++ = pCache[index];
+    *pDestBuf++ = pCache[index + 1];
+    *pDestBuf++ = pCache[index + 2];
   }
 }
 
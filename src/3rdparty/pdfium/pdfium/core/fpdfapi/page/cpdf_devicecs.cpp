@@ -103,21 +103,17 @@ void CPDF_DeviceCS::TranslateImageLine(uint8_t* pDestBuf,
           pDestBuf += 3;
           pSrcBuf += 4;
         }
-      } else {
+      } else if (m_dwStdConversion) {
         for (int i = 0; i < pixels; i++) {
-          if (m_dwStdConversion) {
-            uint8_t k = pSrcBuf[3];
-            pDestBuf[2] = 255 - std::min(255, pSrcBuf[0] + k);
-            pDestBuf[1] = 255 - std::min(255, pSrcBuf[1] + k);
-            pDestBuf[0] = 255 - std::min(255, pSrcBuf[2] + k);
-          } else {
-            std::tie(pDestBuf[2], pDestBuf[1], pDestBuf[0]) =
-                AdobeCMYK_to_sRGB1(pSrcBuf[0], pSrcBuf[1], pSrcBuf[2],
-                                   pSrcBuf[3]);
-          }
+          uint8_t k = pSrcBuf[3];
+          pDestBuf[2] = 255 - std::min(255, pSrcBuf[0] + k);
+          pDestBuf[1] = 255 - std::min(255, pSrcBuf[1] + k);
+          pDestBuf[0] = 255 - std::min(255, pSrcBuf[2] + k);
           pSrcBuf += 4;
           pDestBuf += 3;
         }
+      } else {
+        AdobeCMYK_to_sRGB1_Scanline(pDestBuf, pSrcBuf, pixels, 3);
       }
       break;
     default:
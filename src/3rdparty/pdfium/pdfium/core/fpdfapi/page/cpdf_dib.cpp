@@ -37,6 +37,9 @@
 
 namespace {
 
+// Largest factor the decoders scale images down by, in each direction.
+constexpr int kMaxDownscaleFactor = 8;
+
 bool IsValidDimension(int value) {
   constexpr int kMaxImageDimension = 0x01FFFF;
   return value > 0 && value <= kMaxImageDimension;
@@ -145,6 +148,93 @@ JpxDecodeAction GetJpxDecodeAction(const CJPX_Decoder::JpxImageInfo& jpx_info,
   }
 }
 
+int DownscaledDimension(int value, int factor) {
+  return (value + factor - 1) / factor;
+}
+
+// Averages each |factor| x |factor| block of 8-bit samples decoded by
+// |source|, for decoders that cannot skip detail themselves.
+class BoxDownscaleDecoder final : public ScanlineDecoder {
+ public:
+  BoxDownscaleDecoder(std::unique_ptr<ScanlineDecoder> source,
+                      int width,
+                      int height,
+                      int comps,
+                      int factor)
+      : ScanlineDecoder(width,
+                        height,
+                        DownscaledDimension(width, factor),
+                        DownscaledDimension(height, factor),
+                        comps,
+                        8,
+                        DownscaledDimension(width, factor) * comps),
+        m_pSource(std::move(source)),
+        m_Factor(factor),
+        m_Sums(m_Pitch),
+        m_Scanline(m_Pitch) {}
+
+  // ScanlineDecoder:
+  bool v_Rewind() override {
+    m_SrcLine = 0;
+    return true;
+  }
+  uint8_t* v_GetNextLine() override;
+  uint32_t GetSrcOffset() override { return m_pSource->GetSrcOffset(); }
+
+ private:
+  std::unique_ptr<ScanlineDecoder> const m_pSource;
+  const int m_Factor;
+  int m_SrcLine = 0;
+  std::vector<uint32_t> m_Sums;
+  std::vector<uint8_t, FxAllocAllocator<uint8_t>> m_Scanline;
+};
+
+uint8_t* BoxDownscaleDecoder::v_GetNextLine() {
+  if (m_SrcLine >= m_OrigHeight)
+    return nullptr;
+
+  std::fill(m_Sums.begin(), m_Sums.end(), 0);
+  int rows = 0;
+  for (; rows < m_Factor && m_SrcLine + rows < m_OrigHeight; ++rows) {
+    const uint8_t* src = m_pSource->GetScanline(m_SrcLine + rows);
+    if (!src)
+      break;
+
+    uint32_t* sum = m_Sums.data();
+    for (int col = 0; col < m_OrigWidth; col += m_Factor) {
+      int cols = std::min(m_Factor, m_OrigWidth - col);
+      for (int i = 0; i < cols; ++i) {
+        for (int comp = 0; comp < m_nComps; ++comp)
+          sum[comp] += *src++;
+      }
+      sum += m_nComps;
+    }
+  }
+  m_SrcLine += m_Factor;
+  if (rows == 0)
+    return nullptr;
+
+  const uint32_t* sum = m_Sums.data();
+  uint8_t* dest = m_Scanline.data();
+  for (int col = 0; col < m_OrigWidth; col += m_Factor) {
+    uint32_t count = rows * std::min(m_Factor, m_OrigWidth - col);
+    for (int comp = 0; comp < m_nComps; ++comp)
+      *dest++ = static_cast<uint8_t>((*sum++ + count / 2) / count);
+  }
+  return m_Scanline.data();
+}
+
+std::unique_ptr<CJPX_Decoder> StartJpxDecoder(
+    pdfium::span<const uint8_t> src_span,
+    CJPX_Decoder::ColorSpaceOption option,
+    uint8_t resolution_levels_to_skip) {
+  std::unique_ptr<CJPX_Decoder> decoder =
+      CJPX_Decoder::Create(src_span, option, resolution_levels_to_skip);
+  if (!decoder || !decoder->StartDecode())
+    return nullptr;
+  return decoder;
+}
+
 }  // namespace
 
 CPDF_DIB::CPDF_DIB() = default;
@@ -254,11 +344,13 @@ CPDF_DIB::LoadState CPDF_DIB::StartLoadDIBBase(
     const CPDF_Dictionary* pPageResources,
     bool bStdCS,
     uint32_t GroupFamily,
-    bool bLoadMask) {
+    bool bLoadMask,
+    const CFX_Size& target_size) {
   if (!pStream)
     return LoadState::kFail;
 
   m_pDocument = pDoc;
+  m_TargetSize = target_size;
   m_pDict.Reset(pStream->GetDict());
   m_pStream.Reset(pStream);
   m_bStdCS = bStdCS;
@@ -504,7 +596,12 @@ CPDF_DIB::LoadState CPDF_DIB::CreateDecoder() {
     return LoadState::kFail;
 
   if (decoder == "JPXDecode") {
-    m_pCachedBitmap = LoadJpxBitmap();
+    uint8_t resolution_levels_to_skip = 0;
+    for (int factor = GetDownscaleFactor(kMaxDownscaleFactor); factor > 1;
+         factor /= 2) {
+      ++resolution_levels_to_skip;
+    }
+    m_pCachedBitmap = LoadJpxBitmap(resolution_levels_to_skip);
     return m_pCachedBitmap ? LoadState::kSuccess : LoadState::kFail;
   }
 
@@ -546,16 +643,63 @@ CPDF_DIB::LoadState CPDF_DIB::CreateDecoder() {
     return LoadState::kFail;
   if (provided_pitch.ValueOrDie() < requested_pitch.ValueOrDie())
     return LoadState::kFail;
+
+  // Flate and RunLength decoders have to produce every row, so at least keep
+  // the bitmap small by averaging blocks of whole 8-bit samples. Bilevel
+  // images are left alone, averaging would have to turn them into gray.
+  if (decoder != "DCTDecode" && m_bpc == 8 && m_pDecoder->GetBPC() == 8 &&
+      m_pDecoder->CountComps() == static_cast<int>(m_nComponents)) {
+    int factor = GetDownscaleFactor(kMaxDownscaleFactor);
+    if (factor > 1) {
+      m_pDecoder = std::make_unique<BoxDownscaleDecoder>(
+          std::move(m_pDecoder), m_Width, m_Height, m_nComponents, factor);
+      SetDownscaleFactor(factor);
+    }
+  }
   return LoadState::kSuccess;
 }
 
+bool CPDF_DIB::CanDownscaleSamples() const {
+  // Averaging stencil bits, colour keyed samples or palette indices does not
+  // give the average colour.
+  return !m_bImageMask && !m_bColorKey && m_Family != PDFCS_INDEXED &&
+         m_Family != PDFCS_PATTERN;
+}
+
+int CPDF_DIB::GetDownscaleFactor(int max_factor) const {
+  if (m_TargetSize.width <= 0 || m_TargetSize.height <= 0 ||
+      !CanDownscaleSamples()) {
+    return 1;
+  }
+
+  int factor = 1;
+  while (factor * 2 <= max_factor &&
+         DownscaledDimension(m_Width, factor * 2) >= m_TargetSize.width &&
+         DownscaledDimension(m_Height, factor * 2) >= m_TargetSize.height) {
+    factor *= 2;
+  }
+  return factor;
+}
+
+void CPDF_DIB::SetDownscaleFactor(int factor) {
+  if (factor <= 1)
+    return;
+
+  m_Width = DownscaledDimension(m_Width, factor);
+  m_Height = DownscaledDimension(m_Height, factor);
+  m_bDownscaled = true;
+}
+
 bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
                                 const CPDF_Dictionary* pParams) {
+  const int scale_denom = GetDownscaleFactor(kMaxDownscaleFactor);
   m_pDecoder = JpegModule::CreateDecoder(
       src_span, m_Width, m_Height, m_nComponents,
-      !pParams || pParams->GetIntegerFor("ColorTransform", 1));
-  if (m_pDecoder)
+      !pParams || pParams->GetIntegerFor("ColorTransform", 1), scale_denom);
+  if (m_pDecoder) {
+    SetDownscaleFactor(scale_denom);
     return true;
+  }
 
   Optional<JpegModule::JpegImageInfo> info_opt = JpegModule::LoadInfo(src_span);
   if (!info_opt.has_value())
@@ -572,8 +716,10 @@ bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
 
   if (m_nComponents == static_cast<uint32_t>(info.num_components)) {
     m_bpc = info.bits_per_components;
-    m_pDecoder = JpegModule::CreateDecoder(src_span, m_Width, m_Height,
-                                           m_nComponents, info.color_transform);
+    m_pDecoder =
+        JpegModule::CreateDecoder(src_span, m_Width, m_Height, m_nComponents,
+                                  info.color_transform, scale_denom);
+    SetDownscaleFactor(scale_denom);
     return true;
   }
 
@@ -617,26 +763,37 @@ bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
     return false;
 
   m_bpc = info.bits_per_components;
-  m_pDecoder = JpegModule::CreateDecoder(src_span, m_Width, m_Height,
-                                         m_nComponents, info.color_transform);
+  m_pDecoder =
+      JpegModule::CreateDecoder(src_span, m_Width, m_Height, m_nComponents,
+                                info.color_transform, scale_denom);
+  SetDownscaleFactor(scale_denom);
   return true;
 }
 
-RetainPtr<CFX_DIBitmap> CPDF_DIB::LoadJpxBitmap() {
-  std::unique_ptr<CJPX_Decoder> decoder =
-      CJPX_Decoder::Create(m_pStreamAcc->GetSpan(),
-                           ColorSpaceOptionFromColorSpace(m_pColorSpace.Get()));
+RetainPtr<CFX_DIBitmap> CPDF_DIB::LoadJpxBitmap(
+    uint8_t resolution_levels_to_skip) {
+  CJPX_Decoder::ColorSpaceOption option =
+      ColorSpaceOptionFromColorSpace(m_pColorSpace.Get());
+  std::unique_ptr<CJPX_Decoder> decoder = StartJpxDecoder(
+      m_pStreamAcc->GetSpan(), option, resolution_levels_to_skip);
+
+  // The codestream may have fewer resolution levels than asked to skip.
+  if (!decoder && resolution_levels_to_skip > 0) {
+    resolution_levels_to_skip = 0;
+    decoder = StartJpxDecoder(m_pStreamAcc->GetSpan(), option, 0);
+  }
   if (!decoder)
     return nullptr;
 
-  if (!decoder->StartDecode())
-    return nullptr;
-
+  const int factor = 1 << resolution_levels_to_skip;
   CJPX_Decoder::JpxImageInfo image_info = decoder->GetInfo();
-  if (static_cast<int>(image_info.width) < m_Width ||
-      static_cast<int>(image_info.height) < m_Height) {
+  if (static_cast<int>(image_info.width) <
+          DownscaledDimension(m_Width, factor) ||
+      static_cast<int>(image_info.height) <
+          DownscaledDimension(m_Height, factor)) {
     return nullptr;
   }
+  SetDownscaleFactor(factor);
 
   RetainPtr<CPDF_ColorSpace> original_colorspace = m_pColorSpace;
   bool swap_rgb = false;
@@ -822,8 +979,9 @@ bool CPDF_DIB::IsJBigImage() const {
 CPDF_DIB::LoadState CPDF_DIB::StartLoadMaskDIB(
     RetainPtr<const CPDF_Stream> mask) {
   m_pMask = pdfium::MakeRetain<CPDF_DIB>();
-  LoadState ret = m_pMask->StartLoadDIBBase(
-      m_pDocument.Get(), mask.Get(), false, nullptr, nullptr, true, 0, false);
+  LoadState ret = m_pMask->StartLoadDIBBase(m_pDocument.Get(), mask.Get(),
+                                            false, nullptr, nullptr, true, 0,
+                                            false, m_TargetSize);
   if (ret == LoadState::kContinue) {
     if (m_Status == LoadState::kFail)
       m_Status = LoadState::kContinue;
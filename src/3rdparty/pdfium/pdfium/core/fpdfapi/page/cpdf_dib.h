@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
@@ -59,6 +60,11 @@ class CPDF_DIB final : public CFX_DIBBase {
   RetainPtr<CPDF_ColorSpace> GetColorSpace() const { return m_pColorSpace; }
   uint32_t GetMatteColor() const { return m_MatteColor; }
 
+  // |target_size| is the smallest size worth decoding, usually the size of
+  // the image on the device. DCT and JPX images are decoded at a lower
+  // resolution and other 8-bit images with a scanline decoder are box
+  // filtered, as long as the result stays at or above |target_size|. An
+  // empty size decodes at full resolution.
   LoadState StartLoadDIBBase(CPDF_Document* pDoc,
                              const CPDF_Stream* pStream,
                              bool bHasMask,
@@ -66,12 +72,17 @@ class CPDF_DIB final : public CFX_DIBBase {
                              const CPDF_Dictionary* pPageResources,
                              bool bStdCS,
                              uint32_t GroupFamily,
-                             bool bLoadMask);
+                             bool bLoadMask,
+                             const CFX_Size& target_size);
   LoadState ContinueLoadDIBBase(PauseIndicatorIface* pPause);
   RetainPtr<CPDF_DIB> DetachMask();
 
   bool IsJBigImage() const;
 
+  // Whether the width and height are smaller than the image's own because
+  // of the target size passed to StartLoadDIBBase().
+  bool IsDownscaled() const { return m_bDownscaled; }
+
  private:
   CPDF_DIB();
   ~CPDF_DIB() override;
@@ -92,9 +103,12 @@ class CPDF_DIB final : public CFX_DIBBase {
   bool LoadColorInfo(const CPDF_Dictionary* pFormResources,
                      const CPDF_Dictionary* pPageResources);
   bool GetDecodeAndMaskArray(bool* bDefaultDecode, bool* bColorKey);
-  RetainPtr<CFX_DIBitmap> LoadJpxBitmap();
+  RetainPtr<CFX_DIBitmap> LoadJpxBitmap(uint8_t resolution_levels_to_skip);
   void LoadPalette();
   LoadState CreateDecoder();
+  bool CanDownscaleSamples() const;
+  int GetDownscaleFactor(int max_factor) const;
+  void SetDownscaleFactor(int factor);
   bool CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
                         const CPDF_Dictionary* pParams);
   void TranslateScanline24bpp(uint8_t* dest_scan,
@@ -151,6 +165,8 @@ class CPDF_DIB final : public CFX_DIBBase {
   bool m_bColorKey = false;
   bool m_bHasMask = false;
   bool m_bStdCS = false;
+  bool m_bDownscaled = false;
+  CFX_Size m_TargetSize;
   std::vector<DIB_COMP_DATA> m_CompData;
   std::unique_ptr<uint8_t, FxFreeDeleter> m_pLineBuf;
   std::unique_ptr<uint8_t, FxFreeDeleter> m_pMaskedLine;
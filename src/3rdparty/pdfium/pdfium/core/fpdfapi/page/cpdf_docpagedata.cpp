@@ -382,7 +382,7 @@ RetainPtr<CPDF_IccProfile> CPDF_DocPageData::GetIccProfile(
 
   auto it = m_IccProfileMap.find(pProfileStream);
   if (it != m_IccProfileMap.end() && it->second)
-    return pdfium::WrapRetain(it->second.Get());
+    return it->second;
 
   auto pAccessor = pdfium::MakeRetain<CPDF_StreamAcc>(pProfileStream);
   pAccessor->LoadAllDataFiltered();
@@ -392,11 +392,11 @@ RetainPtr<CPDF_IccProfile> CPDF_DocPageData::GetIccProfile(
   if (hash_it != m_HashProfileMap.end()) {
     auto it_copied_stream = m_IccProfileMap.find(hash_it->second.Get());
     if (it_copied_stream != m_IccProfileMap.end() && it_copied_stream->second)
-      return pdfium::WrapRetain(it_copied_stream->second.Get());
+      return it_copied_stream->second;
   }
   auto pProfile =
       pdfium::MakeRetain<CPDF_IccProfile>(pProfileStream, pAccessor->GetSpan());
-  m_IccProfileMap[pProfileStream].Reset(pProfile.Get());
+  m_IccProfileMap[pProfileStream] = pProfile;
   m_HashProfileMap[bsDigest].Reset(pProfileStream);
   return pProfile;
 }
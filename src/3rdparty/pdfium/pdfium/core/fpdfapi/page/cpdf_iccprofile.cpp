@@ -8,6 +8,7 @@
 
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fxcodec/icc/iccmodule.h"
+#include "third_party/base/stl_util.h"
 
 namespace {
 
@@ -32,3 +33,33 @@ CPDF_IccProfile::CPDF_IccProfile(const CPDF_Stream* pStream,
 }
 
 CPDF_IccProfile::~CPDF_IccProfile() = default;
+
+const uint8_t* CPDF_IccProfile::GetLookupTable() {
+  ASSERT(m_Transform);
+  if (!m_LookupTable.empty())
+    return m_LookupTable.data();
+
+  // |nMaxColors| will not overflow since |m_nSrcComponents| is limited in
+  // size.
+  int nMaxColors = 1;
+  for (uint32_t i = 0; i < m_nSrcComponents; i++)
+    nMaxColors *= 52;
+
+  m_LookupTable =
+      pdfium::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(nMaxColors, 3);
+  auto temp_src = pdfium::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(
+      nMaxColors, m_nSrcComponents);
+  size_t src_index = 0;
+  for (int i = 0; i < nMaxColors; i++) {
+    uint32_t color = i;
+    uint32_t order = nMaxColors / 52;
+    for (uint32_t c = 0; c < m_nSrcComponents; c++) {
+      temp_src[src_index++] = static_cast<uint8_t>(color / order * 5);
+      color %= order;
+      order /= 52;
+    }
+  }
+  IccModule::TranslateScanline(m_Transform.get(), m_LookupTable.data(),
+                               temp_src.data(), nMaxColors);
+  return m_LookupTable.data();
+}
@@ -8,7 +8,9 @@
 #define CORE_FPDFAPI_PAGE_CPDF_ICCPROFILE_H_
 
 #include <memory>
+#include <vector>
 
+#include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/observed_ptr.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "third_party/base/span.h"
@@ -30,6 +32,11 @@ class CPDF_IccProfile final : public Retainable, public Observable {
   fxcodec::CLcmsCmm* transform() { return m_Transform.get(); }
   uint32_t GetComponents() const { return m_nSrcComponents; }
 
+  // Returns the BGR translation of every color on a grid of 52 steps per
+  // component, built on first use. Lookups index it with each component
+  // divided by 5. Requires a supported profile.
+  const uint8_t* GetLookupTable();
+
  private:
   CPDF_IccProfile(const CPDF_Stream* pStream, pdfium::span<const uint8_t> span);
   ~CPDF_IccProfile() override;
@@ -38,6 +45,7 @@ class CPDF_IccProfile final : public Retainable, public Observable {
   uint32_t m_nSrcComponents = 0;
   RetainPtr<const CPDF_Stream> const m_pStream;
   std::unique_ptr<fxcodec::CLcmsCmm> m_Transform;
+  std::vector<uint8_t, FxAllocAllocator<uint8_t>> m_LookupTable;
 };
 
 #endif  // CORE_FPDFAPI_PAGE_CPDF_ICCPROFILE_H_
@@ -7,6 +7,7 @@
 #ifndef CORE_FPDFAPI_PAGE_CPDF_IMAGE_H_
 #define CORE_FPDFAPI_PAGE_CPDF_IMAGE_H_
 
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_system.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
@@ -55,7 +56,8 @@ class CPDF_Image final : public Retainable {
                         const CPDF_Dictionary* pPageResource,
                         bool bStdCS,
                         uint32_t GroupFamily,
-                        bool bLoadMask);
+                        bool bLoadMask,
+                        const CFX_Size& target_size);
 
   // Returns whether to Continue() or not.
   bool Continue(PauseIndicatorIface* pPause);
@@ -90,7 +90,8 @@ uint32_t DecodeInlineStream(pdfium::span<const uint8_t> src_span,
   if (decoder == "DCTDecode") {
     std::unique_ptr<ScanlineDecoder> pDecoder = JpegModule::CreateDecoder(
         src_span, width, height, 0,
-        !pParam || pParam->GetIntegerFor("ColorTransform", 1));
+        !pParam || pParam->GetIntegerFor("ColorTransform", 1),
+        /*scale_denom=*/1);
     return DecodeAllScanlines(std::move(pDecoder));
   }
   if (decoder == "CCITTFaxDecode") {
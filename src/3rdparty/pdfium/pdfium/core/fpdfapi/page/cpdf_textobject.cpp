@@ -11,6 +11,7 @@
 
 #include "core/fpdfapi/font/cpdf_cidfont.h"
 #include "core/fpdfapi/font/cpdf_font.h"
+#include "core/fxge/cfx_fontlock.h"
 
 #define ISLATINWORD(u) (u != 0x20 && u <= 0x28FF)
 
@@ -247,6 +248,8 @@ void CPDF_TextObject::SetTextRenderMode(TextRenderingMode mode) {
 }
 
 CFX_PointF CPDF_TextObject::CalcPositionData(float horz_scale) {
+  // Glyph metrics may be loaded lazily from a face shared between documents.
+  CFX_FontLock lock;
   float curpos = 0;
   float min_x = 10000 * 1.0f;
   float max_x = -10000 * 1.0f;
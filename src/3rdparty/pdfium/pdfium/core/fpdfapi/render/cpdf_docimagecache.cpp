@@ -0,0 +1,178 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
+
+#include <tuple>
+
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fxge/dib/cfx_dibbase.h"
+
+namespace {
+
+bool IsSmallerThan(const RetainPtr<CFX_DIBBase>& pDIB,
+                   const CFX_Size& target_size) {
+  // An empty target size asks for full resolution.
+  if (target_size.width <= 0 || target_size.height <= 0)
+    return true;
+
+  return pDIB->GetWidth() < target_size.width ||
+         pDIB->GetHeight() < target_size.height;
+}
+
+}  // namespace
+
+bool CPDF_DocImageCache::Key::operator<(const Key& that) const {
+  return std::tie(obj_num, cs_obj_num, group_family, bStdCS, bLoadMask) <
+         std::tie(that.obj_num, that.cs_obj_num, that.group_family,
+                  that.bStdCS, that.bLoadMask);
+}
+
+// static
+Optional<CPDF_DocImageCache::Key> CPDF_DocImageCache::MakeKey(
+    const CPDF_Stream* pStream,
+    const CPDF_Dictionary* pPageResources,
+    bool bStdCS,
+    uint32_t group_family,
+    bool bLoadMask) {
+  if (!pStream || pStream->IsInline() || !pStream->GetDict())
+    return pdfium::nullopt;
+
+  Key key = {pStream->GetObjNum(), 0, group_family, bStdCS, bLoadMask};
+
+  // Mirrors CPDF_DocPageData::GetColorSpace(): only a name, possibly wrapped
+  // in a one element array, is looked up in the resources.
+  const CPDF_Object* pCSObj =
+      pStream->GetDict()->GetDirectObjectFor("ColorSpace");
+  const CPDF_Array* pCSArray = pCSObj ? pCSObj->AsArray() : nullptr;
+  if (pCSArray && pCSArray->size() == 1)
+    pCSObj = pCSArray->GetDirectObjectAt(0);
+  if (!pCSObj || !pCSObj->IsName())
+    return key;
+
+  const CPDF_Dictionary* pColorSpaces =
+      pPageResources ? pPageResources->GetDictFor("ColorSpace") : nullptr;
+  if (!pColorSpaces)
+    return key;
+
+  ByteString name = pCSObj->GetString();
+  RetainPtr<CPDF_ColorSpace> pCS = CPDF_ColorSpace::ColorspaceFromName(name);
+  if (pCS) {
+    // Device color spaces only change through the Default* resources.
+    switch (pCS->GetFamily()) {
+      case PDFCS_DEVICERGB:
+        name = "DefaultRGB";
+        break;
+      case PDFCS_DEVICEGRAY:
+        name = "DefaultGray";
+        break;
+      case PDFCS_DEVICECMYK:
+        name = "DefaultCMYK";
+        break;
+      default:
+        return key;
+    }
+  }
+
+  const CPDF_Object* pResource = pColorSpaces->GetDirectObjectFor(name);
+  if (!pResource)
+    return key;
+
+  // A color space written directly into the resources has no identity that
+  // is shared between pages.
+  if (pResource->IsInline())
+    return pdfium::nullopt;
+
+  key.cs_obj_num = pResource->GetObjNum();
+  return key;
+}
+
+// static
+bool CPDF_DocImageCache::IsTooSmall(const RetainPtr<CFX_DIBBase>& pBitmap,
+                                    bool bBitmapDownscaled,
+                                    const RetainPtr<CFX_DIBBase>& pMask,
+                                    bool bMaskDownscaled,
+                                    const CFX_Size& target_size) {
+  if (bBitmapDownscaled && IsSmallerThan(pBitmap, target_size))
+    return true;
+  return bMaskDownscaled && pMask && IsSmallerThan(pMask, target_size);
+}
+
+CPDF_DocImageCache::CPDF_DocImageCache() = default;
+
+CPDF_DocImageCache::~CPDF_DocImageCache() = default;
+
+const CPDF_DocImageCache::Entry* CPDF_DocImageCache::Lookup(
+    const Key& key,
+    const CFX_Size& target_size) {
+  auto it = m_Entries.find(key);
+  if (it == m_Entries.end()) {
+    ++m_Misses;
+    return nullptr;
+  }
+
+  const Entry& entry = it->second.first;
+  if (IsTooSmall(entry.pBitmap, entry.bBitmapDownscaled, entry.pMask,
+                 entry.bMaskDownscaled, target_size)) {
+    ++m_Misses;
+    return nullptr;
+  }
+
+  ++m_Hits;
+  m_Lru.splice(m_Lru.begin(), m_Lru, it->second.second);
+  return &entry;
+}
+
+void CPDF_DocImageCache::Store(const Key& key, Entry entry) {
+  auto it = m_Entries.find(key);
+  if (it != m_Entries.end())
+    Erase(it);
+
+  if (!entry.pBitmap || entry.size > m_Budget)
+    return;
+
+  m_Usage += entry.size;
+  m_Lru.push_front(key);
+  m_Entries.emplace(key, std::make_pair(std::move(entry), m_Lru.begin()));
+  Shrink();
+}
+
+void CPDF_DocImageCache::Remove(uint32_t obj_num) {
+  auto it = m_Entries.lower_bound(Key{obj_num, 0, 0, false, false});
+  while (it != m_Entries.end() && it->first.obj_num == obj_num)
+    Erase(it++);
+}
+
+void CPDF_DocImageCache::SetBudget(size_t budget) {
+  m_Budget = budget;
+  Shrink();
+}
+
+CPDF_DocImageCache::Stats CPDF_DocImageCache::GetStats() const {
+  Stats stats;
+  stats.entries = m_Entries.size();
+  stats.usage = m_Usage;
+  stats.budget = m_Budget;
+  stats.hits = m_Hits;
+  stats.misses = m_Misses;
+  stats.evictions = m_Evictions;
+  return stats;
+}
+
+void CPDF_DocImageCache::Erase(
+    std::map<Key, std::pair<Entry, LruList::iterator>>::iterator it) {
+  m_Usage -= it->second.first.size;
+  m_Lru.erase(it->second.second);
+  m_Entries.erase(it);
+}
+
+void CPDF_DocImageCache::Shrink() {
+  while (m_Usage > m_Budget && !m_Lru.empty()) {
+    Erase(m_Entries.find(m_Lru.back()));
+    ++m_Evictions;
+  }
+}
@@ -0,0 +1,117 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
+#define CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
+
+#include <list>
+#include <map>
+#include <utility>
+
+#include "core/fxcrt/fx_coordinates.h"
+#include "core/fxcrt/fx_system.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "third_party/base/optional.h"
+
+class CFX_DIBBase;
+class CPDF_Dictionary;
+class CPDF_Stream;
+
+// Decoded images shared by all pages of a document, so that an image drawn on
+// many pages is decoded once instead of once per CPDF_PageRenderCache.
+// Entries are evicted least recently used first once the decoded bytes exceed
+// the budget.
+class CPDF_DocImageCache {
+ public:
+  // Everything besides the image stream that changes the decoded result.
+  struct Key {
+    bool operator<(const Key& that) const;
+
+    uint32_t obj_num;
+    // Object number of the color space resource a named /ColorSpace resolves
+    // to through the page resources, 0 when it needs none.
+    uint32_t cs_obj_num;
+    uint32_t group_family;
+    bool bStdCS;
+    bool bLoadMask;
+  };
+
+  struct Entry {
+    RetainPtr<CFX_DIBBase> pBitmap;
+    RetainPtr<CFX_DIBBase> pMask;
+    uint32_t matte_color = 0;
+    bool bBitmapDownscaled = false;
+    bool bMaskDownscaled = false;
+    uint32_t size = 0;
+  };
+
+  struct Stats {
+    size_t entries = 0;
+    size_t usage = 0;
+    size_t budget = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  static constexpr size_t kDefaultBudget = 64 * 1024 * 1024;
+
+  // Returns no key for images whose decode depends on more than the key
+  // records, e.g. inline images or color spaces defined directly in the page
+  // resources.
+  static Optional<Key> MakeKey(const CPDF_Stream* pStream,
+                               const CPDF_Dictionary* pPageResources,
+                               bool bStdCS,
+                               uint32_t group_family,
+                               bool bLoadMask);
+
+  // Whether a decode was made smaller than |target_size|, see
+  // CPDF_DIB::StartLoadDIBBase().
+  static bool IsTooSmall(const RetainPtr<CFX_DIBBase>& pBitmap,
+                         bool bBitmapDownscaled,
+                         const RetainPtr<CFX_DIBBase>& pMask,
+                         bool bMaskDownscaled,
+                         const CFX_Size& target_size);
+
+  CPDF_DocImageCache();
+  ~CPDF_DocImageCache();
+
+  CPDF_DocImageCache(const CPDF_DocImageCache&) = delete;
+  CPDF_DocImageCache& operator=(const CPDF_DocImageCache&) = delete;
+
+  // Returns the decode of |key| unless it is too small for |target_size|.
+  // Counts a hit or a miss.
+  const Entry* Lookup(const Key& key, const CFX_Size& target_size);
+
+  // Replaces any decode of |key|. Decodes larger than the whole budget are
+  // not kept.
+  void Store(const Key& key, Entry entry);
+
+  // Drops all decodes of the image object |obj_num|, e.g. after its stream
+  // was replaced.
+  void Remove(uint32_t obj_num);
+
+  // A budget of 0 disables the cache.
+  void SetBudget(size_t budget);
+  size_t GetBudget() const { return m_Budget; }
+
+  Stats GetStats() const;
+
+ private:
+  using LruList = std::list<Key>;
+
+  void Erase(std::map<Key, std::pair<Entry, LruList::iterator>>::iterator it);
+  void Shrink();
+
+  // Most recently used first.
+  LruList m_Lru;
+  std::map<Key, std::pair<Entry, LruList::iterator>> m_Entries;
+  size_t m_Budget = kDefaultBudget;
+  size_t m_Usage = 0;
+  uint64_t m_Hits = 0;
+  uint64_t m_Misses = 0;
+  uint64_t m_Evictions = 0;
+};
+
+#endif  // CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
@@ -10,6 +10,7 @@
 #include <map>
 
 #include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
 #include "core/fxcrt/observed_ptr.h"
 #include "core/fxcrt/retain_ptr.h"
 
@@ -31,6 +32,7 @@ class CPDF_DocRenderData : public CPDF_Document::RenderDataIface {
 
   RetainPtr<CPDF_Type3Cache> GetCachedType3(CPDF_Type3Font* pFont);
   RetainPtr<CPDF_TransferFunc> GetTransferFunc(const CPDF_Object* pObj);
+  CPDF_DocImageCache* GetImageCache() { return &m_ImageCache; }
 
  protected:
   // protected for use by test subclasses.
@@ -41,6 +43,7 @@ class CPDF_DocRenderData : public CPDF_Document::RenderDataIface {
   std::map<CPDF_Font*, ObservedPtr<CPDF_Type3Cache>> m_Type3FaceMap;
   std::map<const CPDF_Object*, ObservedPtr<CPDF_TransferFunc>>
       m_TransferFuncMap;
+  CPDF_DocImageCache m_ImageCache;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_DOCRENDERDATA_H_
@@ -15,6 +15,7 @@
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
@@ -33,6 +34,11 @@ uint32_t GetEstimatedImageSize(const RetainPtr<CFX_DIBBase>& pDIB) {
          pDIB->GetPaletteSize() * 4;
 }
 
+CPDF_DocImageCache* GetDocImageCache(const CPDF_Document* pDoc) {
+  CPDF_DocRenderData* pRenderData = CPDF_DocRenderData::FromDocument(pDoc);
+  return pRenderData ? pRenderData->GetImageCache() : nullptr;
+}
+
 }  // namespace
 
 CPDF_ImageCacheEntry::CPDF_ImageCacheEntry(CPDF_Document* pDoc,
@@ -57,8 +63,30 @@ RetainPtr<CFX_DIBBase> CPDF_ImageCacheEntry::DetachMask() {
 CPDF_DIB::LoadState CPDF_ImageCacheEntry::StartGetCachedBitmap(
     const CPDF_Dictionary* pPageResources,
     const CPDF_RenderStatus* pRenderStatus,
-    bool bStdCS) {
-  if (m_pCachedBitmap) {
+    bool bStdCS,
+    const CFX_Size& target_size) {
+  if (m_pCachedBitmap && !IsCachedBitmapTooSmall(target_size)) {
+    m_pCurBitmap = m_pCachedBitmap;
+    m_pCurMask = m_pCachedMask;
+    return CPDF_DIB::LoadState::kSuccess;
+  }
+
+  m_DocCacheKey = CPDF_DocImageCache::MakeKey(
+      m_pImage->GetStream(), pPageResources, bStdCS,
+      pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask());
+  CPDF_DocImageCache* pDocCache = GetDocImageCache(m_pDocument.Get());
+  const CPDF_DocImageCache::Entry* pDocEntry =
+      pDocCache && m_DocCacheKey.has_value()
+          ? pDocCache->Lookup(m_DocCacheKey.value(), target_size)
+          : nullptr;
+  if (pDocEntry) {
+    m_pCachedBitmap = pDocEntry->pBitmap;
+    m_pCachedMask = pDocEntry->pMask;
+    m_MatteColor = pDocEntry->matte_color;
+    m_bCachedBitmapDownscaled = pDocEntry->bBitmapDownscaled;
+    m_bCachedMaskDownscaled = pDocEntry->bMaskDownscaled;
+    m_dwTimeCount = pRenderStatus->GetContext()->GetPageCache()->GetTimeCount();
+    CalcSize();
     m_pCurBitmap = m_pCachedBitmap;
     m_pCurMask = m_pCachedMask;
     return CPDF_DIB::LoadState::kSuccess;
@@ -68,7 +96,8 @@ CPDF_DIB::LoadState CPDF_ImageCacheEntry::StartGetCachedBitmap(
   CPDF_DIB::LoadState ret = m_pCurBitmap.As<CPDF_DIB>()->StartLoadDIBBase(
       m_pDocument.Get(), m_pImage->GetStream(), true,
       pRenderStatus->GetFormResource(), pPageResources, bStdCS,
-      pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask());
+      pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask(),
+      target_size);
   if (ret == CPDF_DIB::LoadState::kContinue)
     return CPDF_DIB::LoadState::kContinue;
 
@@ -96,11 +125,17 @@ bool CPDF_ImageCacheEntry::Continue(PauseIndicatorIface* pPause,
 void CPDF_ImageCacheEntry::ContinueGetCachedBitmap(
     const CPDF_RenderStatus* pRenderStatus) {
   m_MatteColor = m_pCurBitmap.As<CPDF_DIB>()->GetMatteColor();
-  m_pCurMask = m_pCurBitmap.As<CPDF_DIB>()->DetachMask();
+  RetainPtr<CPDF_DIB> pMask = m_pCurBitmap.As<CPDF_DIB>()->DetachMask();
+  m_bCachedBitmapDownscaled = m_pCurBitmap.As<CPDF_DIB>()->IsDownscaled();
+  m_bCachedMaskDownscaled = pMask && pMask->IsDownscaled();
+  m_pCurMask = std::move(pMask);
   CPDF_RenderContext* pContext = pRenderStatus->GetContext();
   CPDF_PageRenderCache* pPageRenderCache = pContext->GetPageCache();
   m_dwTimeCount = pPageRenderCache->GetTimeCount();
-  if (m_pCurBitmap->GetPitch() * m_pCurBitmap->GetHeight() < kHugeImageSize) {
+  // Huge images stay a CPDF_DIB that decodes on demand and are not shared.
+  const bool bBuffered =
+      m_pCurBitmap->GetPitch() * m_pCurBitmap->GetHeight() < kHugeImageSize;
+  if (bBuffered) {
     m_pCachedBitmap = m_pCurBitmap->Clone(nullptr);
     m_pCurBitmap.Reset();
   } else {
@@ -113,6 +148,27 @@ void CPDF_ImageCacheEntry::ContinueGetCachedBitmap(
   m_pCurBitmap = m_pCachedBitmap;
   m_pCurMask = m_pCachedMask;
   CalcSize();
+
+  CPDF_DocImageCache* pDocCache = GetDocImageCache(m_pDocument.Get());
+  if (!bBuffered || !pDocCache || !m_DocCacheKey.has_value())
+    return;
+
+  CPDF_DocImageCache::Entry entry;
+  entry.pBitmap = m_pCachedBitmap;
+  entry.pMask = m_pCachedMask;
+  entry.matte_color = m_MatteColor;
+  entry.bBitmapDownscaled = m_bCachedBitmapDownscaled;
+  entry.bMaskDownscaled = m_bCachedMaskDownscaled;
+  entry.size = m_dwCacheSize;
+  pDocCache->Store(m_DocCacheKey.value(), std::move(entry));
+}
+
+bool CPDF_ImageCacheEntry::IsCachedBitmapTooSmall(
+    const CFX_Size& target_size) const {
+  return CPDF_DocImageCache::IsTooSmall(m_pCachedBitmap,
+                                        m_bCachedBitmapDownscaled,
+                                        m_pCachedMask, m_bCachedMaskDownscaled,
+                                        target_size);
 }
 
 void CPDF_ImageCacheEntry::CalcSize() {
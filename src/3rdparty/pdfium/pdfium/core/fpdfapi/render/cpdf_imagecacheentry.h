@@ -8,6 +8,8 @@
 #define CORE_FPDFAPI_RENDER_CPDF_IMAGECACHEENTRY_H_
 
 #include "core/fpdfapi/page/cpdf_dib.h"
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_system.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
@@ -29,10 +31,14 @@ class CPDF_ImageCacheEntry {
   uint32_t GetTimeCount() const { return m_dwTimeCount; }
   CPDF_Image* GetImage() const { return m_pImage.Get(); }
 
+  // Reuses the cached bitmap unless it was decoded smaller than
+  // |target_size|, see CPDF_DIB::StartLoadDIBBase(). Otherwise takes the
+  // decode from the document's CPDF_DocImageCache before decoding again.
   CPDF_DIB::LoadState StartGetCachedBitmap(
       const CPDF_Dictionary* pPageResources,
       const CPDF_RenderStatus* pRenderStatus,
-      bool bStdCS);
+      bool bStdCS,
+      const CFX_Size& target_size);
 
   // Returns whether to Continue() or not.
   bool Continue(PauseIndicatorIface* pPause, CPDF_RenderStatus* pRenderStatus);
@@ -46,6 +52,7 @@ class CPDF_ImageCacheEntry {
  private:
   void ContinueGetCachedBitmap(const CPDF_RenderStatus* pRenderStatus);
   void CalcSize();
+  bool IsCachedBitmapTooSmall(const CFX_Size& target_size) const;
 
   UnownedPtr<CPDF_Document> const m_pDocument;
   RetainPtr<CPDF_Image> const m_pImage;
@@ -53,7 +60,10 @@ class CPDF_ImageCacheEntry {
   RetainPtr<CFX_DIBBase> m_pCurMask;
   RetainPtr<CFX_DIBBase> m_pCachedBitmap;
   RetainPtr<CFX_DIBBase> m_pCachedMask;
+  bool m_bCachedBitmapDownscaled = false;
+  bool m_bCachedMaskDownscaled = false;
   uint32_t m_dwCacheSize = 0;
+  Optional<CPDF_DocImageCache::Key> m_DocCacheKey;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_IMAGECACHEENTRY_H_
@@ -22,17 +22,19 @@ CPDF_ImageLoader::~CPDF_ImageLoader() = default;
 
 bool CPDF_ImageLoader::Start(CPDF_ImageObject* pImage,
                              const CPDF_RenderStatus* pRenderStatus,
-                             bool bStdCS) {
+                             bool bStdCS,
+                             const CFX_Size& target_size) {
   m_pCache = pRenderStatus->GetContext()->GetPageCache();
   m_pImageObject = pImage;
   bool ret;
   if (m_pCache) {
     ret = m_pCache->StartGetCachedBitmap(m_pImageObject->GetImage(),
-                                         pRenderStatus, bStdCS);
+                                         pRenderStatus, bStdCS, target_size);
   } else {
     ret = m_pImageObject->GetImage()->StartLoadDIBBase(
         pRenderStatus->GetFormResource(), pRenderStatus->GetPageResource(),
-        bStdCS, pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask());
+        bStdCS, pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask(),
+        target_size);
   }
   if (!ret)
     HandleFailure();
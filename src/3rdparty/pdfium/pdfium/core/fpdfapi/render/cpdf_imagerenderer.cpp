@@ -35,6 +35,7 @@
 #include "core/fxge/dib/cfx_dibitmap.h"
 #include "core/fxge/dib/cfx_imagestretcher.h"
 #include "core/fxge/dib/cfx_imagetransformer.h"
+#include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/stl_util.h"
 
 #if defined(_SKIA_SUPPORT_)
@@ -62,13 +63,31 @@ bool CPDF_ImageRenderer::StartLoadDIBBase() {
   if (!GetUnitRect().has_value())
     return false;
 
-  if (!m_Loader.Start(m_pImageObject.Get(), m_pRenderStatus.Get(), m_bStdCS))
+  if (!m_Loader.Start(m_pImageObject.Get(), m_pRenderStatus.Get(), m_bStdCS,
+                      GetTargetSize())) {
     return false;
+  }
 
   m_Mode = Mode::kDefault;
   return true;
 }
 
+CFX_Size CPDF_ImageRenderer::GetTargetSize() const {
+  // Printers get the image at full resolution.
+  if (m_pRenderStatus->GetRenderDevice()->GetDeviceType() !=
+      DeviceType::kDisplay) {
+    return CFX_Size();
+  }
+
+  // The image's unit square maps to these lengths on the device, whatever
+  // the rotation.
+  float width = FXSYS_sqrt2(m_ImageMatrix.a, m_ImageMatrix.b);
+  float height = FXSYS_sqrt2(m_ImageMatrix.c, m_ImageMatrix.d);
+  return CFX_Size(
+      std::max(1, pdfium::base::saturated_cast<int>(ceilf(width))),
+      std::max(1, pdfium::base::saturated_cast<int>(ceilf(height))));
+}
+
 bool CPDF_ImageRenderer::StartRenderDIBBase() {
   if (!m_Loader.GetBitmap())
     return false;
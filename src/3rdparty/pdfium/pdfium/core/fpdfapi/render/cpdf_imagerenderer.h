@@ -77,6 +77,7 @@ class CPDF_ImageRenderer {
   const CPDF_RenderOptions& GetRenderOptions() const;
   void HandleFilters();
   Optional<FX_RECT> GetUnitRect() const;
+  CFX_Size GetTargetSize() const;
   bool GetDimensionsFromUnitRect(const FX_RECT& rect,
                                  int* left,
                                  int* top,
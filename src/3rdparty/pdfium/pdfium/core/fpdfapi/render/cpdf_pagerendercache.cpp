@@ -11,6 +11,8 @@
 
 #include "core/fpdfapi/page/cpdf_image.h"
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_imagecacheentry.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
 #include "core/fxge/dib/cfx_dibitmap.h"
@@ -74,18 +76,22 @@ void CPDF_PageRenderCache::ClearImageCacheEntry(CPDF_Stream* pStream) {
 bool CPDF_PageRenderCache::StartGetCachedBitmap(
     const RetainPtr<CPDF_Image>& pImage,
     const CPDF_RenderStatus* pRenderStatus,
-    bool bStdCS) {
+    bool bStdCS,
+    const CFX_Size& target_size) {
   CPDF_Stream* pStream = pImage->GetStream();
   const auto it = m_ImageCache.find(pStream);
   m_bCurFindCache = it != m_ImageCache.end();
   if (m_bCurFindCache) {
     m_pCurImageCacheEntry = it->second.get();
+    // The entry decodes again when its bitmap is too small for
+    // |target_size|, so its size is counted again once loading finishes.
+    m_nCacheSize -= m_pCurImageCacheEntry->EstimateSize();
   } else {
     m_pCurImageCacheEntry =
         std::make_unique<CPDF_ImageCacheEntry>(m_pPage->GetDocument(), pImage);
   }
   CPDF_DIB::LoadState ret = m_pCurImageCacheEntry->StartGetCachedBitmap(
-      m_pPage->m_pPageResources.Get(), pRenderStatus, bStdCS);
+      m_pPage->m_pPageResources.Get(), pRenderStatus, bStdCS, target_size);
   if (ret == CPDF_DIB::LoadState::kContinue)
     return true;
 
@@ -93,9 +99,7 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
   if (!m_bCurFindCache)
     m_ImageCache[pStream] = m_pCurImageCacheEntry.Release();
 
-  if (ret == CPDF_DIB::LoadState::kFail)
-    m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
-
+  m_nCacheSize += m_pCurImageCacheEntry->EstimateSize();
   return false;
 }
 
@@ -118,6 +122,12 @@ void CPDF_PageRenderCache::ResetBitmapForImage(
     const RetainPtr<CPDF_Image>& pImage) {
   CPDF_ImageCacheEntry* pEntry;
   CPDF_Stream* pStream = pImage->GetStream();
+  // Other pages may hold the old decode in the shared cache as well.
+  CPDF_DocRenderData* pRenderData =
+      CPDF_DocRenderData::FromDocument(m_pPage->GetDocument());
+  if (pRenderData && pStream && !pStream->IsInline())
+    pRenderData->GetImageCache()->Remove(pStream->GetObjNum());
+
   const auto it = m_ImageCache.find(pStream);
   if (it == m_ImageCache.end())
     return;
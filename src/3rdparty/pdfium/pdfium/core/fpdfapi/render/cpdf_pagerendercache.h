@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_system.h"
 #include "core/fxcrt/maybe_owned.h"
 #include "core/fxcrt/retain_ptr.h"
@@ -33,6 +34,7 @@ class CPDF_PageRenderCache : public CPDF_Page::RenderCacheIface {
 
   void CacheOptimization(int32_t dwLimitCacheSize);
   uint32_t GetTimeCount() const { return m_nTimeCount; }
+  uint32_t GetCacheSize() const { return m_nCacheSize; }
   CPDF_Page* GetPage() const { return m_pPage.Get(); }
   CPDF_ImageCacheEntry* GetCurImageCacheEntry() const {
     return m_pCurImageCacheEntry.Get();
@@ -40,7 +42,8 @@ class CPDF_PageRenderCache : public CPDF_Page::RenderCacheIface {
 
   bool StartGetCachedBitmap(const RetainPtr<CPDF_Image>& pImage,
                             const CPDF_RenderStatus* pRenderStatus,
-                            bool bStdCS);
+                            bool bStdCS,
+                            const CFX_Size& target_size);
 
   bool Continue(PauseIndicatorIface* pPause, CPDF_RenderStatus* pRenderStatus);
 
@@ -6,6 +6,8 @@
 
 #include "core/fpdfapi/render/cpdf_progressiverenderer.h"
 
+#include <algorithm>
+
 #include "core/fpdfapi/page/cpdf_image.h"
 #include "core/fpdfapi/page/cpdf_imageobject.h"
 #include "core/fpdfapi/page/cpdf_pageobject.h"
@@ -35,9 +37,22 @@ void CPDF_ProgressiveRenderer::Start(PauseIndicatorIface* pPause) {
     return;
   }
   m_Status = kToBeContinued;
+  for (size_t i = 0; i < m_pContext->CountLayers(); ++i) {
+    m_nTotalObjects +=
+        m_pContext->GetLayer(i)->m_pObjectHolder->GetPageObjectCount();
+  }
   Continue(pPause);
 }
 
+int CPDF_ProgressiveRenderer::GetProgress() const {
+  if (m_Status == kDone)
+    return 100;
+  if (m_nTotalObjects == 0)
+    return 0;
+  return static_cast<int>(
+      std::min<size_t>(99, m_nVisitedObjects * 100 / m_nTotalObjects));
+}
+
 void CPDF_ProgressiveRenderer::Continue(PauseIndicatorIface* pPause) {
   while (m_Status == kToBeContinued) {
     if (!m_pCurrentLayer) {
@@ -79,6 +94,7 @@ void CPDF_ProgressiveRenderer::Continue(PauseIndicatorIface* pPause) {
             pCurObj->AsImage()->GetImage()->IsMask()) {
           if (m_pDevice->GetDeviceType() == DeviceType::kPrinter) {
             m_LastObjectRendered = iter;
+            ++m_nVisitedObjects;
             m_pRenderStatus->ProcessClipPath(pCurObj->m_ClipPath,
                                              m_pCurrentLayer->m_Matrix);
             return;
@@ -101,6 +117,7 @@ void CPDF_ProgressiveRenderer::Continue(PauseIndicatorIface* pPause) {
           --nObjsToGo;
       }
       m_LastObjectRendered = iter;
+      ++m_nVisitedObjects;
       if (nObjsToGo == 0) {
         if (pPause && pPause->NeedToPauseNow())
           return;
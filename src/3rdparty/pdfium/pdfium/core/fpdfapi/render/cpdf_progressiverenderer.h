@@ -37,6 +37,8 @@ class CPDF_ProgressiveRenderer {
   ~CPDF_ProgressiveRenderer();
 
   Status GetStatus() const { return m_Status; }
+  // Percentage (0-100) of page objects, across all layers, already visited.
+  int GetProgress() const;
   void Start(PauseIndicatorIface* pPause);
   void Continue(PauseIndicatorIface* pPause);
 
@@ -53,6 +55,8 @@ class CPDF_ProgressiveRenderer {
   uint32_t m_LayerIndex = 0;
   CPDF_RenderContext::Layer* m_pCurrentLayer = nullptr;
   CPDF_PageObjectHolder::const_iterator m_LastObjectRendered;
+  size_t m_nTotalObjects = 0;
+  size_t m_nVisitedObjects = 0;
 };
 
 #endif  // CORE_FPDFAPI_RENDER_CPDF_PROGRESSIVERENDERER_H_
@@ -12,6 +12,7 @@
 #include "core/fpdfapi/font/cpdf_font.h"
 #include "core/fpdfapi/render/charposlist.h"
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_graphstatedata.h"
 #include "core/fxge/cfx_pathdata.h"
 #include "core/fxge/cfx_renderdevice.h"
@@ -60,6 +61,7 @@ bool CPDF_TextRenderer::DrawTextPath(
     FX_ARGB stroke_argb,
     CFX_PathData* pClippingPath,
     const CFX_FillRenderOptions& fill_options) {
+  CFX_FontLock lock;
   std::vector<TextCharPos> pos =
       GetCharPosList(char_codes, char_pos, pFont, font_size);
   if (pos.empty())
@@ -106,6 +108,7 @@ void CPDF_TextRenderer::DrawTextString(CFX_RenderDevice* pDevice,
   if (pFont->IsType3Font())
     return;
 
+  CFX_FontLock lock;
   int nChars = pFont->CountChar(str.AsStringView());
   if (nChars <= 0)
     return;
@@ -138,6 +141,9 @@ bool CPDF_TextRenderer::DrawNormalText(CFX_RenderDevice* pDevice,
                                        const CFX_Matrix& mtText2Device,
                                        FX_ARGB fill_argb,
                                        const CPDF_RenderOptions& options) {
+  // Glyph lookup, fallback fonts and the glyph caches are shared between
+  // documents.
+  CFX_FontLock lock;
   std::vector<TextCharPos> pos =
       GetCharPosList(char_codes, char_pos, pFont, font_size);
   if (pos.empty())
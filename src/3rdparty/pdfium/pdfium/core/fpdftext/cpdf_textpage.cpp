@@ -7,10 +7,12 @@
 #include "core/fpdftext/cpdf_textpage.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "core/fpdfapi/font/cpdf_cidfont.h"
 #include "core/fpdfapi/font/cpdf_font.h"
 #include "core/fpdfapi/page/cpdf_form.h"
 #include "core/fpdfapi/page/cpdf_formobject.h"
@@ -24,6 +26,7 @@
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/fx_unicode.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "third_party/base/stl_util.h"
 
 namespace {
@@ -241,8 +244,20 @@ CPDF_TextPage::CharInfo::CharInfo(const CharInfo&) = default;
 
 CPDF_TextPage::CharInfo::~CharInfo() = default;
 
+CPDF_TextPage::CharObject::CharObject() = default;
+
+CPDF_TextPage::CharObject::CharObject(CPDF_TextObject* pTextObj,
+                                      const CFX_Matrix& matrix)
+    : m_pTextObj(pTextObj), m_Matrix(matrix) {}
+
+CPDF_TextPage::CharObject::CharObject(const CharObject& that) = default;
+
+CPDF_TextPage::CharObject::~CharObject() = default;
+
 CPDF_TextPage::CPDF_TextPage(const CPDF_Page* pPage, bool rtl)
     : m_pPage(pPage), m_rtl(rtl), m_DisplayMatrix(GetPageMatrix(pPage)) {
+  // Char boxes and unicode lookups reach into the shared font state.
+  CFX_FontLock lock;
   Init();
 }
 
@@ -252,7 +267,7 @@ void CPDF_TextPage::Init() {
   m_TextBuf.SetAllocStep(10240);
   ProcessObject();
 
-  const int nCount = CountChars();
+  const int nCount = pdfium::CollectionSize<int>(m_CharList);
   if (nCount)
     m_CharIndices.push_back(0);
 
@@ -280,10 +295,58 @@ void CPDF_TextPage::Init() {
   }
   if (m_CharIndices.size() % 2)
     m_CharIndices.pop_back();
+
+  SealCharList();
+}
+
+void CPDF_TextPage::SealCharList() {
+  const size_t nCount = m_CharList.size();
+  m_CharUnicodes.reserve(nCount);
+  m_CharCodes.reserve(nCount);
+  m_CharTextIndices.reserve(nCount);
+  m_CharTypes.reserve(nCount);
+  m_CharOrigins.reserve(nCount);
+  m_CharBoxes.reserve(nCount);
+  m_CharObjectIndices.reserve(nCount);
+
+  // Glyphs of one text object usually share its matrix, so most characters
+  // refer to an entry that already exists. Generated characters interleave
+  // with real ones, hence the lookup by text object and not only the last one.
+  std::map<const CPDF_TextObject*, uint32_t> last_objects;
+  for (const CharInfo& charinfo : m_CharList) {
+    m_CharUnicodes.push_back(charinfo.m_Unicode);
+    m_CharCodes.push_back(charinfo.m_CharCode);
+    m_CharTextIndices.push_back(charinfo.m_Index);
+    m_CharTypes.push_back(charinfo.m_CharType);
+    m_CharOrigins.push_back(charinfo.m_Origin);
+    m_CharBoxes.push_back(charinfo.m_CharBox);
+
+    CPDF_TextObject* pTextObj = charinfo.m_pTextObj.Get();
+    auto it = last_objects.find(pTextObj);
+    uint32_t object_index;
+    if (it != last_objects.end() &&
+        m_CharObjects[it->second].m_Matrix == charinfo.m_Matrix) {
+      object_index = it->second;
+    } else {
+      object_index = pdfium::CollectionSize<uint32_t>(m_CharObjects);
+      m_CharObjects.emplace_back(pTextObj, charinfo.m_Matrix);
+      last_objects[pTextObj] = object_index;
+    }
+    m_CharObjectIndices.push_back(object_index);
+  }
+  m_CharObjects.shrink_to_fit();
+
+  // Release the deque blocks, clear() keeps them allocated.
+  std::deque<CharInfo>().swap(m_CharList);
+  std::deque<CharInfo>().swap(m_TempCharList);
+}
+
+CPDF_TextObject* CPDF_TextPage::GetCharTextObject(size_t index) const {
+  return m_CharObjects[m_CharObjectIndices[index]].m_pTextObj.Get();
 }
 
 int CPDF_TextPage::CountChars() const {
-  return pdfium::CollectionSize<int>(m_CharList);
+  return pdfium::CollectionSize<int>(m_CharUnicodes);
 }
 
 int CPDF_TextPage::CharIndexFromTextIndex(int text_index) const {
@@ -327,32 +390,79 @@ std::vector<CFX_FloatRect> CPDF_TextPage::GetRectArray(int start,
   int curPos = start;
   bool bFlagNewRect = true;
   while (nCount--) {
-    const CharInfo& info_curchar = m_CharList[curPos++];
-    if (info_curchar.m_CharType == CPDF_TextPage::CharType::kGenerated)
+    const size_t index = curPos++;
+    if (m_CharTypes[index] == CPDF_TextPage::CharType::kGenerated)
       continue;
-    if (info_curchar.m_CharBox.Width() < kSizeEpsilon ||
-        info_curchar.m_CharBox.Height() < kSizeEpsilon) {
+    const CFX_FloatRect& charbox = m_CharBoxes[index];
+    if (charbox.Width() < kSizeEpsilon || charbox.Height() < kSizeEpsilon)
       continue;
-    }
+    CPDF_TextObject* pTextObj = GetCharTextObject(index);
     if (!pCurObj)
-      pCurObj = info_curchar.m_pTextObj.Get();
-    if (pCurObj != info_curchar.m_pTextObj) {
+      pCurObj = pTextObj;
+    if (pCurObj != pTextObj) {
       rects.push_back(rect);
-      pCurObj = info_curchar.m_pTextObj.Get();
+      pCurObj = pTextObj;
       bFlagNewRect = true;
     }
     if (bFlagNewRect) {
       bFlagNewRect = false;
-      rect = info_curchar.m_CharBox;
+      rect = charbox;
       rect.Normalize();
       continue;
     }
-    rect.Union(info_curchar.m_CharBox);
+    rect.Union(charbox);
   }
   rects.push_back(rect);
   return rects;
 }
 
+size_t CPDF_TextPage::AppendLineRects(
+    int start,
+    int nCount,
+    std::vector<CFX_FloatRect>* rects) const {
+  const int nCharListSize = CountChars();
+  if (start < 0 || nCount == 0 || start >= nCharListSize)
+    return 0;
+
+  if (nCount < 0 || start + nCount > nCharListSize)
+    nCount = nCharListSize - start;
+
+  const size_t old_size = rects->size();
+  const CPDF_TextObject* pCurObj = nullptr;
+  CFX_FloatRect line;
+  bool bHasLine = false;
+  for (int index = start; index < start + nCount; ++index) {
+    if (m_CharTypes[index] == CPDF_TextPage::CharType::kGenerated)
+      continue;
+
+    CFX_FloatRect charbox = m_CharBoxes[index];
+    if (charbox.Width() < kSizeEpsilon || charbox.Height() < kSizeEpsilon)
+      continue;
+
+    charbox.Normalize();
+    const CPDF_TextObject* pTextObj = GetCharTextObject(index);
+    if (bHasLine) {
+      // Glyphs of one text object always join, the next object joins when
+      // it overlaps the line vertically by at least half its height.
+      const float overlap = std::min(line.top, charbox.top) -
+                            std::max(line.bottom, charbox.bottom);
+      if (pTextObj == pCurObj ||
+          overlap >= std::min(line.Height(), charbox.Height()) / 2) {
+        line.Union(charbox);
+        pCurObj = pTextObj;
+        continue;
+      }
+      rects->push_back(line);
+    }
+    line = charbox;
+    pCurObj = pTextObj;
+    bHasLine = true;
+  }
+  if (bHasLine)
+    rects->push_back(line);
+  return rects->size() - old_size;
+}
+
 int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
                                  const CFX_SizeF& tolerance) const {
   int pos;
@@ -361,7 +471,7 @@ int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
   double ydif = 5000;
   const int nCount = CountChars();
   for (pos = 0; pos < nCount; ++pos) {
-    const CFX_FloatRect& orig_charrect = m_CharList[pos].m_CharBox;
+    const CFX_FloatRect& orig_charrect = m_CharBoxes[pos];
     if (orig_charrect.Contains(point))
       break;
 
@@ -391,24 +501,25 @@ int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
 }
 
 WideString CPDF_TextPage::GetTextByPredicate(
-    const std::function<bool(const CharInfo&)>& predicate) const {
+    const std::function<bool(size_t)>& predicate) const {
   float posy = 0;
   bool IsContainPreChar = false;
   bool IsAddLineFeed = false;
   WideString strText;
-  for (const auto& charinfo : m_CharList) {
-    if (predicate(charinfo)) {
-      if (fabs(posy - charinfo.m_Origin.y) > 0 && !IsContainPreChar &&
+  for (size_t i = 0; i < m_CharUnicodes.size(); ++i) {
+    const wchar_t unicode = m_CharUnicodes[i];
+    if (predicate(i)) {
+      if (fabs(posy - m_CharOrigins[i].y) > 0 && !IsContainPreChar &&
           IsAddLineFeed) {
-        posy = charinfo.m_Origin.y;
+        posy = m_CharOrigins[i].y;
         if (!strText.IsEmpty())
           strText += L"\r\n";
       }
       IsContainPreChar = true;
       IsAddLineFeed = false;
-      if (charinfo.m_Unicode)
-        strText += charinfo.m_Unicode;
-    } else if (charinfo.m_Unicode == L' ') {
+      if (unicode)
+        strText += unicode;
+    } else if (unicode == L' ') {
       if (IsContainPreChar) {
         strText += L' ';
         IsContainPreChar = false;
@@ -423,33 +534,83 @@ WideString CPDF_TextPage::GetTextByPredicate(
 }
 
 WideString CPDF_TextPage::GetTextByRect(const CFX_FloatRect& rect) const {
-  return GetTextByPredicate([&rect](const CharInfo& charinfo) {
-    return IsRectIntersect(rect, charinfo.m_CharBox);
+  return GetTextByPredicate([this, &rect](size_t index) {
+    return IsRectIntersect(rect, m_CharBoxes[index]);
   });
 }
 
 WideString CPDF_TextPage::GetTextByObject(
     const CPDF_TextObject* pTextObj) const {
-  return GetTextByPredicate([pTextObj](const CharInfo& charinfo) {
-    return charinfo.m_pTextObj == pTextObj;
+  return GetTextByPredicate([this, pTextObj](size_t index) {
+    return GetCharTextObject(index) == pTextObj;
   });
 }
 
-const CPDF_TextPage::CharInfo& CPDF_TextPage::GetCharInfo(size_t index) const {
-  CHECK(index < m_CharList.size());
-  return m_CharList[index];
+CPDF_TextPage::CharInfo CPDF_TextPage::GetCharInfo(size_t index) const {
+  CHECK(index < m_CharUnicodes.size());
+  const CharObject& object = m_CharObjects[m_CharObjectIndices[index]];
+
+  CharInfo charinfo;
+  charinfo.m_Index = m_CharTextIndices[index];
+  charinfo.m_CharCode = m_CharCodes[index];
+  charinfo.m_Unicode = m_CharUnicodes[index];
+  charinfo.m_CharType = m_CharTypes[index];
+  charinfo.m_Origin = m_CharOrigins[index];
+  charinfo.m_CharBox = m_CharBoxes[index];
+  charinfo.m_pTextObj = object.m_pTextObj;
+  charinfo.m_Matrix = object.m_Matrix;
+  return charinfo;
 }
 
 float CPDF_TextPage::GetCharFontSize(size_t index) const {
-  CHECK(index < m_CharList.size());
-  const CPDF_TextObject* text_object = m_CharList[index].m_pTextObj.Get();
+  CHECK(index < m_CharUnicodes.size());
+  const CPDF_TextObject* text_object = GetCharTextObject(index);
   bool has_font = text_object && text_object->GetFont();
   return has_font ? text_object->GetFontSize() : kDefaultFontSize;
 }
 
+CFX_FloatRect CPDF_TextPage::GetCharLooseBounds(size_t index) const {
+  const CharInfo charinfo = GetCharInfo(index);
+  float font_size = GetCharFontSize(index);
+
+  if (charinfo.m_pTextObj && !IsFloatZero(font_size)) {
+    bool is_vert_writing = charinfo.m_pTextObj->GetFont()->IsVertWriting();
+    if (is_vert_writing && charinfo.m_pTextObj->GetFont()->IsCIDFont()) {
+      CPDF_CIDFont* pCIDFont = charinfo.m_pTextObj->GetFont()->AsCIDFont();
+      uint16_t cid = pCIDFont->CIDFromCharCode(charinfo.m_CharCode);
+
+      CFX_Point16 vertical_origin = pCIDFont->GetVertOrigin(cid);
+      double offsetx = (vertical_origin.x - 500) * font_size / 1000.0;
+      double offsety = vertical_origin.y * font_size / 1000.0;
+      int16_t vert_width = pCIDFont->GetVertWidth(cid);
+      double height = vert_width * font_size / 1000.0;
+
+      float left = charinfo.m_Origin.x + offsetx;
+      float bottom = charinfo.m_Origin.y + offsety;
+      return CFX_FloatRect(left, bottom, left + font_size, bottom + height);
+    }
+
+    int ascent = charinfo.m_pTextObj->GetFont()->GetTypeAscent();
+    int descent = charinfo.m_pTextObj->GetFont()->GetTypeDescent();
+    if (ascent != descent) {
+      float width = charinfo.m_Matrix.a *
+                    charinfo.m_pTextObj->GetCharWidth(charinfo.m_CharCode);
+      float font_scale = charinfo.m_Matrix.a * font_size / (ascent - descent);
+
+      return CFX_FloatRect(
+          charinfo.m_Origin.x, charinfo.m_Origin.y + descent * font_scale,
+          charinfo.m_Origin.x + (is_vert_writing ? -width : width),
+          charinfo.m_Origin.y + ascent * font_scale);
+    }
+  }
+
+  // Fallback to the tight bounds in empty text scenarios, or bad font metrics
+  return charinfo.m_CharBox;
+}
+
 WideString CPDF_TextPage::GetPageText(int start, int count) const {
-  if (start < 0 || start >= CountChars() || count <= 0 || m_CharList.empty() ||
-      m_TextBuf.IsEmpty()) {
+  if (start < 0 || start >= CountChars() || count <= 0 ||
+      m_CharUnicodes.empty() || m_TextBuf.IsEmpty()) {
     return WideString();
   }
 
@@ -490,6 +651,34 @@ WideString CPDF_TextPage::GetPageText(int start, int count) const {
   return WideString(m_TextBuf.AsStringView().Substr(text_start, text_count));
 }
 
+const WideString& CPDF_TextPage::GetSearchText(bool bMatchCase) const {
+  if (!m_SearchText.has_value())
+    m_SearchText = GetAllPageText();
+
+  if (bMatchCase)
+    return m_SearchText.value();
+
+  if (!m_FoldedSearchText.has_value()) {
+    // Lowercasing is one char for one char, text indices stay valid.
+    WideString folded = m_SearchText.value();
+    folded.MakeLower();
+    m_FoldedSearchText = std::move(folded);
+  }
+  return m_FoldedSearchText.value();
+}
+
+int CPDF_TextPage::CharIndexFromSearchIndex(int text_index) const {
+  if (m_SearchCharIndices.empty()) {
+    for (size_t i = 0; i < m_CharIndices.size(); i += 2) {
+      for (int j = 0; j < m_CharIndices[i + 1]; ++j)
+        m_SearchCharIndices.push_back(m_CharIndices[i] + j);
+    }
+  }
+  if (!pdfium::IndexInBounds(m_SearchCharIndices, text_index))
+    return -1;
+  return m_SearchCharIndices[text_index];
+}
+
 int CPDF_TextPage::CountRects(int start, int nCount) {
   if (start < 0)
     return -1;
@@ -506,6 +695,25 @@ bool CPDF_TextPage::GetRect(int rectIndex, CFX_FloatRect* pRect) const {
   return true;
 }
 
+size_t CPDF_TextPage::GetMemoryUsage() const {
+  return sizeof(*this) + m_CharIndices.capacity() * sizeof(uint16_t) +
+         m_CharUnicodes.capacity() * sizeof(wchar_t) +
+         m_CharCodes.capacity() * sizeof(uint32_t) +
+         m_CharTextIndices.capacity() * sizeof(int32_t) +
+         m_CharTypes.capacity() * sizeof(CharType) +
+         m_CharOrigins.capacity() * sizeof(CFX_PointF) +
+         m_CharBoxes.capacity() * sizeof(CFX_FloatRect) +
+         m_CharObjectIndices.capacity() * sizeof(uint32_t) +
+         m_CharObjects.capacity() * sizeof(CharObject) +
+         m_TextBuf.GetSize() + m_SelRects.capacity() * sizeof(CFX_FloatRect) +
+         (m_SearchText.has_value() ? m_SearchText->GetLength() : 0) *
+             sizeof(wchar_t) +
+         (m_FoldedSearchText.has_value() ? m_FoldedSearchText->GetLength()
+                                         : 0) *
+             sizeof(wchar_t) +
+         m_SearchCharIndices.capacity() * sizeof(int32_t);
+}
+
 CPDF_TextPage::TextOrientation CPDF_TextPage::FindTextlineFlowOrientation()
     const {
   DCHECK_NE(m_pPage->GetPageObjectCount(), 0);
@@ -55,14 +55,25 @@ class CPDF_TextPage {
 
   int CharIndexFromTextIndex(int text_index) const;
   int TextIndexFromCharIndex(int char_index) const;
-  size_t size() const { return m_CharList.size(); }
+  size_t size() const { return m_CharUnicodes.size(); }
   int CountChars() const;
 
   // These methods CHECK() to make sure |index| is within bounds.
-  const CharInfo& GetCharInfo(size_t index) const;
+  // Characters are kept in a compact layout once the page is built, so the
+  // returned CharInfo is assembled on demand.
+  CharInfo GetCharInfo(size_t index) const;
   float GetCharFontSize(size_t index) const;
+  // Bounds from the font ascent and descent, so that characters on the same
+  // line share the same height.
+  CFX_FloatRect GetCharLooseBounds(size_t index) const;
 
   std::vector<CFX_FloatRect> GetRectArray(int start, int nCount) const;
+  // Appends the rects of the characters in [start, start + nCount) to
+  // |rects|, merged per text line, and returns the number of rects appended.
+  // Lets callers collect many ranges into one vector.
+  size_t AppendLineRects(int start,
+                         int nCount,
+                         std::vector<CFX_FloatRect>* rects) const;
   int GetIndexAtPos(const CFX_PointF& point, const CFX_SizeF& tolerance) const;
   WideString GetTextByRect(const CFX_FloatRect& rect) const;
   WideString GetTextByObject(const CPDF_TextObject* pTextObj) const;
@@ -73,9 +84,20 @@ class CPDF_TextPage {
   WideString GetPageText(int start, int count) const;
   WideString GetAllPageText() const { return GetPageText(0, CountChars()); }
 
+  // Returns the whole page text for searching, lowercased unless |bMatchCase|.
+  // Built once per page and shared by every later query, so repeated searches
+  // do not copy or fold the text again.
+  const WideString& GetSearchText(bool bMatchCase) const;
+  // Same as CharIndexFromTextIndex(), through a flat table built along with
+  // the search text.
+  int CharIndexFromSearchIndex(int text_index) const;
+
   int CountRects(int start, int nCount);
   bool GetRect(int rectIndex, CFX_FloatRect* pRect) const;
 
+  // Approximate heap memory held by the text page, in bytes.
+  size_t GetMemoryUsage() const;
+
  private:
   enum class TextOrientation {
     kUnknown,
@@ -92,6 +114,17 @@ class CPDF_TextPage {
 
   enum class MarkedContentState { kPass = 0, kDone, kDelay };
 
+  // Text object and matrix shared by consecutive characters of a text run.
+  struct CharObject {
+    CharObject();
+    CharObject(CPDF_TextObject* pTextObj, const CFX_Matrix& matrix);
+    CharObject(const CharObject& that);
+    ~CharObject();
+
+    UnownedPtr<CPDF_TextObject> m_pTextObj;
+    CFX_Matrix m_Matrix;
+  };
+
   struct TransformedTextObject {
     TransformedTextObject();
     TransformedTextObject(const TransformedTextObject& that);
@@ -102,6 +135,8 @@ class CPDF_TextPage {
   };
 
   void Init();
+  void SealCharList();
+  CPDF_TextObject* GetCharTextObject(size_t index) const;
   bool IsHyphen(wchar_t curChar) const;
   void ProcessObject();
   void ProcessFormObject(CPDF_FormObject* pFormObj,
@@ -132,12 +167,22 @@ class CPDF_TextPage {
   void AppendGeneratedCharacter(wchar_t unicode, const CFX_Matrix& formMatrix);
   void SwapTempTextBuf(int iCharListStartAppend, int iBufStartAppend);
   WideString GetTextByPredicate(
-      const std::function<bool(const CharInfo&)>& predicate) const;
+      const std::function<bool(size_t)>& predicate) const;
 
   UnownedPtr<const CPDF_Page> const m_pPage;
   std::vector<uint16_t, FxAllocAllocator<uint16_t>> m_CharIndices;
+  // Only used while the page is being built, see SealCharList().
   std::deque<CharInfo> m_CharList;
   std::deque<CharInfo> m_TempCharList;
+  // One entry per character, indexed like the char indices of the page.
+  std::vector<wchar_t> m_CharUnicodes;
+  std::vector<uint32_t> m_CharCodes;
+  std::vector<int32_t> m_CharTextIndices;
+  std::vector<CharType> m_CharTypes;
+  std::vector<CFX_PointF> m_CharOrigins;
+  std::vector<CFX_FloatRect> m_CharBoxes;
+  std::vector<uint32_t> m_CharObjectIndices;
+  std::vector<CharObject> m_CharObjects;
   CFX_WideTextBuf m_TextBuf;
   CFX_WideTextBuf m_TempTextBuf;
   UnownedPtr<CPDF_TextObject> m_pPrevTextObj;
@@ -145,6 +190,9 @@ class CPDF_TextPage {
   const bool m_rtl;
   const CFX_Matrix m_DisplayMatrix;
   std::vector<CFX_FloatRect> m_SelRects;
+  mutable Optional<WideString> m_SearchText;
+  mutable Optional<WideString> m_FoldedSearchText;
+  mutable std::vector<int32_t> m_SearchCharIndices;
   std::vector<TransformedTextObject> mTextObjects;
   TextOrientation m_TextlineDir = TextOrientation::kUnknown;
   CFX_FloatRect m_CurlineRect;
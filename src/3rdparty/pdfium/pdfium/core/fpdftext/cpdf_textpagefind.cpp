@@ -189,7 +189,7 @@ CPDF_TextPageFind::CPDF_TextPageFind(
     const Options& options,
     Optional<size_t> startPos)
     : m_pTextPage(pTextPage),
-      m_strText(GetStringCase(pTextPage->GetAllPageText(), options.bMatchCase)),
+      m_strText(pTextPage->GetSearchText(options.bMatchCase)),
       m_csFindWhatArray(findwhat_array),
       m_options(options) {
   if (!m_strText.IsEmpty()) {
@@ -201,7 +201,7 @@ CPDF_TextPageFind::CPDF_TextPageFind(
 CPDF_TextPageFind::~CPDF_TextPageFind() = default;
 
 int CPDF_TextPageFind::GetCharIndex(int index) const {
-  return m_pTextPage->CharIndexFromTextIndex(index);
+  return m_pTextPage->CharIndexFromSearchIndex(index);
 }
 
 bool CPDF_TextPageFind::FindFirst() {
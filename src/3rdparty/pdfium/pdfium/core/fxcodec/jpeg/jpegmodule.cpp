@@ -123,7 +123,8 @@ class JpegDecoder final : public ScanlineDecoder {
               int width,
               int height,
               int nComps,
-              bool ColorTransform);
+              bool ColorTransform,
+              int scale_denom);
 
   // ScanlineDecoder:
   bool v_Rewind() override;
@@ -166,6 +167,7 @@ class JpegDecoder final : public ScanlineDecoder {
   static constexpr size_t kSofMarkerByteOffset = 5;
 
   uint32_t m_nDefaultScaleDenom = 1;
+  uint32_t m_nScaleDenom = 1;
 };
 
 JpegDecoder::JpegDecoder() {
@@ -224,8 +226,8 @@ bool JpegDecoder::InitDecode(bool bAcceptKnownBadHeader) {
 
   m_OrigWidth = m_Cinfo.image_width;
   m_OrigHeight = m_Cinfo.image_height;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  m_OutputWidth = (m_OrigWidth + m_nScaleDenom - 1) / m_nScaleDenom;
+  m_OutputHeight = (m_OrigHeight + m_nScaleDenom - 1) / m_nScaleDenom;
   m_nDefaultScaleDenom = m_Cinfo.scale_denom;
   return true;
 }
@@ -234,7 +236,8 @@ bool JpegDecoder::Create(pdfium::span<const uint8_t> src_span,
                          int width,
                          int height,
                          int nComps,
-                         bool ColorTransform) {
+                         bool ColorTransform,
+                         int scale_denom) {
   m_SrcSpan = JpegScanSOI(src_span);
   if (m_SrcSpan.size() < 2)
     return false;
@@ -263,6 +266,17 @@ bool JpegDecoder::Create(pdfium::span<const uint8_t> src_span,
   if (static_cast<int>(m_Cinfo.image_width) < width)
     return false;
 
+  if (scale_denom > 1) {
+    if (setjmp(m_JmpBuf) == -1)
+      return false;
+
+    m_nScaleDenom = scale_denom;
+    m_Cinfo.scale_denom = m_nDefaultScaleDenom * m_nScaleDenom;
+    jpeg_calc_output_dimensions(&m_Cinfo);
+    m_OutputWidth = m_Cinfo.output_width;
+    m_OutputHeight = m_Cinfo.output_height;
+  }
+
   CalcPitch();
   m_pScanlineBuf.reset(FX_Alloc(uint8_t, m_Pitch));
   m_nComps = m_Cinfo.num_components;
@@ -281,14 +295,14 @@ bool JpegDecoder::v_Rewind() {
   if (setjmp(m_JmpBuf) == -1) {
     return false;
   }
-  m_Cinfo.scale_denom = m_nDefaultScaleDenom;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  m_Cinfo.scale_denom = m_nDefaultScaleDenom * m_nScaleDenom;
   if (!jpeg_start_decompress(&m_Cinfo)) {
     jpeg_destroy_decompress(&m_Cinfo);
     return false;
   }
-  if (static_cast<int>(m_Cinfo.output_width) > m_OrigWidth) {
+  if (static_cast<int>(m_Cinfo.output_width) > m_OrigWidth ||
+      static_cast<int>(m_Cinfo.output_width) != m_OutputWidth ||
+      static_cast<int>(m_Cinfo.output_height) != m_OutputHeight) {
     NOTREACHED();
     return false;
   }
@@ -382,12 +396,17 @@ std::unique_ptr<ScanlineDecoder> JpegModule::CreateDecoder(
     int width,
     int height,
     int nComps,
-    bool ColorTransform) {
+    bool ColorTransform,
+    int scale_denom) {
   ASSERT(!src_span.empty());
+  ASSERT(scale_denom == 1 || scale_denom == 2 || scale_denom == 4 ||
+         scale_denom == 8);
 
   auto pDecoder = std::make_unique<JpegDecoder>();
-  if (!pDecoder->Create(src_span, width, height, nComps, ColorTransform))
+  if (!pDecoder->Create(src_span, width, height, nComps, ColorTransform,
+                        scale_denom)) {
     return nullptr;
+  }
 
   return std::move(pDecoder);
 }
@@ -33,12 +33,16 @@ class JpegModule {
     bool color_transform;
   };
 
+  // |scale_denom| is 1, 2, 4 or 8. Values above 1 make libjpeg scale the
+  // image down in the IDCT, so the decoder's width and height are the
+  // original ones divided by |scale_denom|, rounded up.
   static std::unique_ptr<ScanlineDecoder> CreateDecoder(
       pdfium::span<const uint8_t> src_span,
       int width,
       int height,
       int nComps,
-      bool ColorTransform);
+      bool ColorTransform,
+      int scale_denom);
 
   static Optional<JpegImageInfo> LoadInfo(pdfium::span<const uint8_t> src_span);
 
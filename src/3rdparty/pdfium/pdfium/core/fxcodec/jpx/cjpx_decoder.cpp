@@ -387,9 +387,11 @@ void color_sycc_to_rgb(opj_image_t* img) {
 // static
 std::unique_ptr<CJPX_Decoder> CJPX_Decoder::Create(
     pdfium::span<const uint8_t> src_span,
-    CJPX_Decoder::ColorSpaceOption option) {
+    CJPX_Decoder::ColorSpaceOption option,
+    uint8_t resolution_levels_to_skip) {
   // Private ctor.
-  auto decoder = pdfium::WrapUnique(new CJPX_Decoder(option));
+  auto decoder = pdfium::WrapUnique(
+      new CJPX_Decoder(option, resolution_levels_to_skip));
   if (!decoder->Init(src_span))
     return nullptr;
   return decoder;
@@ -400,8 +402,10 @@ void CJPX_Decoder::Sycc420ToRgbForTesting(opj_image_t* img) {
   sycc420_to_rgb(img);
 }
 
-CJPX_Decoder::CJPX_Decoder(ColorSpaceOption option)
-    : m_ColorSpaceOption(option) {}
+CJPX_Decoder::CJPX_Decoder(ColorSpaceOption option,
+                           uint8_t resolution_levels_to_skip)
+    : m_ColorSpaceOption(option),
+      m_ResolutionLevelsToSkip(resolution_levels_to_skip) {}
 
 CJPX_Decoder::~CJPX_Decoder() {
   if (m_Codec)
@@ -428,6 +432,7 @@ bool CJPX_Decoder::Init(pdfium::span<const uint8_t> src_data) {
   opj_set_default_decoder_parameters(&m_Parameters);
   m_Parameters.decod_format = 0;
   m_Parameters.cod_format = 3;
+  m_Parameters.cp_reduce = m_ResolutionLevelsToSkip;
   if (memcmp(m_SrcData.data(), szJP2Header, sizeof(szJP2Header)) == 0) {
     m_Codec = opj_create_decompress(OPJ_CODEC_JP2);
     m_Parameters.decod_format = 1;
@@ -499,12 +504,23 @@ bool CJPX_Decoder::StartDecode() {
 }
 
 CJPX_Decoder::JpxImageInfo CJPX_Decoder::GetInfo() const {
-  return {m_Image->x1, m_Image->y1, m_Image->numcomps, m_Image->color_space};
+  return {ReducedDimension(m_Image->x1), ReducedDimension(m_Image->y1),
+          m_Image->numcomps, m_Image->color_space};
+}
+
+uint32_t CJPX_Decoder::ReducedDimension(uint32_t value) const {
+  // OpenJPEG keeps the image area in full resolution coordinates and rounds
+  // reduced component sizes up.
+  uint64_t reduced = value;
+  reduced += (uint64_t{1} << m_ResolutionLevelsToSkip) - 1;
+  return static_cast<uint32_t>(reduced >> m_ResolutionLevelsToSkip);
 }
 
 bool CJPX_Decoder::Decode(uint8_t* dest_buf, uint32_t pitch, bool swap_rgb) {
-  if (m_Image->comps[0].w != m_Image->x1 || m_Image->comps[0].h != m_Image->y1)
+  if (m_Image->comps[0].w != ReducedDimension(m_Image->x1) ||
+      m_Image->comps[0].h != ReducedDimension(m_Image->y1)) {
     return false;
+  }
 
   if (pitch<(m_Image->comps[0].w * 8 * m_Image->numcomps + 31)>> 5 << 2)
     return false;
@@ -512,7 +528,7 @@ bool CJPX_Decoder::Decode(uint8_t* dest_buf, uint32_t pitch, bool swap_rgb) {
   if (swap_rgb && m_Image->numcomps < 3)
     return false;
 
-  memset(dest_buf, 0xff, m_Image->y1 * pitch);
+  memset(dest_buf, 0xff, m_Image->comps[0].h * pitch);
   std::vector<uint8_t*> channel_bufs(m_Image->numcomps);
   std::vector<int> adjust_comps(m_Image->numcomps);
   for (uint32_t i = 0; i < m_Image->numcomps; i++) {
@@ -37,14 +37,20 @@ class CJPX_Decoder {
     COLOR_SPACE colorspace;
   };
 
+  // |resolution_levels_to_skip| drops that many of the highest wavelet
+  // resolution levels, halving the decoded width and height for each one.
+  // Fails when the codestream does not have that many levels.
   static std::unique_ptr<CJPX_Decoder> Create(
       pdfium::span<const uint8_t> src_span,
-      CJPX_Decoder::ColorSpaceOption option);
+      CJPX_Decoder::ColorSpaceOption option,
+      uint8_t resolution_levels_to_skip);
 
   static void Sycc420ToRgbForTesting(opj_image_t* img);
 
   ~CJPX_Decoder();
 
+  // The width and height are those of the decoded image, after skipping
+  // resolution levels.
   JpxImageInfo GetInfo() const;
   bool StartDecode();
 
@@ -53,11 +59,15 @@ class CJPX_Decoder {
 
  private:
   // Use Create() to instantiate.
-  explicit CJPX_Decoder(ColorSpaceOption option);
+  CJPX_Decoder(ColorSpaceOption option, uint8_t resolution_levels_to_skip);
 
   bool Init(pdfium::span<const uint8_t> src_data);
 
+  // Size of a full resolution image dimension after skipping levels.
+  uint32_t ReducedDimension(uint32_t value) const;
+
   const ColorSpaceOption m_ColorSpaceOption;
+  const uint8_t m_ResolutionLevelsToSkip;
   pdfium::span<const uint8_t> m_SrcData;
   UnownedPtr<opj_image_t> m_Image;
   UnownedPtr<opj_codec_t> m_Codec;
@@ -0,0 +1,111 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcrt/cfx_memorymappedfile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "core/fxcrt/fx_safe_types.h"
+
+#ifndef O_LARGEFILE
+#define O_LARGEFILE 0
+#endif  // O_LARGEFILE
+
+namespace {
+
+// The header and linearization dictionary live in the first bytes, the last
+// xref section and trailer are searched for backwards from the end.
+constexpr size_t kHeadWindow = 64 * 1024;
+constexpr size_t kTailWindow = 1024 * 1024;
+
+// Reads at least this large ask the kernel for the whole range up front, the
+// mapping itself is advised as random access and faults in single pages.
+constexpr size_t kWillNeedThreshold = 64 * 1024;
+
+void AdviseWillNeed(const uint8_t* base, size_t offset, size_t size) {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  size_t begin = offset - offset % page_size;
+  madvise(const_cast<uint8_t*>(base) + begin, offset + size - begin,
+          MADV_WILLNEED);
+}
+
+}  // namespace
+
+// static
+RetainPtr<CFX_MemoryMappedFile> CFX_MemoryMappedFile::Create(
+    const char* filename) {
+  if (!filename || !*filename)
+    return nullptr;
+
+  int fd = open(filename, O_RDONLY | O_LARGEFILE);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0 ||
+      !pdfium::base::IsValueInRangeForNumericType<size_t>(st.st_size)) {
+    close(fd);
+    return nullptr;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  // The mapping keeps its own reference to the file.
+  close(fd);
+
+  if (data == MAP_FAILED)
+    return nullptr;
+
+  // Opening only touches the header, the trailer and the xref; objects are
+  // then read where the xref points. Reading ahead over the whole mapping
+  // would pull a large file in from disk on every cold open.
+  madvise(data, size, MADV_RANDOM);
+  const uint8_t* base = static_cast<const uint8_t*>(data);
+  AdviseWillNeed(base, 0, std::min(size, kHeadWindow));
+  if (size > kHeadWindow) {
+    size_t tail = std::min(size - kHeadWindow, kTailWindow);
+    AdviseWillNeed(base, size - tail, tail);
+  }
+
+  return pdfium::MakeRetain<CFX_MemoryMappedFile>(
+      pdfium::make_span(static_cast<const uint8_t*>(data), size));
+}
+
+CFX_MemoryMappedFile::CFX_MemoryMappedFile(pdfium::span<const uint8_t> span)
+    : m_span(span) {}
+
+CFX_MemoryMappedFile::~CFX_MemoryMappedFile() {
+  munmap(const_cast<uint8_t*>(m_span.data()), m_span.size());
+}
+
+FX_FILESIZE CFX_MemoryMappedFile::GetSize() {
+  return pdfium::base::checked_cast<FX_FILESIZE>(m_span.size());
+}
+
+bool CFX_MemoryMappedFile::ReadBlockAtOffset(void* buffer,
+                                             FX_FILESIZE offset,
+                                             size_t size) {
+  if (!buffer || offset < 0 || size == 0)
+    return false;
+
+  FX_SAFE_SIZE_T pos = size;
+  pos += offset;
+  if (!pos.IsValid() || pos.ValueOrDie() > m_span.size())
+    return false;
+
+  if (size >= kWillNeedThreshold)
+    AdviseWillNeed(m_span.data(), static_cast<size_t>(offset), size);
+
+  auto copy_span = m_span.subspan(offset, size);
+  memcpy(buffer, copy_span.data(), copy_span.size());
+  return true;
+}
@@ -0,0 +1,37 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCRT_CFX_MEMORYMAPPEDFILE_H_
+#define CORE_FXCRT_CFX_MEMORYMAPPEDFILE_H_
+
+#include "core/fxcrt/fx_stream.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "third_party/base/span.h"
+
+// Read-only stream over a file mapped into memory. Reads are served by
+// copying out of the mapping, so there is no lseek()/read() pair per parser
+// buffer refill, and mappings of the same file share the kernel page cache.
+// The file must not be truncated while mapped, or reads will fault.
+class CFX_MemoryMappedFile final : public IFX_SeekableReadStream {
+ public:
+  CONSTRUCT_VIA_MAKE_RETAIN;
+
+  // Returns nullptr if the file can not be opened or mapped, callers are
+  // expected to fall back to IFX_SeekableReadStream::CreateFromFilename().
+  static RetainPtr<CFX_MemoryMappedFile> Create(const char* filename);
+
+  // IFX_SeekableReadStream:
+  FX_FILESIZE GetSize() override;
+  bool ReadBlockAtOffset(void* buffer,
+                         FX_FILESIZE offset,
+                         size_t size) override;
+
+ private:
+  explicit CFX_MemoryMappedFile(pdfium::span<const uint8_t> span);
+  ~CFX_MemoryMappedFile() override;
+
+  const pdfium::span<const uint8_t> m_span;
+};
+
+#endif  // CORE_FXCRT_CFX_MEMORYMAPPEDFILE_H_
@@ -15,7 +15,7 @@
 namespace {
 
 #if !defined(OS_WIN)
-uint32_t g_last_error = 0;
+thread_local uint32_t g_last_error = 0;
 #endif
 
 template <typename IntType, typename CharType>
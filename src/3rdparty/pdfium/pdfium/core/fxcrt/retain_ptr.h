@@ -5,6 +5,7 @@
 #ifndef CORE_FXCRT_RETAIN_PTR_H_
 #define CORE_FXCRT_RETAIN_PTR_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <utility>
@@ -105,12 +106,17 @@ class RetainPtr {
   std::unique_ptr<T, ReleaseDeleter<T>> m_pObj;
 };
 
-// Trivial implementation - internal ref count with virtual destructor.
+template <typename T>
+RetainPtr<T> RetainIfAlive(T* pObj);
+
+// Trivial implementation - internal ref count with virtual destructor. The
+// count is atomic since fonts, faces and stock colorspaces are shared between
+// documents that may be used on different threads.
 class Retainable {
  public:
   Retainable() = default;
 
-  bool HasOneRef() const { return m_nRefCount == 1; }
+  bool HasOneRef() const { return m_nRefCount.load() == 1; }
 
  protected:
   virtual ~Retainable() = default;
@@ -122,19 +128,48 @@ class Retainable {
   template <typename U>
   friend class RetainPtr;
 
+  template <typename U>
+  friend RetainPtr<U> RetainIfAlive(U* pObj);
+
   Retainable(const Retainable& that) = delete;
   Retainable& operator=(const Retainable& that) = delete;
 
-  void Retain() const { ++m_nRefCount; }
+  void Retain() const { m_nRefCount.fetch_add(1, std::memory_order_relaxed); }
   void Release() const {
-    ASSERT(m_nRefCount > 0);
-    if (--m_nRefCount == 0)
+    ASSERT(m_nRefCount.load() > 0);
+    if (m_nRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
       delete this;
   }
 
-  mutable intptr_t m_nRefCount = 0;
+  // Takes a reference unless the count already dropped to zero, i.e. the
+  // object is being destroyed.
+  bool TryRetain() const {
+    intptr_t count = m_nRefCount.load(std::memory_order_relaxed);
+    while (count > 0) {
+      if (m_nRefCount.compare_exchange_weak(count, count + 1,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  mutable std::atomic<intptr_t> m_nRefCount{0};
 };
 
+// Returns a RetainPtr to |pObj|, or null if its last reference was released
+// on another thread and it is waiting to be destroyed. For caches that only
+// observe shared objects: their ObservedPtr is cleared by the destructor,
+// after the count is already zero. Call with the lock the destructor takes.
+template <typename T>
+RetainPtr<T> RetainIfAlive(T* pObj) {
+  RetainPtr<T> result;
+  if (pObj && pObj->TryRetain())
+    result.Unleak(pObj);
+  return result;
+}
+
 template <typename T, typename U>
 inline bool operator==(const U* lhs, const RetainPtr<T>& rhs) {
   return rhs == lhs;
@@ -149,6 +184,7 @@ inline bool operator!=(const U* lhs, const RetainPtr<T>& rhs) {
 
 using fxcrt::ReleaseDeleter;
 using fxcrt::Retainable;
+using fxcrt::RetainIfAlive;
 using fxcrt::RetainPtr;
 
 namespace pdfium {
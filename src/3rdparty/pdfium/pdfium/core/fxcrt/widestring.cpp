@@ -39,18 +39,15 @@ const wchar_t* FX_wcsstr(const wchar_t* haystack,
   if (needle_len > haystack_len || needle_len == 0) {
     return nullptr;
   }
+  // wmemchr() is vectorized by the C library, so jump between occurrences of
+  // the first character and compare the rest only there.
   const wchar_t* end_ptr = haystack + haystack_len - needle_len;
   while (haystack <= end_ptr) {
-    int i = 0;
-    while (1) {
-      if (haystack[i] != needle[i]) {
-        break;
-      }
-      i++;
-      if (i == needle_len) {
-        return haystack;
-      }
-    }
+    haystack = wmemchr(haystack, needle[0], end_ptr - haystack + 1);
+    if (!haystack)
+      return nullptr;
+    if (wmemcmp(haystack + 1, needle + 1, needle_len - 1) == 0)
+      return haystack;
     haystack++;
   }
   return nullptr;
@@ -4,6 +4,8 @@
 
 #include "core/fxge/cfx_face.h"
 
+#include "core/fxge/cfx_fontlock.h"
+
 // static
 RetainPtr<CFX_Face> CFX_Face::New(FT_Library library,
                                   const RetainPtr<Retainable>& pDesc,
@@ -33,4 +35,11 @@ CFX_Face::CFX_Face(FXFT_FaceRec* rec, const RetainPtr<Retainable>& pDesc)
   ASSERT(m_pRec);
 }
 
-CFX_Face::~CFX_Face() = default;
+CFX_Face::~CFX_Face() {
+  // Faces are shared through the font manager caches, so the observers and
+  // the FreeType library must only be touched under the font lock.
+  CFX_FontLock lock;
+  NotifyObservers();
+  m_pRec.reset();
+  m_pDesc.Reset();
+}
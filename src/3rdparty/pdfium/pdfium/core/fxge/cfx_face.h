@@ -28,8 +28,8 @@ class CFX_Face : public Retainable, public Observable {
  private:
   CFX_Face(FXFT_FaceRec* pRec, const RetainPtr<Retainable>& pDesc);
 
-  ScopedFXFTFaceRec const m_pRec;
-  RetainPtr<Retainable> const m_pDesc;
+  ScopedFXFTFaceRec m_pRec;
+  RetainPtr<Retainable> m_pDesc;
 };
 
 #endif  // CORE_FXGE_CFX_FACE_H_
@@ -16,6 +16,7 @@
 #include "core/fxcrt/fx_codepage.h"
 #include "core/fxcrt/fx_stream.h"
 #include "core/fxge/cfx_fontcache.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/cfx_glyphcache.h"
@@ -358,6 +359,9 @@ void CFX_Font::LoadSubst(const ByteString& face_name,
 }
 
 int CFX_Font::GetGlyphWidth(uint32_t glyph_index) {
+  // |m_Face| may be shared with other documents through CFX_FontMgr, and
+  // loading a glyph changes the face's glyph slot.
+  CFX_FontLock lock;
   if (!m_Face)
     return 0;
   if (m_pSubstFont && m_pSubstFont->m_bFlagMM)
@@ -415,6 +419,7 @@ int CFX_Font::GetDescent() const {
 }
 
 bool CFX_Font::GetGlyphBBox(uint32_t glyph_index, FX_RECT* pBBox) {
+  CFX_FontLock lock;
   if (!m_Face)
     return false;
 
@@ -561,6 +566,7 @@ ByteString CFX_Font::GetBaseFontName(bool restrict_to_psname) const {
 }
 
 bool CFX_Font::GetBBox(FX_RECT* pBBox) {
+  CFX_FontLock lock;
   if (!m_Face)
     return false;
 
@@ -709,6 +715,7 @@ const CFX_GlyphBitmap* CFX_Font::LoadGlyphBitmap(
 
 const CFX_PathData* CFX_Font::LoadGlyphPath(uint32_t glyph_index,
                                             int dest_width) const {
+  CFX_FontLock lock;
   return GetOrCreateGlyphCache()->LoadGlyphPath(this, glyph_index, dest_width);
 }
 
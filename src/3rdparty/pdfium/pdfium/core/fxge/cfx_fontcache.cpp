@@ -7,6 +7,7 @@
 #include "core/fxge/cfx_fontcache.h"
 
 #include "core/fxge/cfx_font.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_glyphcache.h"
 #include "core/fxge/fx_font.h"
 #include "core/fxge/fx_freetype.h"
@@ -16,12 +17,15 @@ CFX_FontCache::CFX_FontCache() = default;
 CFX_FontCache::~CFX_FontCache() = default;
 
 RetainPtr<CFX_GlyphCache> CFX_FontCache::GetGlyphCache(const CFX_Font* pFont) {
+  CFX_FontLock lock;
   RetainPtr<CFX_Face> face = pFont->GetFace();
   const bool bExternal = !face;
   auto& map = bExternal ? m_ExtGlyphCacheMap : m_GlyphCacheMap;
   auto it = map.find(face.Get());
-  if (it != map.end() && it->second)
-    return pdfium::WrapRetain(it->second.Get());
+  RetainPtr<CFX_GlyphCache> cache =
+      it != map.end() ? RetainIfAlive(it->second.Get()) : nullptr;
+  if (cache)
+    return cache;
 
   auto new_cache = pdfium::MakeRetain<CFX_GlyphCache>(face);
   map[face.Get()].Reset(new_cache.Get());
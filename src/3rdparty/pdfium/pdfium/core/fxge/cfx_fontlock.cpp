@@ -0,0 +1,18 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_fontlock.h"
+
+namespace {
+
+std::recursive_mutex& GetFontMutex() {
+  static std::recursive_mutex s_font_mutex;
+  return s_font_mutex;
+}
+
+}  // namespace
+
+CFX_FontLock::CFX_FontLock() : m_Lock(GetFontMutex()) {}
+
+CFX_FontLock::~CFX_FontLock() = default;
@@ -0,0 +1,29 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXGE_CFX_FONTLOCK_H_
+#define CORE_FXGE_CFX_FONTLOCK_H_
+
+#include <mutex>
+
+// Serializes access to the font state that is shared between documents: the
+// FreeType library and the faces cached by CFX_FontMgr/CFX_FontMapper, the
+// glyph caches in CFX_FontCache and CPDF_FontGlobals. Everything else hangs
+// off a CPDF_Document, so embedders only need a per-document lock as long as
+// every path that touches the shared font state holds this one. The lock is
+// recursive because font loading re-enters itself (e.g. Type3 glyphs and
+// fallback fonts).
+class CFX_FontLock {
+ public:
+  CFX_FontLock();
+  ~CFX_FontLock();
+
+  CFX_FontLock(const CFX_FontLock&) = delete;
+  CFX_FontLock& operator=(const CFX_FontLock&) = delete;
+
+ private:
+  std::unique_lock<std::recursive_mutex> m_Lock;
+};
+
+#endif  // CORE_FXGE_CFX_FONTLOCK_H_
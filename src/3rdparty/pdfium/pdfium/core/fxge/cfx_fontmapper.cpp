@@ -739,7 +739,7 @@ RetainPtr<CFX_Face> CFX_FontMapper::GetCachedTTCFace(void* hFont,
   uint32_t font_offset = ttc_size - font_size;
   int face_index =
       GetTTCIndex(pFontDesc->FontData().first(ttc_size), font_offset);
-  RetainPtr<CFX_Face> pFace(pFontDesc->GetFace(face_index));
+  RetainPtr<CFX_Face> pFace = pFontDesc->GetFace(face_index);
   if (pFace)
     return pFace;
 
@@ -766,7 +766,7 @@ RetainPtr<CFX_Face> CFX_FontMapper::GetCachedFace(void* hFont,
     pFontDesc = m_pFontMgr->AddCachedFontDesc(SubstName, weight, bItalic,
                                               std::move(pFontData), font_size);
   }
-  RetainPtr<CFX_Face> pFace(pFontDesc->GetFace(0));
+  RetainPtr<CFX_Face> pFace = pFontDesc->GetFace(0);
   if (pFace)
     return pFace;
 
@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "core/fxge/cfx_face.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/cfx_substfont.h"
 #include "core/fxge/fontdata/chromefontdata/chromefontdata.h"
@@ -72,16 +73,21 @@ CFX_FontMgr::FontDesc::FontDesc(std::unique_ptr<uint8_t, FxFreeDeleter> pData,
                                 size_t size)
     : m_Size(size), m_pFontData(std::move(pData)) {}
 
-CFX_FontMgr::FontDesc::~FontDesc() = default;
+CFX_FontMgr::FontDesc::~FontDesc() {
+  CFX_FontLock lock;
+  NotifyObservers();
+}
 
 void CFX_FontMgr::FontDesc::SetFace(size_t index, CFX_Face* face) {
+  CFX_FontLock lock;
   ASSERT(index < pdfium::size(m_TTCFaces));
   m_TTCFaces[index].Reset(face);
 }
 
-CFX_Face* CFX_FontMgr::FontDesc::GetFace(size_t index) const {
+RetainPtr<CFX_Face> CFX_FontMgr::FontDesc::GetFace(size_t index) const {
+  CFX_FontLock lock;
   ASSERT(index < pdfium::size(m_TTCFaces));
-  return m_TTCFaces[index].Get();
+  return RetainIfAlive(m_TTCFaces[index].Get());
 }
 
 CFX_FontMgr::CFX_FontMgr()
@@ -112,8 +118,9 @@ RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::GetCachedFontDesc(
     const ByteString& face_name,
     int weight,
     bool bItalic) {
+  CFX_FontLock lock;
   auto it = m_FaceMap.find(KeyNameFromFace(face_name, weight, bItalic));
-  return it != m_FaceMap.end() ? pdfium::WrapRetain(it->second.Get()) : nullptr;
+  return it != m_FaceMap.end() ? RetainIfAlive(it->second.Get()) : nullptr;
 }
 
 RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::AddCachedFontDesc(
@@ -122,6 +129,7 @@ RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::AddCachedFontDesc(
     bool bItalic,
     std::unique_ptr<uint8_t, FxFreeDeleter> pData,
     uint32_t size) {
+  CFX_FontLock lock;
   auto pFontDesc = pdfium::MakeRetain<FontDesc>(std::move(pData), size);
   m_FaceMap[KeyNameFromFace(face_name, weight, bItalic)].Reset(pFontDesc.Get());
   return pFontDesc;
@@ -130,8 +138,9 @@ RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::AddCachedFontDesc(
 RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::GetCachedTTCFontDesc(
     int ttc_size,
     uint32_t checksum) {
+  CFX_FontLock lock;
   auto it = m_FaceMap.find(KeyNameFromSize(ttc_size, checksum));
-  return it != m_FaceMap.end() ? pdfium::WrapRetain(it->second.Get()) : nullptr;
+  return it != m_FaceMap.end() ? RetainIfAlive(it->second.Get()) : nullptr;
 }
 
 RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::AddCachedTTCFontDesc(
@@ -139,6 +148,7 @@ RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::AddCachedTTCFontDesc(
     uint32_t checksum,
     std::unique_ptr<uint8_t, FxFreeDeleter> pData,
     uint32_t size) {
+  CFX_FontLock lock;
   auto pNewDesc = pdfium::MakeRetain<FontDesc>(std::move(pData), size);
   m_FaceMap[KeyNameFromSize(ttc_size, checksum)].Reset(pNewDesc.Get());
   return pNewDesc;
@@ -34,7 +34,7 @@ class CFX_FontMgr {
       return {m_pFontData.get(), m_Size};
     }
     void SetFace(size_t index, CFX_Face* face);
-    CFX_Face* GetFace(size_t index) const;
+    RetainPtr<CFX_Face> GetFace(size_t index) const;
 
    private:
     FontDesc(std::unique_ptr<uint8_t, FxFreeDeleter> pData, size_t size);
@@ -14,6 +14,7 @@
 #include "build/build_config.h"
 #include "core/fxcrt/fx_codepage.h"
 #include "core/fxge/cfx_font.h"
+#include "core/fxge/cfx_fontlock.h"
 #include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/cfx_glyphbitmap.h"
@@ -100,7 +101,10 @@ void GenKey(UniqueKeyGen* pKeyGen,
 
 CFX_GlyphCache::CFX_GlyphCache(RetainPtr<CFX_Face> face) : m_Face(face) {}
 
-CFX_GlyphCache::~CFX_GlyphCache() = default;
+CFX_GlyphCache::~CFX_GlyphCache() {
+  CFX_FontLock lock;
+  NotifyObservers();
+}
 
 std::unique_ptr<CFX_GlyphBitmap> CFX_GlyphCache::RenderGlyph(
     const CFX_Font* pFont,
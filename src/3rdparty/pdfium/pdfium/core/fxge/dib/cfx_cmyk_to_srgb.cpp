@@ -11,6 +11,10 @@
 
 #include "core/fxcrt/fx_system.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace fxge {
 
 namespace {
@@ -1659,6 +1663,84 @@ constexpr uint8_t kCMYK[81 * 81][3] = {
     {0, 0, 0},
 };
 
+// One input channel's contribution to the interpolation in AdobeCMYK_to_sRGB1.
+struct AxisStep {
+    // Offset of the nearest grid point, in kCMYK entries.
+    int offset;
+    // Offset from there to the neighbouring grid point used for the slope.
+    int neighbor;
+    // Interpolation weight towards the neighbour, scaled like |c_rate|.
+    int rate;
+};
+
+// Everything AdobeCMYK_to_sRGB1 derives from a single channel value, for all
+// 256 values of each channel, so that a scanline only does table lookups and
+// the weighted sums.
+struct AdobeCMYKTables {
+    AdobeCMYKTables()
+    {
+        static const int kStrides[4] = {9 * 9 * 9, 9 * 9, 9, 1};
+        for (int axis = 0; axis < 4; ++axis) {
+            for (int value = 0; value < 256; ++value) {
+                const int fix = value << 8;
+                const int index = (fix + 4096) >> 13;
+                int index1 = fix >> 13;
+                if (index1 == index)
+                    index1 = index1 == 8 ? index1 - 1 : index1 + 1;
+                AxisStep &step = steps[axis][value];
+                step.offset = index * kStrides[axis];
+                step.neighbor = (index1 - index) * kStrides[axis];
+                step.rate = (fix - (index << 13)) * (index - index1);
+            }
+        }
+#if defined(__SSE2__)
+        for (int i = 0; i < 81 * 81; ++i) {
+            colors[i][0] = kCMYK[i][0];
+            colors[i][1] = kCMYK[i][1];
+            colors[i][2] = kCMYK[i][2];
+            colors[i][3] = 0;
+        }
+#endif
+    }
+
+    AxisStep steps[4][256];
+#if defined(__SSE2__)
+    // kCMYK padded to 4 bytes per entry for 32-bit loads.
+    uint8_t colors[81 * 81][4];
+#endif
+};
+
+const AdobeCMYKTables &GetAdobeCMYKTables()
+{
+    static const AdobeCMYKTables tables;
+    return tables;
+}
+
+#if defined(__SSE2__)
+// Widens the padded RGB entry at |pos| to one 32-bit lane per channel.
+inline __m128i LoadColor_SSE2(const AdobeCMYKTables &tables, int pos)
+{
+    int32_t value;
+    memcpy(&value, tables.colors[pos], sizeof(value));
+    const __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+}
+
+// (base - neighbour) * rate / 32 for each channel, rounding toward zero like
+// the scalar division. |base| lanes are within [0, 255] and |rate| within
+// [-4096, 4096], so a 16-bit multiply-add is exact.
+inline __m128i AxisTerm_SSE2(const AdobeCMYKTables &tables,
+                             __m128i base,
+                             int pos,
+                             const AxisStep &step)
+{
+    __m128i delta = _mm_sub_epi32(base, LoadColor_SSE2(tables, pos + step.neighbor));
+    __m128i product = _mm_madd_epi16(delta, _mm_set1_epi32(step.rate & 0xffff));
+    __m128i bias = _mm_and_si128(_mm_srai_epi32(product, 31), _mm_set1_epi32(31));
+    return _mm_srai_epi32(_mm_add_epi32(product, bias), 5);
+}
+#endif
+
 }  // namespace
 
 std::tuple<uint8_t, uint8_t, uint8_t> AdobeCMYK_to_sRGB1(uint8_t c,
@@ -1757,4 +1839,56 @@ std::tuple<float, float, float> AdobeCMYK_to_sRGB(float c,
     return std::make_tuple(r * (1.0f / 255), g * (1.0f / 255), b * (1.0f / 255));
 }
 
+void AdobeCMYK_to_sRGB1_Scanline(uint8_t *dest_bgr,
+                                 const uint8_t *src_cmyk,
+                                 int pixels,
+                                 int dest_Bpp)
+{
+    const AdobeCMYKTables &tables = GetAdobeCMYKTables();
+    uint32_t last_cmyk = 0;
+    uint8_t last_bgr[3] = {0, 0, 0};
+    for (int i = 0; i < pixels; ++i, src_cmyk += 4, dest_bgr += dest_Bpp) {
+        //平涂区域相邻像素多为同一颜色
+        uint32_t cmyk;
+        memcpy(&cmyk, src_cmyk, sizeof(cmyk));
+        if (i > 0 && cmyk == last_cmyk) {
+            memcpy(dest_bgr, last_bgr, 3);
+            continue;
+        }
+
+        const AxisStep &c = tables.steps[0][src_cmyk[0]];
+        const AxisStep &m = tables.steps[1][src_cmyk[1]];
+        const AxisStep &y = tables.steps[2][src_cmyk[2]];
+        const AxisStep &k = tables.steps[3][src_cmyk[3]];
+        const int pos = c.offset + m.offset + y.offset + k.offset;
+#if defined(__SSE2__)
+        const __m128i base = LoadColor_SSE2(tables, pos);
+        __m128i fix = _mm_slli_epi32(base, 8);
+        fix = _mm_add_epi32(fix, AxisTerm_SSE2(tables, base, pos, c));
+        fix = _mm_add_epi32(fix, AxisTerm_SSE2(tables, base, pos, m));
+        fix = _mm_add_epi32(fix, AxisTerm_SSE2(tables, base, pos, y));
+        fix = _mm_add_epi32(fix, AxisTerm_SSE2(tables, base, pos, k));
+        fix = _mm_andnot_si128(_mm_srai_epi32(fix, 31), fix);
+        fix = _mm_srli_epi32(fix, 8);
+        int rgb[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb), fix);
+        last_bgr[0] = static_cast<uint8_t>(rgb[2]);
+        last_bgr[1] = static_cast<uint8_t>(rgb[1]);
+        last_bgr[2] = static_cast<uint8_t>(rgb[0]);
+#else
+        const AxisStep *axes[4] = {&c, &m, &y, &k};
+        for (int color = 0; color < 3; ++color) {
+            int fix = kCMYK[pos][color] << 8;
+            for (const AxisStep *axis : axes) {
+                const int delta = kCMYK[pos][color] - kCMYK[pos + axis->neighbor][color];
+                fix += delta * axis->rate / 32;
+            }
+            last_bgr[2 - color] = static_cast<uint8_t>(std::max(fix, 0) >> 8);
+        }
+#endif
+        last_cmyk = cmyk;
+        memcpy(dest_bgr, last_bgr, 3);
+    }
+}
+
 }  // namespace fxge
@@ -22,9 +22,18 @@ std::tuple<uint8_t, uint8_t, uint8_t> AdobeCMYK_to_sRGB1(uint8_t c,
                                                          uint8_t y,
                                                          uint8_t k);
 
+// Converts |pixels| CMYK pixels to BGR with the same results as
+// AdobeCMYK_to_sRGB1(). Each BGR pixel takes |dest_Bpp| bytes; any bytes
+// after the first 3 are left untouched.
+void AdobeCMYK_to_sRGB1_Scanline(uint8_t* dest_bgr,
+                                 const uint8_t* src_cmyk,
+                                 int pixels,
+                                 int dest_Bpp);
+
 }  // namespace fxge
 
 using fxge::AdobeCMYK_to_sRGB;
 using fxge::AdobeCMYK_to_sRGB1;
+using fxge::AdobeCMYK_to_sRGB1_Scanline;
 
 #endif  // CORE_FXGE_DIB_CFX_CMYK_TO_SRGB_H_
@@ -563,12 +563,7 @@ void ConvertBuffer_32bppCmyk2Rgb32(uint8_t* dest_buf,
     uint8_t* dest_scan = dest_buf + row * dest_pitch;
     const uint8_t* src_scan =
         pSrcBitmap->GetScanline(src_top + row) + src_left * 4;
-    for (int col = 0; col < width; ++col) {
-      std::tie(dest_scan[2], dest_scan[1], dest_scan[0]) = AdobeCMYK_to_sRGB1(
-          src_scan[0], src_scan[1], src_scan[2], src_scan[3]);
-      dest_scan += 4;
-      src_scan += 4;
-    }
+    AdobeCMYK_to_sRGB1_Scanline(dest_scan, src_scan, width, 4);
   }
 }
 
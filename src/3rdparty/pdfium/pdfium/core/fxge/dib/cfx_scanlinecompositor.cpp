@@ -9,6 +9,7 @@
 #include <algorithm>
 
 #include "core/fxge/dib/cfx_cmyk_to_srgb.h"
+#include "core/fxge/dib/fx_dib_sse2.h"
 #include "core/fxge/fx_dib.h"
 
 #define FX_CCOLOR(val) (255 - (val))
@@ -194,6 +195,163 @@ int GetAlphaWithSrc(uint8_t src_alpha,
   return result / 255;
 }
 
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+// Each kernel handles whole groups of 4 pixels and returns how many pixels
+// it consumed; the scalar loops finish the tail. Results are bit-exact with
+// the scalar code.
+
+// x / 255 for 0 <= x <= 65535 in each 16-bit lane.
+FXDIB_SSE2_TARGET inline __m128i Div255_SSE2(__m128i x) {
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(-32639)), 7);
+}
+
+// Loads 4 bytes and widens them to one 32-bit lane each.
+FXDIB_SSE2_TARGET inline __m128i LoadBytes4_SSE2(const uint8_t* bytes) {
+  int32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  const __m128i zero = _mm_setzero_si128();
+  return _mm_unpacklo_epi16(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+}
+
+// FXDIB_ALPHA_MERGE() on all 4 channels of 4 BGRA pixels, with one alpha per
+// pixel in the 32-bit lanes of |alpha|.
+FXDIB_SSE2_TARGET inline __m128i AlphaMerge4_SSE2(__m128i dest,
+                                                  __m128i src,
+                                                  __m128i alpha) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max = _mm_set1_epi16(255);
+  __m128i alpha16 = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+  __m128i alpha_lo = _mm_unpacklo_epi32(alpha16, alpha16);
+  __m128i alpha_hi = _mm_unpackhi_epi32(alpha16, alpha16);
+  __m128i lo = _mm_add_epi16(
+      _mm_mullo_epi16(_mm_unpacklo_epi8(dest, zero),
+                      _mm_sub_epi16(max, alpha_lo)),
+      _mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), alpha_lo));
+  __m128i hi = _mm_add_epi16(
+      _mm_mullo_epi16(_mm_unpackhi_epi8(dest, zero),
+                      _mm_sub_epi16(max, alpha_hi)),
+      _mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), alpha_hi));
+  return _mm_packus_epi16(Div255_SSE2(lo), Div255_SSE2(hi));
+}
+
+// Normal blend of 4 BGR colors with per-pixel |src_alpha| onto 4 BGRA pixels,
+// as in the BlendMode::kNormal branch of CompositeRow_Argb2Argb().
+FXDIB_SSE2_TARGET inline __m128i CompositeArgb4_SSE2(__m128i dest,
+                                                     __m128i src,
+                                                     __m128i src_alpha) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i color_mask = _mm_set1_epi32(0x00ffffff);
+  __m128i back_alpha = _mm_srli_epi32(dest, 24);
+  __m128i dest_alpha = _mm_sub_epi32(
+      _mm_add_epi32(back_alpha, src_alpha),
+      Div255_SSE2(_mm_mullo_epi16(back_alpha, src_alpha)));
+  // |src_alpha| <= |dest_alpha|, so the quotient is at most 255 and single
+  // precision truncates it exactly. Zero divisors only occur where
+  // |back_alpha| is 0, which is replaced below.
+  __m128i divisor = _mm_or_si128(
+      dest_alpha,
+      _mm_and_si128(_mm_cmpeq_epi32(dest_alpha, zero), _mm_set1_epi32(1)));
+  __m128i dividend = _mm_mullo_epi16(src_alpha, _mm_set1_epi32(255));
+  __m128i alpha_ratio = _mm_cvttps_epi32(
+      _mm_div_ps(_mm_cvtepi32_ps(dividend), _mm_cvtepi32_ps(divisor)));
+  __m128i result =
+      _mm_or_si128(_mm_and_si128(AlphaMerge4_SSE2(dest, src, alpha_ratio),
+                                 color_mask),
+                   _mm_slli_epi32(dest_alpha, 24));
+  __m128i copy = _mm_or_si128(_mm_and_si128(src, color_mask),
+                              _mm_slli_epi32(src_alpha, 24));
+  __m128i empty = _mm_cmpeq_epi32(back_alpha, zero);
+  return _mm_or_si128(_mm_and_si128(empty, copy),
+                      _mm_andnot_si128(empty, result));
+}
+
+FXDIB_SSE2_TARGET int CompositeRow_Argb2Argb_NoBlend_SSE2(
+    uint8_t* dest_scan,
+    const uint8_t* src_scan,
+    int pixel_count,
+    const uint8_t* clip_scan) {
+  int col = 0;
+  for (; col + 4 <= pixel_count; col += 4) {
+    __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_scan));
+    __m128i dest = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest_scan));
+    __m128i src_alpha = _mm_srli_epi32(src, 24);
+    if (clip_scan) {
+      src_alpha = Div255_SSE2(
+          _mm_mullo_epi16(LoadBytes4_SSE2(clip_scan + col), src_alpha));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_scan),
+                     CompositeArgb4_SSE2(dest, src, src_alpha));
+    dest_scan += 16;
+    src_scan += 16;
+  }
+  return col;
+}
+
+FXDIB_SSE2_TARGET int CompositeRow_Rgb2Argb_NoBlend_NoClip_SSE2(
+    uint8_t* dest_scan,
+    const uint8_t* src_scan,
+    int width) {
+  const __m128i opaque = _mm_set1_epi32(0xff000000);
+  int col = 0;
+  for (; col + 4 <= width; col += 4) {
+    __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_scan));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_scan),
+                     _mm_or_si128(src, opaque));
+    dest_scan += 16;
+    src_scan += 16;
+  }
+  return col;
+}
+
+FXDIB_SSE2_TARGET int CompositeRow_Argb2Rgb32_NoBlend_SSE2(
+    uint8_t* dest_scan,
+    const uint8_t* src_scan,
+    int width,
+    const uint8_t* clip_scan) {
+  const __m128i color_mask = _mm_set1_epi32(0x00ffffff);
+  int col = 0;
+  for (; col + 4 <= width; col += 4) {
+    __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_scan));
+    __m128i dest = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest_scan));
+    __m128i src_alpha = _mm_srli_epi32(src, 24);
+    if (clip_scan) {
+      src_alpha = Div255_SSE2(
+          _mm_mullo_epi16(LoadBytes4_SSE2(clip_scan + col), src_alpha));
+    }
+    __m128i merged = AlphaMerge4_SSE2(dest, src, src_alpha);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_scan),
+                     _mm_or_si128(_mm_and_si128(merged, color_mask),
+                                  _mm_andnot_si128(color_mask, dest)));
+    dest_scan += 16;
+    src_scan += 16;
+  }
+  return col;
+}
+
+FXDIB_SSE2_TARGET int CompositeRow_ByteMask2Argb_NoBlend_NoClip_SSE2(
+    uint8_t* dest_scan,
+    const uint8_t* src_scan,
+    int mask_alpha,
+    int src_r,
+    int src_g,
+    int src_b,
+    int pixel_count) {
+  const __m128i src = _mm_set1_epi32(ArgbEncode(0, src_r, src_g, src_b));
+  const __m128i mask = _mm_set1_epi32(mask_alpha);
+  int col = 0;
+  for (; col + 4 <= pixel_count; col += 4) {
+    __m128i dest = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest_scan));
+    __m128i src_alpha =
+        Div255_SSE2(_mm_mullo_epi16(LoadBytes4_SSE2(src_scan + col), mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest_scan),
+                     CompositeArgb4_SSE2(dest, src, src_alpha));
+    dest_scan += 16;
+  }
+  return col;
+}
+#endif  // defined(FXDIB_HAS_SSE2_KERNELS)
+
 void CompositeRow_AlphaToMask(uint8_t* dest_scan,
                               const uint8_t* src_scan,
                               int pixel_count,
@@ -395,6 +553,18 @@ void CompositeRow_Argb2Argb(uint8_t* dest_scan,
   bool bNonseparableBlend = IsNonSeparableBlendMode(blend_type);
   bool has_src = !!src_alpha_scan;
   bool has_dest = !!dest_alpha_scan;
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (!has_src && !has_dest && blend_type == BlendMode::kNormal &&
+      FXDIB_IsSSE2Enabled()) {
+    int done = CompositeRow_Argb2Argb_NoBlend_SSE2(dest_scan, src_scan,
+                                                   pixel_count, clip_scan);
+    dest_scan += done * 4;
+    src_scan += done * 4;
+    if (clip_scan)
+      clip_scan += done;
+    pixel_count -= done;
+  }
+#endif
   for (int col = 0; col < pixel_count; ++col) {
     uint8_t back_alpha = has_dest ? *dest_alpha_scan : dest_scan[3];
     const uint8_t* alpha_source = has_src ? src_alpha_scan++ : &src_scan[3];
@@ -647,6 +817,15 @@ void CompositeRow_Rgb2Argb_NoBlend_NoClip(uint8_t* dest_scan,
       *dest_alpha_scan++ = 255;
     }
   } else {
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+    if (src_Bpp == 4 && FXDIB_IsSSE2Enabled()) {
+      int done =
+          CompositeRow_Rgb2Argb_NoBlend_NoClip_SSE2(dest_scan, src_scan, width);
+      dest_scan += done * 4;
+      src_scan += done * 4;
+      width -= done;
+    }
+#endif
     for (int col = 0; col < width; col++) {
       if (src_Bpp == 4) {
         FXARGB_SETDIB(dest_scan, 0xff000000 | FXARGB_GETDIB(src_scan));
@@ -762,6 +941,17 @@ void CompositeRow_Argb2Rgb_NoBlend(uint8_t* dest_scan,
       dest_scan += dest_gap;
     }
   } else {
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+    if (dest_Bpp == 4 && FXDIB_IsSSE2Enabled()) {
+      int done = CompositeRow_Argb2Rgb32_NoBlend_SSE2(dest_scan, src_scan,
+                                                      width, clip_scan);
+      dest_scan += done * 4;
+      src_scan += done * 4;
+      if (clip_scan)
+        clip_scan += done;
+      width -= done;
+    }
+#endif
     for (int col = 0; col < width; col++) {
       uint8_t src_alpha;
       if (clip_scan) {
@@ -1506,6 +1696,16 @@ void CompositeRow_ByteMask2Argb(uint8_t* dest_scan,
                                 int pixel_count,
                                 BlendMode blend_type,
                                 const uint8_t* clip_scan) {
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (!clip_scan && blend_type == BlendMode::kNormal &&
+      FXDIB_IsSSE2Enabled()) {
+    int done = CompositeRow_ByteMask2Argb_NoBlend_NoClip_SSE2(
+        dest_scan, src_scan, mask_alpha, src_r, src_g, src_b, pixel_count);
+    dest_scan += done * 4;
+    src_scan += done;
+    pixel_count -= done;
+  }
+#endif
   for (int col = 0; col < pixel_count; col++) {
     int src_alpha = GetAlphaWithSrc(mask_alpha, clip_scan, src_scan, col);
     uint8_t back_alpha = dest_scan[3];
@@ -12,6 +12,7 @@
 #include "core/fxcrt/pauseindicator_iface.h"
 #include "core/fxge/dib/cfx_dibbase.h"
 #include "core/fxge/dib/cfx_dibitmap.h"
+#include "core/fxge/dib/fx_dib_sse2.h"
 #include "core/fxge/dib/scanlinecomposer_iface.h"
 #include "core/fxge/fx_dib.h"
 #include "third_party/base/stl_util.h"
@@ -24,6 +25,212 @@ int GetPitchRoundUpTo4Bytes(int bits_per_pixel) {
   return (bits_per_pixel + 31) / 32 * 4;
 }
 
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+// The kernels only reorder exact integer sums, so their results are
+// identical to the scalar loops. The row kernels return how many elements
+// they consumed and the scalar loops finish the tail.
+
+// Loads 4 bytes and widens them to one 32-bit lane each.
+FXDIB_SSE2_TARGET inline __m128i LoadBytes4_SSE2(const uint8_t* bytes) {
+  int32_t value;
+  memcpy(&value, bytes, sizeof(value));
+  const __m128i zero = _mm_setzero_si128();
+  return _mm_unpacklo_epi16(
+      _mm_unpacklo_epi8(_mm_cvtsi32_si128(value), zero), zero);
+}
+
+// 32-bit |pixels| * |weights|, for pixels in [0, 255] and any weights.
+// SSE2 has no 32-bit multiply, so the weights are split into 16-bit halves.
+FXDIB_SSE2_TARGET inline __m128i MulPixelWeights_SSE2(__m128i pixels,
+                                                      __m128i weights) {
+  __m128i low = _mm_add_epi32(
+      _mm_mullo_epi16(pixels, weights),
+      _mm_slli_epi32(_mm_mulhi_epu16(pixels, weights), 16));
+  return _mm_add_epi32(low,
+                       _mm_mullo_epi16(_mm_slli_epi32(pixels, 16), weights));
+}
+
+FXDIB_SSE2_TARGET inline int HorizontalSum_SSE2(__m128i sums) {
+  sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+  sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(sums);
+}
+
+// Adds the weighted sum of whole groups of 4 samples to |sum|.
+FXDIB_SSE2_TARGET int WeightedSum8_SSE2(const uint8_t* src,
+                                        const int* weights,
+                                        int count,
+                                        int* sum) {
+  __m128i sums = _mm_setzero_si128();
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i pixel_weights =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+    sums = _mm_add_epi32(
+        sums, MulPixelWeights_SSE2(LoadBytes4_SSE2(src + i), pixel_weights));
+  }
+  *sum = HorizontalSum_SSE2(sums);
+  return i;
+}
+
+FXDIB_SSE2_TARGET void WeightedSum3Channels32_SSE2(const uint8_t* src,
+                                                   const int* weights,
+                                                   int count,
+                                                   int* sums) {
+  __m128i channels = _mm_setzero_si128();
+  for (int i = 0; i < count; ++i) {
+    channels = _mm_add_epi32(
+        channels, MulPixelWeights_SSE2(LoadBytes4_SSE2(src + i * 4),
+                                       _mm_set1_epi32(weights[i])));
+  }
+  int result[4];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(result), channels);
+  sums[0] = result[0];
+  sums[1] = result[1];
+  sums[2] = result[2];
+}
+
+FXDIB_SSE2_TARGET int AccumulateWeightedRow_SSE2(int* accum,
+                                                 const uint8_t* src,
+                                                 int bytes,
+                                                 int weight) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i weights = _mm_set1_epi32(weight);
+  int i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+    __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+    __m128i quads[4] = {
+        _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+        _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero)};
+    for (int q = 0; q < 4; ++q) {
+      __m128i* sums = reinterpret_cast<__m128i*>(accum + i + q * 4);
+      _mm_storeu_si128(
+          sums, _mm_add_epi32(_mm_loadu_si128(sums),
+                              MulPixelWeights_SSE2(quads[q], weights)));
+    }
+  }
+  return i;
+}
+
+FXDIB_SSE2_TARGET int StoreWeightedRow_SSE2(const int* accum,
+                                            uint8_t* dest,
+                                            int bytes,
+                                            int Bpp,
+                                            bool bClamp) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max_value = _mm_set1_epi32(kMaxDestValue);
+  const __m128i byte_mask = _mm_set1_epi32(0xff);
+  const __m128i keep_mask =
+      Bpp == 4 ? _mm_set1_epi32(0xff000000) : _mm_setzero_si128();
+  int i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i quads[4];
+    for (int q = 0; q < 4; ++q) {
+      __m128i sums =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(accum + i + q * 4));
+      if (bClamp) {
+        sums = _mm_andnot_si128(_mm_cmplt_epi32(sums, zero), sums);
+        __m128i over = _mm_cmpgt_epi32(sums, max_value);
+        sums = _mm_or_si128(_mm_and_si128(over, max_value),
+                            _mm_andnot_si128(over, sums));
+      }
+      quads[q] = _mm_and_si128(_mm_srai_epi32(sums, 16), byte_mask);
+    }
+    __m128i result =
+        _mm_packus_epi16(_mm_packs_epi32(quads[0], quads[1]),
+                         _mm_packs_epi32(quads[2], quads[3]));
+    __m128i* out = reinterpret_cast<__m128i*>(dest + i);
+    __m128i kept = _mm_and_si128(keep_mask, _mm_loadu_si128(out));
+    _mm_storeu_si128(out,
+                     _mm_or_si128(_mm_andnot_si128(keep_mask, result), kept));
+  }
+  return i;
+}
+#endif  // defined(FXDIB_HAS_SSE2_KERNELS)
+
+// Whether every source pixel of |pWeights| has a weight in the table.
+bool HasAllWeights(const PixelWeight* pWeights, size_t weight_count) {
+  return pWeights->m_SrcEnd < pWeights->m_SrcStart ||
+         static_cast<size_t>(pWeights->m_SrcEnd - pWeights->m_SrcStart) <
+             weight_count;
+}
+
+// Sum of |weights[i]| * |src[i]| over |count| 8-bit samples.
+int WeightedSum8(const uint8_t* src, const int* weights, int count) {
+  int i = 0;
+  int sum = 0;
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (FXDIB_IsSSE2Enabled())
+    i = WeightedSum8_SSE2(src, weights, count, &sum);
+#endif
+  for (; i < count; ++i)
+    sum += weights[i] * src[i];
+  return sum;
+}
+
+// Weighted sums of the first 3 channels of |count| pixels of |Bpp| bytes
+// into |sums|.
+void WeightedSum3Channels(const uint8_t* src,
+                          int Bpp,
+                          const int* weights,
+                          int count,
+                          int* sums) {
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (Bpp == 4 && FXDIB_IsSSE2Enabled()) {
+    WeightedSum3Channels32_SSE2(src, weights, count, sums);
+    return;
+  }
+#endif
+  sums[0] = 0;
+  sums[1] = 0;
+  sums[2] = 0;
+  for (int i = 0; i < count; ++i) {
+    const uint8_t* src_pixel = src + i * Bpp;
+    sums[0] += weights[i] * src_pixel[0];
+    sums[1] += weights[i] * src_pixel[1];
+    sums[2] += weights[i] * src_pixel[2];
+  }
+}
+
+// Adds |weight| * |src[i]| to |accum[i]| for a whole intermediate row.
+void AccumulateWeightedRow(int* accum,
+                           const uint8_t* src,
+                           int bytes,
+                           int weight) {
+  int i = 0;
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (FXDIB_IsSSE2Enabled())
+    i = AccumulateWeightedRow_SSE2(accum, src, bytes, weight);
+#endif
+  for (; i < bytes; ++i)
+    accum[i] += weight * src[i];
+}
+
+// Writes the accumulated row to |dest|. With |Bpp| 4 the fourth byte of each
+// pixel is left untouched, like the per-pixel vertical pass.
+void StoreWeightedRow(const int* accum,
+                      uint8_t* dest,
+                      int bytes,
+                      int Bpp,
+                      bool bClamp) {
+  int i = 0;
+#if defined(FXDIB_HAS_SSE2_KERNELS)
+  if (FXDIB_IsSSE2Enabled())
+    i = StoreWeightedRow_SSE2(accum, dest, bytes, Bpp, bClamp);
+#endif
+  for (; i < bytes; ++i) {
+    if (Bpp == 4 && i % 4 == 3)
+      continue;
+
+    int value = accum[i];
+    if (bClamp)
+      value = pdfium::clamp(value, 0, kMaxDestValue);
+    dest[i] = static_cast<uint8_t>(value >> 16);
+  }
+}
+
 }  // namespace
 
 CStretchEngine::CWeightTable::CWeightTable() = default;
@@ -396,15 +603,12 @@ bool CStretchEngine::ContinueStretchHorz(PauseIndicatorIface* pPause) {
       case TransformMethod::k8BppTo8Bpp: {
         for (int col = m_DestClip.left; col < m_DestClip.right; ++col) {
           PixelWeight* pWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_a = 0;
-          for (int j = pWeights->m_SrcStart; j <= pWeights->m_SrcEnd; ++j) {
-            int* pWeight = m_WeightTable.GetValueFromPixelWeight(pWeights, j);
-            if (!pWeight)
-              return false;
+          if (!HasAllWeights(pWeights, m_WeightTable.GetPixelWeightSize()))
+            return false;
 
-            int pixel_weight = *pWeight;
-            dest_a += pixel_weight * src_scan[j];
-          }
+          int dest_a =
+              WeightedSum8(src_scan + pWeights->m_SrcStart, pWeights->m_Weights,
+                           pWeights->m_SrcEnd - pWeights->m_SrcStart + 1);
           if (m_ResampleOptions.bInterpolateBicubic)
             dest_a = pdfium::clamp(dest_a, 0, kMaxDestValue);
           *dest_scan++ = static_cast<uint8_t>(dest_a >> 16);
@@ -511,20 +715,17 @@ bool CStretchEngine::ContinueStretchHorz(PauseIndicatorIface* pPause) {
       case TransformMethod::kManyBpptoManyBpp: {
         for (int col = m_DestClip.left; col < m_DestClip.right; ++col) {
           PixelWeight* pWeights = m_WeightTable.GetPixelWeight(col);
-          int dest_r_y = 0;
-          int dest_g_m = 0;
-          int dest_b_c = 0;
-          for (int j = pWeights->m_SrcStart; j <= pWeights->m_SrcEnd; ++j) {
-            int* pWeight = m_WeightTable.GetValueFromPixelWeight(pWeights, j);
-            if (!pWeight)
-              return false;
-
-            int pixel_weight = *pWeight;
-            const uint8_t* src_pixel = src_scan + j * Bpp;
-            dest_b_c += pixel_weight * (*src_pixel++);
-            dest_g_m += pixel_weight * (*src_pixel++);
-            dest_r_y += pixel_weight * (*src_pixel);
-          }
+          if (!HasAllWeights(pWeights, m_WeightTable.GetPixelWeightSize()))
+            return false;
+
+          int sums[3];
+          WeightedSum3Channels(src_scan + pWeights->m_SrcStart * Bpp, Bpp,
+                               pWeights->m_Weights,
+                               pWeights->m_SrcEnd - pWeights->m_SrcStart + 1,
+                               sums);
+          int dest_b_c = sums[0];
+          int dest_g_m = sums[1];
+          int dest_r_y = sums[2];
           if (m_ResampleOptions.bInterpolateBicubic) {
             dest_b_c = pdfium::clamp(dest_b_c, 0, kMaxDestValue);
             dest_g_m = pdfium::clamp(dest_g_m, 0, kMaxDestValue);
@@ -596,10 +797,48 @@ void CStretchEngine::StretchVert() {
     return;
 
   const int DestBpp = m_DestBpp / 8;
+  // Formats whose channels are all stretched the same way are summed a whole
+  // intermediate row at a time, which reads the buffer sequentially.
+  bool bRowWise = false;
+  switch (m_TransMethod) {
+    case TransformMethod::k1BppTo8Bpp:
+    case TransformMethod::k8BppTo8Bpp:
+      bRowWise = DestBpp == 1;
+      break;
+    case TransformMethod::k8BppToManyBpp:
+    case TransformMethod::kManyBpptoManyBpp:
+      bRowWise = DestBpp == 3 || DestBpp == 4;
+      break;
+    default:
+      break;
+  }
+  const int row_bytes = m_DestClip.Width() * DestBpp;
+  std::vector<int, FxAllocAllocator<int>> row_sums;
+  if (bRowWise)
+    row_sums.resize(row_bytes);
+
   for (int row = m_DestClip.top; row < m_DestClip.bottom; ++row) {
     unsigned char* dest_scan = m_DestScanline.data();
     unsigned char* dest_scan_mask = m_DestMaskScanline.data();
     PixelWeight* pWeights = table.GetPixelWeight(row);
+    if (bRowWise) {
+      if (!HasAllWeights(pWeights, table.GetPixelWeightSize()))
+        return;
+
+      std::fill(row_sums.begin(), row_sums.end(), 0);
+      for (int j = pWeights->m_SrcStart; j <= pWeights->m_SrcEnd; ++j) {
+        AccumulateWeightedRow(
+            row_sums.data(),
+            m_InterBuf.data() + (j - m_SrcClip.top) * m_InterPitch, row_bytes,
+            pWeights->m_Weights[j - pWeights->m_SrcStart]);
+      }
+      StoreWeightedRow(row_sums.data(), dest_scan, row_bytes, DestBpp,
+                       m_ResampleOptions.bInterpolateBicubic);
+      m_pDestBitmap->ComposeScanline(row - m_DestClip.top,
+                                     m_DestScanline.data(),
+                                     m_DestMaskScanline.data());
+      continue;
+    }
     switch (m_TransMethod) {
       case TransformMethod::k1BppTo8Bpp:
       case TransformMethod::k1BppToManyBpp:
@@ -0,0 +1,34 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/dib/fx_dib_sse2.h"
+
+#include <atomic>
+
+namespace {
+
+bool CpuHasSSE2() {
+#if defined(__SSE2__)
+  return true;
+#elif defined(FXDIB_HAS_SSE2_KERNELS)
+  return __builtin_cpu_supports("sse2");
+#else
+  return false;
+#endif
+}
+
+std::atomic<bool>& SSE2Enabled() {
+  static std::atomic<bool> enabled(CpuHasSSE2());
+  return enabled;
+}
+
+}  // namespace
+
+bool FXDIB_IsSSE2Enabled() {
+  return SSE2Enabled().load(std::memory_order_relaxed);
+}
+
+void FXDIB_SetSSE2Enabled(bool enabled) {
+  SSE2Enabled().store(enabled && CpuHasSSE2(), std::memory_order_relaxed);
+}
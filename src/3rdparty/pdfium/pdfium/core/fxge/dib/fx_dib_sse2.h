@@ -0,0 +1,29 @@
+// Copyright 2020 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXGE_DIB_FX_DIB_SSE2_H_
+#define CORE_FXGE_DIB_FX_DIB_SSE2_H_
+
+// The SSE2 compositing and stretching kernels are built for every x86 target.
+// When the compiler baseline does not include SSE2 (32-bit builds), they are
+// compiled for SSE2 individually and only run when the CPU supports it.
+#if defined(__SSE2__) || \
+    ((defined(__i386__) || defined(__x86_64__)) && defined(__GNUC__))
+#define FXDIB_HAS_SSE2_KERNELS 1
+#include <emmintrin.h>
+#if defined(__SSE2__)
+#define FXDIB_SSE2_TARGET
+#else
+#define FXDIB_SSE2_TARGET __attribute__((target("sse2")))
+#endif
+#endif
+
+// Whether the SSE2 kernels run. Defaults to whether the CPU supports SSE2.
+bool FXDIB_IsSSE2Enabled();
+
+// Forces the scalar kernels when |enabled| is false, e.g. to compare them
+// with the SSE2 kernels. Has no effect on CPUs without SSE2.
+void FXDIB_SetSSE2Enabled(bool enabled);
+
+#endif  // CORE_FXGE_DIB_FX_DIB_SSE2_H_
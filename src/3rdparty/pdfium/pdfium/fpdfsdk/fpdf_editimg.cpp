@@ -389,7 +389,7 @@ FPDFImageObj_GetImageMetadata(FPDF_PAGEOBJECT image_object,
   auto pSource = pdfium::MakeRetain<CPDF_DIB>();
   CPDF_DIB::LoadState ret = pSource->StartLoadDIBBase(
       pPage->GetDocument(), pImg->GetStream(), false, nullptr,
-      pPage->m_pPageResources.Get(), false, 0, false);
+      pPage->m_pPageResources.Get(), false, 0, false, CFX_Size());
   if (ret == CPDF_DIB::LoadState::kFail)
     return true;
 
@@ -49,6 +49,8 @@ FPDF_RenderPageBitmapWithColorScheme_Start(FPDF_BITMAP bitmap,
                                            int start_y,
                                            int size_x,
                                            int size_y,
+                                           int src_size_w,
+                                           int src_size_h,
                                            int rotate,
                                            int flags,
                                            const FPDF_COLORSCHEME *color_scheme,
@@ -73,7 +75,7 @@ FPDF_RenderPageBitmapWithColorScheme_Start(FPDF_BITMAP bitmap,
 
     CPDFSDK_PauseAdapter pause_adapter(pause);
     CPDFSDK_RenderPageWithContext(pContext, pPage, start_x, start_y, size_x,
-                                  size_y, size_x, size_y, rotate, flags, color_scheme,
+                                  size_y, src_size_w, src_size_h, rotate, flags, color_scheme,
                                   /*need_to_restore=*/false, &pause_adapter);
 
 #if defined(_SKIA_SUPPORT_PATHS_)
@@ -93,12 +95,15 @@ FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
                                                           int start_y,
                                                           int size_x,
                                                           int size_y,
+                                                          int src_size_w,
+                                                          int src_size_h,
                                                           int rotate,
                                                           int flags,
                                                           IFSDK_PAUSE *pause)
 {
     return FPDF_RenderPageBitmapWithColorScheme_Start(
-               bitmap, page, start_x, start_y, size_x, size_y, rotate, flags,
+               bitmap, page, start_x, start_y, size_x, size_y, src_size_w,
+               src_size_h, rotate, flags,
                /*color_scheme=*/nullptr, pause);
 }
 
@@ -127,6 +132,20 @@ FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPage_Continue(FPDF_PAGE page,
     return ToFPDFStatus(pContext->m_pRenderer->GetStatus());
 }
 
+FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPage_GetProgress(FPDF_PAGE page)
+{
+    CPDF_Page *pPage = CPDFPageFromFPDFPage(page);
+    if (!pPage)
+        return -1;
+
+    auto *pContext =
+        static_cast<CPDF_PageRenderContext *>(pPage->GetRenderContext());
+    if (!pContext || !pContext->m_pRenderer)
+        return -1;
+
+    return pContext->m_pRenderer->GetProgress();
+}
+
 FPDF_EXPORT void FPDF_CALLCONV FPDF_RenderPage_Close(FPDF_PAGE page)
 {
     CPDF_Page *pPage = CPDFPageFromFPDFPage(page);
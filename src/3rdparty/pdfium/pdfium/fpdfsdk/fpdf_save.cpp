@@ -15,9 +15,11 @@
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
+#include "core/fpdfapi/parser/cpdf_syntax_parser.h"
 #include "core/fxcrt/fx_extension.h"
 #include "fpdfsdk/cpdfsdk_filewriteadapter.h"
 #include "fpdfsdk/cpdfsdk_helpers.h"
@@ -194,6 +196,69 @@ bool DoDocSave(FPDF_DOCUMENT document,
   return bRet;
 }
 
+void AddIndirectObjNum(const CPDF_Object* pObj,
+                       std::vector<uint32_t>* objnums) {
+  if (pObj && pObj->IsReference())
+    objnums->push_back(pObj->AsReference()->GetRefObjNum());
+}
+
+// Collects the appearance streams of |pAnnotDict|. Each of /N, /R and /D is
+// either a stream or a dictionary of streams keyed by appearance state.
+void CollectAppearanceObjNums(const CPDF_Dictionary* pAnnotDict,
+                              std::vector<uint32_t>* objnums) {
+  AddIndirectObjNum(pAnnotDict->GetObjectFor("AP"), objnums);
+
+  const CPDF_Dictionary* pAPDict = pAnnotDict->GetDictFor("AP");
+  if (!pAPDict)
+    return;
+
+  for (const char* mode : {"N", "R", "D"}) {
+    AddIndirectObjNum(pAPDict->GetObjectFor(mode), objnums);
+
+    const CPDF_Dictionary* pStates = pAPDict->GetDictFor(mode);
+    if (!pStates)
+      continue;
+
+    CPDF_DictionaryLocker locker(pStates);
+    for (const auto& it : locker)
+      AddIndirectObjNum(it.second.Get(), objnums);
+  }
+}
+
+// Collects the objects an annotation edit on |pPageDict| may have changed:
+// the page, its /Annots array, and each annotation together with its
+// appearance streams and pop-up annotation.
+void CollectPageObjNums(CPDF_Dictionary* pPageDict,
+                        std::vector<uint32_t>* objnums) {
+  if (pPageDict->GetObjNum() != CPDF_Object::kInvalidObjNum)
+    objnums->push_back(pPageDict->GetObjNum());
+
+  AddIndirectObjNum(pPageDict->GetObjectFor("Annots"), objnums);
+
+  CPDF_Array* pAnnots = pPageDict->GetArrayFor("Annots");
+  if (!pAnnots)
+    return;
+
+  CPDF_ArrayLocker locker(pAnnots);
+  for (const auto& pAnnot : locker) {
+    AddIndirectObjNum(pAnnot.Get(), objnums);
+
+    const CPDF_Dictionary* pAnnotDict = ToDictionary(pAnnot->GetDirect());
+    if (!pAnnotDict)
+      continue;
+
+    CollectAppearanceObjNums(pAnnotDict, objnums);
+
+    const CPDF_Object* pPopup = pAnnotDict->GetObjectFor("Popup");
+    AddIndirectObjNum(pPopup, objnums);
+
+    const CPDF_Dictionary* pPopupDict =
+        ToDictionary(pPopup ? pPopup->GetDirect() : nullptr);
+    if (pPopupDict)
+      CollectAppearanceObjNums(pPopupDict, objnums);
+  }
+}
+
 }  // namespace
 
 FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_SaveAsCopy(FPDF_DOCUMENT document,
@@ -209,3 +274,58 @@ FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                      int fileVersion) {
   return DoDocSave(document, pFileWrite, flags, fileVersion);
 }
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_InitIncrementalUpdate(FPDF_DOCUMENT document,
+                           FPDF_INCREMENTAL_UPDATE* update) {
+  CPDF_Document* pPDFDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pPDFDoc || !update)
+    return false;
+
+  CPDF_Parser* pParser = pPDFDoc->GetParser();
+  if (!pParser || pParser->GetLastXRefOffset() == 0 ||
+      pParser->IsXRefStream()) {
+    return false;
+  }
+
+  update->file_size = pParser->GetSyntax()->GetDocumentSize();
+  update->xref_offset = pParser->GetLastXRefOffset();
+  update->last_objnum = pParser->GetLastObjNum();
+  return true;
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SaveIncrementalUpdate(FPDF_DOCUMENT document,
+                           FPDF_FILEWRITE* pFileWrite,
+                           const int* page_indices,
+                           int page_count,
+                           FPDF_INCREMENTAL_UPDATE* update) {
+  CPDF_Document* pPDFDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pPDFDoc || !pFileWrite || !update || page_count < 0 ||
+      (page_count > 0 && !page_indices)) {
+    return false;
+  }
+
+  std::vector<uint32_t> objnums;
+  for (int i = 0; i < page_count; ++i) {
+    CPDF_Dictionary* pPageDict = pPDFDoc->GetPageDictionary(page_indices[i]);
+    if (!pPageDict)
+      return false;
+
+    CollectPageObjNums(pPageDict, &objnums);
+  }
+
+  CPDF_Creator fileMaker(
+      pPDFDoc, pdfium::MakeRetain<CPDFSDK_FileWriteAdapter>(pFileWrite));
+  if (!fileMaker.CreateIncrementalUpdate(update->file_size,
+                                         update->xref_offset,
+                                         update->last_objnum,
+                                         std::move(objnums))) {
+    return false;
+  }
+
+  update->file_size = fileMaker.GetCurrentOffset();
+  update->xref_offset = fileMaker.GetXRefStart();
+  update->last_objnum = pPDFDoc->GetLastObjNum();
+  return true;
+}
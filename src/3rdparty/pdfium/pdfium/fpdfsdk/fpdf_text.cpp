@@ -11,7 +11,6 @@
 #include <vector>
 
 #include "build/build_config.h"
-#include "core/fpdfapi/font/cpdf_cidfont.h"
 #include "core/fpdfapi/font/cpdf_font.h"
 #include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/page/cpdf_textobject.h"
@@ -236,45 +235,7 @@ FPDFText_GetLooseCharBox(FPDF_TEXTPAGE text_page, int index, FS_RECTF* rect) {
   if (!textpage)
     return false;
 
-  const CPDF_TextPage::CharInfo& charinfo = textpage->GetCharInfo(index);
-  float font_size = textpage->GetCharFontSize(index);
-
-  if (charinfo.m_pTextObj && !IsFloatZero(font_size)) {
-    bool is_vert_writing = charinfo.m_pTextObj->GetFont()->IsVertWriting();
-    if (is_vert_writing && charinfo.m_pTextObj->GetFont()->IsCIDFont()) {
-      CPDF_CIDFont* pCIDFont = charinfo.m_pTextObj->GetFont()->AsCIDFont();
-      uint16_t cid = pCIDFont->CIDFromCharCode(charinfo.m_CharCode);
-
-      CFX_Point16 vertical_origin = pCIDFont->GetVertOrigin(cid);
-      double offsetx = (vertical_origin.x - 500) * font_size / 1000.0;
-      double offsety = vertical_origin.y * font_size / 1000.0;
-      int16_t vert_width = pCIDFont->GetVertWidth(cid);
-      double height = vert_width * font_size / 1000.0;
-
-      rect->left = charinfo.m_Origin.x + offsetx;
-      rect->right = rect->left + font_size;
-      rect->bottom = charinfo.m_Origin.y + offsety;
-      rect->top = rect->bottom + height;
-      return true;
-    }
-
-    int ascent = charinfo.m_pTextObj->GetFont()->GetTypeAscent();
-    int descent = charinfo.m_pTextObj->GetFont()->GetTypeDescent();
-    if (ascent != descent) {
-      float width = charinfo.m_Matrix.a *
-                    charinfo.m_pTextObj->GetCharWidth(charinfo.m_CharCode);
-      float font_scale = charinfo.m_Matrix.a * font_size / (ascent - descent);
-
-      rect->left = charinfo.m_Origin.x;
-      rect->right = charinfo.m_Origin.x + (is_vert_writing ? -width : width);
-      rect->bottom = charinfo.m_Origin.y + descent * font_scale;
-      rect->top = charinfo.m_Origin.y + ascent * font_scale;
-      return true;
-    }
-  }
-
-  // Fallback to the tight bounds in empty text scenarios, or bad font metrics
-  *rect = FSRectFFromCFXFloatRect(charinfo.m_CharBox);
+  *rect = FSRectFFromCFXFloatRect(textpage->GetCharLooseBounds(index));
   return true;
 }
 
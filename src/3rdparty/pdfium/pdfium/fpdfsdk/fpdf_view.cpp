@@ -8,10 +8,12 @@
 
 #include <cmath>
 #include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
 #include "build/build_config.h"
+#include "constants/page_object.h"
 #include "core/fpdfapi/page/cpdf_docpagedata.h"
 #include "core/fpdfapi/page/cpdf_occontext.h"
 #include "core/fpdfapi/page/cpdf_page.h"
@@ -32,6 +34,7 @@
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfdoc/cpdf_nametree.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
+#include "core/fxcrt/cfx_memorymappedfile.h"
 #include "core/fxcrt/cfx_readonlymemorystream.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxcrt/fx_stream.h"
@@ -163,8 +166,158 @@ FPDF_DOCUMENT LoadDocumentImpl(
     return FPDFDocumentFromCPDFDocument(pDocument.release());
 }
 
+// Same limit as CPDF_Document's page tree traversal.
+constexpr size_t kMaxPageTreeLevel = 1024;
+
+// Page attributes inherited from the ancestors of a page tree node.
+struct InheritedPageAttrs {
+    const CPDF_Array *media_box = nullptr;
+    const CPDF_Array *crop_box = nullptr;
+    const CPDF_Object *rotate = nullptr;
+};
+
+CFX_FloatRect GetNormalizedBox(const CPDF_Array *box)
+{
+    CFX_FloatRect rect;
+    if (box) {
+        rect = box->GetRect();
+        rect.Normalize();
+    }
+    return rect;
+}
+
+// Mirrors CPDF_Page::UpdateDimensions() and CPDF_Page::GetPageRotation().
+void AppendPageSize(const InheritedPageAttrs &attrs,
+                    std::vector<FS_SIZEF> *sizes,
+                    std::vector<int> *rotations)
+{
+    CFX_FloatRect mediabox = GetNormalizedBox(attrs.media_box);
+    if (mediabox.IsEmpty())
+        mediabox = CFX_FloatRect(0, 0, 612, 792);
+
+    CFX_FloatRect bbox = GetNormalizedBox(attrs.crop_box);
+    if (bbox.IsEmpty())
+        bbox = mediabox;
+    else
+        bbox.Intersect(mediabox);
+
+    int rotate = attrs.rotate ? (attrs.rotate->GetInteger() / 90) % 4 : 0;
+    if (rotate < 0)
+        rotate += 4;
+
+    FS_SIZEF size;
+    size.width = bbox.Width();
+    size.height = bbox.Height();
+    if (rotate % 2)
+        std::swap(size.width, size.height);
+
+    sizes->push_back(size);
+    rotations->push_back(rotate);
+}
+
+// Walks the page tree in page order the way CPDF_Document assigns page
+// indices: kids without /Kids are pages, kids that are not dictionaries
+// still take a page index.
+bool CollectPageSizes(const CPDF_Dictionary *node,
+                      InheritedPageAttrs attrs,
+                      size_t level,
+                      std::set<const CPDF_Dictionary *> *visited,
+                      std::vector<FS_SIZEF> *sizes,
+                      std::vector<int> *rotations)
+{
+    if (level >= kMaxPageTreeLevel || !visited->insert(node).second)
+        return false;
+
+    if (const CPDF_Array *media_box = node->GetArrayFor(pdfium::page_object::kMediaBox))
+        attrs.media_box = media_box;
+    if (const CPDF_Array *crop_box = node->GetArrayFor(pdfium::page_object::kCropBox))
+        attrs.crop_box = crop_box;
+    if (const CPDF_Object *rotate = node->GetDirectObjectFor(pdfium::page_object::kRotate))
+        attrs.rotate = rotate;
+
+    const CPDF_Array *kids = node->GetArrayFor("Kids");
+    if (!kids) {
+        AppendPageSize(attrs, sizes, rotations);
+        return true;
+    }
+
+    for (size_t i = 0; i < kids->size(); ++i) {
+        const CPDF_Dictionary *kid = kids->GetDictAt(i);
+        if (!kid) {
+            sizes->push_back(FS_SIZEF{0, 0});
+            rotations->push_back(0);
+            continue;
+        }
+        if (kid == node)
+            continue;
+
+        if (!CollectPageSizes(kid, attrs, level + 1, visited, sizes, rotations))
+            return false;
+    }
+    return true;
+}
+
 }  // namespace
 
+FPDF_EXPORT int FPDF_CALLCONV FPDF_GetPageSizes(FPDF_DOCUMENT document,
+                                                FS_SIZEF *sizes,
+                                                int *rotations,
+                                                int count)
+{
+    const CPDF_Document *pDoc = CPDFDocumentFromFPDFDocument(document);
+    if (!pDoc || count < 0)
+        return -1;
+
+    const CPDF_Dictionary *pRoot = pDoc->GetRoot();
+    const CPDF_Dictionary *pPages = pRoot ? pRoot->GetDictFor("Pages") : nullptr;
+    if (!pPages)
+        return -1;
+
+    std::vector<FS_SIZEF> page_sizes;
+    std::vector<int> page_rotations;
+    std::set<const CPDF_Dictionary *> visited;
+    if (!CollectPageSizes(pPages, InheritedPageAttrs(), 0, &visited, &page_sizes, &page_rotations))
+        return -1;
+
+    const size_t filled = std::min(page_sizes.size(), static_cast<size_t>(count));
+    for (size_t i = 0; i < filled; ++i) {
+        if (sizes)
+            sizes[i] = page_sizes[i];
+        if (rotations)
+            rotations[i] = page_rotations[i];
+    }
+    return pdfium::CollectionSize<int>(page_sizes);
+}
+
+FPDF_EXPORT void FPDF_CALLCONV FPDF_SetImageCacheBudget(FPDF_DOCUMENT document,
+                                                        unsigned long bytes)
+{
+    const CPDF_Document *pDoc = CPDFDocumentFromFPDFDocument(document);
+    CPDF_DocRenderData *pRenderData = pDoc ? CPDF_DocRenderData::FromDocument(pDoc) : nullptr;
+    if (!pRenderData)
+        return;
+
+    pRenderData->GetImageCache()->SetBudget(bytes);
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS *stats)
+{
+    const CPDF_Document *pDoc = CPDFDocumentFromFPDFDocument(document);
+    CPDF_DocRenderData *pRenderData = pDoc ? CPDF_DocRenderData::FromDocument(pDoc) : nullptr;
+    if (!pRenderData || !stats)
+        return false;
+
+    const CPDF_DocImageCache::Stats cache_stats = pRenderData->GetImageCache()->GetStats();
+    stats->entries = cache_stats.entries;
+    stats->usage = cache_stats.usage;
+    stats->budget = cache_stats.budget;
+    stats->hits = cache_stats.hits;
+    stats->misses = cache_stats.misses;
+    stats->evictions = cache_stats.evictions;
+    return true;
+}
+
 FPDF_EXPORT void FPDF_CALLCONV FPDF_InitLibrary()
 {
     FPDF_InitLibraryWithConfig(nullptr);
@@ -247,6 +400,17 @@ FPDF_LoadDocument(FPDF_STRING file_path, FPDF_BYTESTRING password)
                             password);
 }
 
+FPDF_EXPORT FPDF_DOCUMENT FPDF_CALLCONV
+FPDF_LoadMappedDocument(FPDF_STRING file_path, FPDF_BYTESTRING password)
+{
+    RetainPtr<IFX_SeekableReadStream> pFileAccess =
+        CFX_MemoryMappedFile::Create(file_path);
+    if (!pFileAccess)
+        return FPDF_LoadDocument(file_path, password);
+
+    return LoadDocumentImpl(pFileAccess, password);
+}
+
 FPDF_EXPORT int FPDF_CALLCONV FPDF_GetFormType(FPDF_DOCUMENT document)
 {
     const CPDF_Document *pDoc = CPDFDocumentFromFPDFDocument(document);
@@ -63,6 +63,9 @@ typedef struct _IFSDK_PAUSE {
 //          size_x       -   Horizontal size (in pixels) for displaying the
 //                           page.
 //          size_y       -   Vertical size (in pixels) for displaying the page.
+//          src_size_w   -   Horizontal size (in pixels) of the whole page, the
+//                           display area is a slice of it.
+//          src_size_h   -   Vertical size (in pixels) of the whole page.
 //          rotate       -   Page orientation: 0 (normal), 1 (rotated 90
 //                           degrees clockwise), 2 (rotated 180 degrees),
 //                           3 (rotated 90 degrees counter-clockwise).
@@ -86,6 +89,8 @@ FPDF_RenderPageBitmapWithColorScheme_Start(FPDF_BITMAP bitmap,
                                            int start_y,
                                            int size_x,
                                            int size_y,
+                                           int src_size_w,
+                                           int src_size_h,
                                            int rotate,
                                            int flags,
                                            const FPDF_COLORSCHEME* color_scheme,
@@ -105,6 +110,9 @@ FPDF_RenderPageBitmapWithColorScheme_Start(FPDF_BITMAP bitmap,
 //                          coordinates.
 //          size_x      -   Horizontal size (in pixels) for displaying the page.
 //          size_y      -   Vertical size (in pixels) for displaying the page.
+//          src_size_w  -   Horizontal size (in pixels) of the whole page, the
+//                          display area is a slice of it.
+//          src_size_h  -   Vertical size (in pixels) of the whole page.
 //          rotate      -   Page orientation: 0 (normal), 1 (rotated 90 degrees
 //                          clockwise), 2 (rotated 180 degrees), 3 (rotated 90
 //                          degrees counter-clockwise).
@@ -124,6 +132,8 @@ FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
                                                           int start_y,
                                                           int size_x,
                                                           int size_y,
+                                                          int src_size_w,
+                                                          int src_size_h,
                                                           int rotate,
                                                           int flags,
                                                           IFSDK_PAUSE* pause);
@@ -142,6 +152,16 @@ FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPageBitmap_Start(FPDF_BITMAP bitmap,
 FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPage_Continue(FPDF_PAGE page,
                                                        IFSDK_PAUSE* pause);
 
+// Function: FPDF_RenderPage_GetProgress
+//          Get the progress of a progressive rendering started by
+//          FPDF_RenderPageBitmap_Start().
+// Parameters:
+//          page        -   Handle to the page, as returned by FPDF_LoadPage().
+// Return value:
+//          Percentage (0-100) of the page objects already rendered, or -1 if
+//          no progressive rendering is in progress on |page|.
+FPDF_EXPORT int FPDF_CALLCONV FPDF_RenderPage_GetProgress(FPDF_PAGE page);
+
 // Function: FPDF_RenderPage_Close
 //          Release the resource allocate during page rendering. Need to be
 //          called after finishing rendering or
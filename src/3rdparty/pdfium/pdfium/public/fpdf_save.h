@@ -78,6 +78,60 @@ FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                      FPDF_DWORD flags,
                      int fileVersion);
 
+// Position of the last update section of a file being saved incrementally.
+typedef struct FPDF_INCREMENTAL_UPDATE_ {
+  // Size of the file the next update section is appended to.
+  long long file_size;
+  // Offset of the cross-reference section the next update refers to as /Prev.
+  long long xref_offset;
+  // Highest object number the file already holds. Objects numbered above it
+  // were created since and are written by the next update.
+  unsigned int last_objnum;
+} FPDF_INCREMENTAL_UPDATE;
+
+// Function: FPDF_InitIncrementalUpdate
+//          Initializes |update| for the file the document was loaded from.
+// Parameters:
+//          document        -   Handle to document, as returned by
+//                              FPDF_LoadDocument() or similar.
+//          update          -   Receives the size, last cross-reference
+//                              offset and last object number of the loaded
+//                              file.
+// Return value:
+//          TRUE if succeed, FALSE if the document can not be updated
+//          incrementally, e.g. it was created in memory, was repaired while
+//          loading or uses a cross-reference stream.
+//
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_InitIncrementalUpdate(FPDF_DOCUMENT document,
+                           FPDF_INCREMENTAL_UPDATE* update);
+
+// Function: FPDF_SaveIncrementalUpdate
+//          Writes only an incremental update section, to be appended to the
+//          end of the file described by |update|. The section holds the
+//          objects created since |update| was last advanced, plus the page
+//          dictionaries, annotation arrays, annotations, appearance streams
+//          and pop-up annotations of |page_indices|.
+// Parameters:
+//          document        -   Handle to document.
+//          pFileWrite      -   A pointer to a custom file write structure,
+//                              positioned at |update->file_size|.
+//          page_indices    -   Indices of the pages whose annotations
+//                              changed, may be NULL if |page_count| is 0.
+//          page_count      -   Number of entries in |page_indices|.
+//          update          -   On input, the file the section is appended
+//                              to. On success, advanced past the new section
+//                              so that further updates can be chained.
+// Return value:
+//          TRUE if succeed, FALSE if failed.
+//
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SaveIncrementalUpdate(FPDF_DOCUMENT document,
+                           FPDF_FILEWRITE* pFileWrite,
+                           const int* page_indices,
+                           int page_count,
+                           FPDF_INCREMENTAL_UPDATE* update);
+
 #ifdef __cplusplus
 }
 #endif
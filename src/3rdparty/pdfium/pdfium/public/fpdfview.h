@@ -362,6 +362,22 @@ FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_SetPrintMode(int mode);
 FPDF_EXPORT FPDF_DOCUMENT FPDF_CALLCONV
 FPDF_LoadDocument(FPDF_STRING file_path, FPDF_BYTESTRING password);
 
+// Function: FPDF_LoadMappedDocument
+//          Open and load a PDF document by mapping the file into memory.
+// Parameters:
+//          file_path   -   Path to the PDF file (including extension).
+//          password    -   A string used as the password for the PDF file.
+//                          If no password is needed, empty or NULL can be used.
+// Return value:
+//          A handle to the loaded document, or NULL on failure.
+// Comments:
+//          Same as FPDF_LoadDocument(), but the parser reads from a read-only
+//          shared mapping instead of issuing lseek()/read() for every buffer
+//          refill. Falls back to FPDF_LoadDocument() if the file can not be
+//          mapped. The file must not be truncated while the document is open.
+FPDF_EXPORT FPDF_DOCUMENT FPDF_CALLCONV
+FPDF_LoadMappedDocument(FPDF_STRING file_path, FPDF_BYTESTRING password);
+
 // Function: FPDF_LoadMemDocument
 //          Open and load a PDF document from memory.
 // Parameters:
@@ -764,6 +780,74 @@ FPDF_EXPORT int FPDF_CALLCONV FPDF_GetPageSizeByIndex(FPDF_DOCUMENT document,
                                                       double *width,
                                                       double *height);
 
+// Experimental API.
+// Function: FPDF_GetPageSizes
+//          Get the sizes and rotations of all pages in one walk of the page
+//          tree, resolving inherited MediaBox, CropBox and Rotate. No page
+//          object is created.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          sizes       -   Array of |count| FS_SIZEF to receive the page sizes
+//                          (in points), same as FPDF_GetPageSizeByIndexF().
+//                          May be NULL.
+//          rotations   -   Array of |count| ints to receive the page
+//                          rotations, same as FPDFPage_GetRotation().
+//                          May be NULL.
+//          count       -   Number of entries in |sizes| and |rotations|.
+// Return value:
+//          Number of pages found in the page tree, only the first |count|
+//          are filled. -1 for error, e.g. a page tree that is too deep or
+//          contains cycles; use FPDF_GetPageSizeByIndexF() in that case.
+FPDF_EXPORT int FPDF_CALLCONV FPDF_GetPageSizes(FPDF_DOCUMENT document,
+                                                FS_SIZEF *sizes,
+                                                int *rotations,
+                                                int count);
+
+// Statistics of the decoded images a document shares between its pages.
+typedef struct _FPDF_IMAGE_CACHE_STATS_ {
+    // Number of decoded images held.
+    unsigned long entries;
+    // Bytes held by the decoded images.
+    unsigned long usage;
+    // Byte budget, see FPDF_SetImageCacheBudget().
+    unsigned long budget;
+    // Number of image draws served without decoding.
+    unsigned long hits;
+    // Number of image draws that had to decode.
+    unsigned long misses;
+    // Number of decoded images dropped to stay within the budget.
+    unsigned long evictions;
+} FPDF_IMAGE_CACHE_STATS;
+
+// Experimental API.
+// Function: FPDF_SetImageCacheBudget
+//          Set how many bytes of decoded images the document keeps for reuse
+//          by all of its pages, so that an image drawn on many pages is
+//          decoded once. The least recently used images are dropped first.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          bytes       -   The budget in bytes. 0 disables the cache.
+// Return value:
+//          None.
+// Note:
+//          Unlike the render cache of a page, decoded images stay in this
+//          cache after FPDF_ClosePage().
+FPDF_EXPORT void FPDF_CALLCONV FPDF_SetImageCacheBudget(FPDF_DOCUMENT document,
+                                                        unsigned long bytes);
+
+// Experimental API.
+// Function: FPDF_GetImageCacheStats
+//          Get the statistics of the decoded images the document shares
+//          between its pages.
+// Parameters:
+//          document    -   Handle to document. Returned by FPDF_LoadDocument.
+//          stats       -   Pointer to a FPDF_IMAGE_CACHE_STATS to receive the
+//                          statistics.
+// Return value:
+//          TRUE on success, FALSE if |document| or |stats| is NULL.
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS *stats);
+
 // Page rendering flags. They can be combined with bit-wise OR.
 //
 // Set if annotations are to be rendered.
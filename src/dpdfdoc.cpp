@@ -1,19 +1,57 @@
 #include "dpdfdoc.h"
+#include "dpdfdoc_p.h"
 #include "dpdfpage.h"
+#include "dpdfpage_p.h"
+#include "dpdfrendertask_p.h"
+#include "dpdfsearchtask.h"
+#include "dpdfsearchtask_p.h"
+#include "dpdfpatternmatcher.h"
+#include "dpdftextexporter.h"
 
 #include "public/fpdfview.h"
 #include "public/fpdf_doc.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdf_save.h"
+#include "public/fpdf_text.h"
 
 #include "core/fpdfdoc/cpdf_bookmark.h"
 #include "core/fpdfdoc/cpdf_bookmarktree.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfdoc/cpdf_pagelabel.h"
+#include "core/fpdftext/cpdf_textpage.h"
 
 #include <QFile>
-#include <QTemporaryDir>
-#include <QUuid>
+#include <QFileInfo>
+#include <QIODevice>
+#include <QRunnable>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace {
+
+class DPdfBackgroundJob : public QRunnable
+{
+public:
+    explicit DPdfBackgroundJob(const std::function<void()> &build) : m_build(build)
+    {
+    }
+
+    void run() override
+    {
+        m_build();
+    }
+
+private:
+    std::function<void()> m_build;
+};
+
+}
 
 DPdfDoc::Status parseError(int error)
 {
@@ -39,79 +77,712 @@ DPdfDoc::Status parseError(int error)
     return err_code;
 }
 
-class DPdfDocPrivate
+//已解析页面缓存的默认内存预算
+static const qint64 defaultPageCacheBudget = 256 * 1024 * 1024;
+
+//同时保留文本页的默认页面数 覆盖翻页时前后几页的选择和搜索
+static const int defaultTextPageCacheLimit = 16;
+
+//文档级解码图片缓存的默认内存预算 足够保留各页重复使用的徽标,背景等图片
+static const qint64 defaultImageCacheBudget = 64 * 1024 * 1024;
+
+DPdfDocPrivate::DPdfDocPrivate(DPdfDoc *q)
+    : q_ptr(q), m_mutex(QMutex::Recursive)
+{
+    m_docHandler = nullptr;
+    m_pageCount = 0;
+    m_status = DPdfDoc::NOT_LOADED;
+    m_pageCacheBudget = defaultPageCacheBudget;
+    m_textPageCacheLimit = defaultTextPageCacheLimit;
+    m_imageCacheBudget = defaultImageCacheBudget;
+    m_renderPool.setMaxThreadCount(1);
+    m_indexPool.setMaxThreadCount(1);
+    m_sizePool.setMaxThreadCount(1);
+}
+
+DPdfDocPrivate::~DPdfDocPrivate()
+{
+    //渲染,搜索和索引线程需要文档锁,必须在加锁前结束
+    cancelRenderTasks();
+
+    cancelSearchTasks();
+
+    cancelTextIndex();
+
+    //m_indexCancelled已置位,未开始的页面大小任务直接返回
+    m_sizePool.waitForDone();
+
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::~DPdfDocPrivate()");
+
+    qDeleteAll(m_pages);
+
+    if (nullptr != m_docHandler)
+        FPDF_CloseDocument(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler));
+
+    //文档读取数据依赖m_avail,需在文档关闭后释放
+    if (nullptr != m_avail)
+        FPDFAvail_Destroy(m_avail);
+}
+
+DPdfDoc::Status DPdfDocPrivate::loadFile(const QString &filePath, const QString &password, DPdfDoc::LoadMode mode)
+{
+    m_filePath = filePath;
+
+    m_pages.clear();
+
+    if (!QFile::exists(m_filePath)) {
+        m_status = DPdfDoc::FILE_NOT_FOUND_ERROR;
+        return m_status;
+    }
+
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::loadFile");
+
+    void *ptr = nullptr;
+
+    if (DPdfDoc::MAPPED_FILE == mode)
+        ptr = FPDF_LoadMappedDocument(m_filePath.toUtf8().constData(), password.toUtf8().constData());
+    else
+        ptr = FPDF_LoadDocument(m_filePath.toUtf8().constData(), password.toUtf8().constData());
+
+    return setDocument(ptr);
+}
+
+DPdfDoc::Status DPdfDocPrivate::loadData(const QByteArray &data, const QString &password)
+{
+    m_data = data;
+
+    m_pages.clear();
+
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::loadData");
+
+    void *ptr = FPDF_LoadMemDocument64(m_data.constData(), static_cast<size_t>(m_data.size()), password.toUtf8().constData());
+
+    return setDocument(ptr);
+}
+
+static int readDeviceBlock(void *param, unsigned long position, unsigned char *pBuf, unsigned long size)
+{
+    QIODevice *device = static_cast<QIODevice *>(param);
+
+    if (!device->seek(static_cast<qint64>(position)))
+        return 0;
+
+    return device->read(reinterpret_cast<char *>(pBuf), static_cast<qint64>(size)) == static_cast<qint64>(size);
+}
+
+DPdfDoc::Status DPdfDocPrivate::loadDevice(QIODevice *device, const QString &password)
+{
+    m_pages.clear();
+
+    if (nullptr == device || !device->isReadable()) {
+        m_status = DPdfDoc::FILE_ERROR;
+        return m_status;
+    }
+
+    //顺序设备无法随机读取,只能先读入内存
+    if (device->isSequential())
+        return loadData(device->readAll(), password);
+
+    m_device = device;
+
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::loadDevice");
+
+    FPDF_FILEACCESS fileAccess;
+    fileAccess.m_FileLen = static_cast<unsigned long>(m_device->size());
+    fileAccess.m_GetBlock = readDeviceBlock;
+    fileAccess.m_Param = m_device;
+
+    //pdfium会拷贝fileAccess,回调只在持有文档锁时发生
+    void *ptr = FPDF_LoadCustomDocument(&fileAccess, password.toUtf8().constData());
+
+    return setDocument(ptr);
+}
+
+FPDF_BOOL DPdfDocPrivate::isAvailDataAvail(FX_FILEAVAIL *pThis, size_t offset, size_t size)
+{
+    return static_cast<DPdfFileAvail *>(pThis)->doc->isDataAvail(static_cast<qint64>(offset), static_cast<qint64>(size));
+}
+
+void DPdfDocPrivate::addAvailSegment(FX_DOWNLOADHINTS *pThis, size_t offset, size_t size)
+{
+    static_cast<DPdfDownloadHints *>(pThis)->doc->m_requestedSegments.append(qMakePair(static_cast<qint64>(offset), static_cast<qint64>(size)));
+}
+
+int DPdfDocPrivate::readAvailBlock(void *param, unsigned long position, unsigned char *pBuf, unsigned long size)
+{
+    DPdfDocPrivate *doc = static_cast<DPdfDocPrivate *>(param);
+
+    if (!doc->isDataAvail(static_cast<qint64>(position), static_cast<qint64>(size)))
+        return 0;
+
+    memcpy(pBuf, doc->m_data.constData() + position, size);
+
+    return 1;
+}
+
+DPdfDoc::Status DPdfDocPrivate::startProgressive(qint64 totalSize, const QString &password)
+{
+    m_pages.clear();
+
+    //数据保存在QByteArray中,大小受int限制
+    if (totalSize <= 0 || totalSize > INT_MAX) {
+        m_status = DPdfDoc::FILE_ERROR;
+        return m_status;
+    }
+
+    m_data.resize(static_cast<int>(totalSize));
+
+    m_password = password;
+
+    m_fileAvail.version = 1;
+    m_fileAvail.IsDataAvail = isAvailDataAvail;
+    m_fileAvail.doc = this;
+
+    m_downloadHints.version = 1;
+    m_downloadHints.AddSegment = addAvailSegment;
+    m_downloadHints.doc = this;
+
+    m_fileAccess.m_FileLen = static_cast<unsigned long>(totalSize);
+    m_fileAccess.m_GetBlock = readAvailBlock;
+    m_fileAccess.m_Param = this;
+
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::startProgressive");
+
+    m_avail = FPDFAvail_Create(&m_fileAvail, &m_fileAccess);
+
+    m_status = DPdfDoc::NOT_LOADED;
+
+    return m_status;
+}
+
+bool DPdfDocPrivate::addData(qint64 offset, const QByteArray &data, QList<int> &newPages)
+{
+    if (nullptr == m_avail || offset < 0 || data.isEmpty() || offset + data.size() > m_data.size())
+        return false;
+
+    memcpy(m_data.data() + offset, data.constData(), static_cast<size_t>(data.size()));
+
+    //合并到已到达范围
+    qint64 start = offset;
+    qint64 end = offset + data.size();
+
+    auto it = m_receivedRanges.upperBound(start);
+    if (it != m_receivedRanges.begin()) {
+        auto prev = it - 1;
+        if (prev.value() >= start) {
+            start = prev.key();
+            end = qMax(end, prev.value());
+            it = m_receivedRanges.erase(prev);
+        }
+    }
+
+    while (it != m_receivedRanges.end() && it.key() <= end) {
+        end = qMax(end, it.value());
+        it = m_receivedRanges.erase(it);
+    }
+
+    m_receivedRanges.insert(start, end);
+
+    bool loaded = false;
+
+    if (nullptr == m_docHandler && DPdfDoc::NOT_LOADED == m_status) {
+        int avail = FPDFAvail_IsDocAvail(m_avail, &m_downloadHints);
+
+        if (PDF_DATA_AVAIL == avail) {
+            setDocument(FPDFAvail_GetDocument(m_avail, m_password.toUtf8().constData()));
+            m_availablePages.fill(false, m_pageCount);
+            loaded = true;
+        } else if (PDF_DATA_ERROR == avail) {
+            m_status = DPdfDoc::FORMAT_ERROR;
+            loaded = true;
+        }
+    }
+
+    if (nullptr == m_docHandler)
+        return loaded;
+
+    auto check = [this, &newPages](int index) {
+        if (index < 0 || index >= m_pageCount || m_availablePages[index])
+            return index >= 0 && index < m_pageCount;
+
+        if (checkPageAvail(index))
+            newPages.append(index);
+
+        return m_availablePages[index];
+    };
+
+    //线性化文档的首页最先到达,其余页面按顺序检查到第一个未到达的页面,任意页面可通过isPageAvailable()单独查询
+    check(FPDFAvail_GetFirstPageNum(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler)));
+
+    for (int i = 0; i < m_pageCount; ++i) {
+        if (!check(i))
+            break;
+    }
+
+    return loaded;
+}
+
+bool DPdfDocPrivate::isDataAvail(qint64 offset, qint64 size) const
+{
+    auto it = m_receivedRanges.upperBound(offset);
+    if (it == m_receivedRanges.begin())
+        return false;
+
+    --it;
+
+    return it.value() >= offset + size;
+}
+
+bool DPdfDocPrivate::checkPageAvail(int index)
+{
+    if (nullptr == m_avail)
+        return true;
+
+    if (nullptr == m_docHandler || index < 0 || index >= m_availablePages.size())
+        return false;
+
+    if (!m_availablePages[index])
+        m_availablePages[index] = (PDF_DATA_AVAIL == FPDFAvail_IsPageAvail(m_avail, index, &m_downloadHints));
+
+    return m_availablePages[index];
+}
+
+bool DPdfDocPrivate::cachePageSizes()
+{
+    if (nullptr == m_docHandler)
+        return false;
+
+    if (m_pageSizes.size() == m_pageCount)
+        return true;
+
+    //渐进加载时页面树可能未全部到达,只在所有页面可用后遍历,不为此请求数据
+    if (nullptr != m_avail && m_availablePages.contains(false))
+        return false;
+
+    FPDF_DOCUMENT doc = reinterpret_cast<FPDF_DOCUMENT>(m_docHandler);
+
+    std::vector<FS_SIZEF> sizes(static_cast<size_t>(m_pageCount));
+
+    QVector<int> rotations(m_pageCount, 0);
+
+    const int count = FPDF_GetPageSizes(doc, sizes.data(), rotations.data(), m_pageCount);
+
+    QVector<QSizeF> pageSizes(m_pageCount);
+
+    if (count == m_pageCount) {
+        for (int i = 0; i < m_pageCount; ++i)
+            pageSizes[i] = QSizeF(static_cast<qreal>(sizes[i].width), static_cast<qreal>(sizes[i].height));
+    } else {
+        //页面树损坏时pdfium按修复后的页面索引,与遍历结果不一致,逐页获取
+        for (int i = 0; i < m_pageCount; ++i) {
+            FS_SIZEF size = {0, 0};
+
+            if (FPDF_GetPageSizeByIndexF(doc, i, &size))
+                pageSizes[i] = QSizeF(static_cast<qreal>(size.width), static_cast<qreal>(size.height));
+
+            FPDF_PAGE page = FPDF_LoadNoParsePage(doc, i);
+
+            rotations[i] = (nullptr != page) ? FPDFPage_GetRotation(page) : 0;
+
+            FPDF_ClosePage(page);
+        }
+    }
+
+    m_pageSizes = pageSizes;
+
+    m_pageRotations = rotations;
+
+    return true;
+}
+
+bool DPdfDocPrivate::pageSize(int index, QSizeF &size, int &rotation)
+{
+    if (nullptr == m_docHandler || index < 0 || index >= m_pageCount)
+        return false;
+
+    if (index < m_pageSizes.size()) {
+        size = m_pageSizes[index];
+        rotation = m_pageRotations[index];
+        return true;
+    }
+
+    FPDF_DOCUMENT doc = reinterpret_cast<FPDF_DOCUMENT>(m_docHandler);
+
+    FS_SIZEF pageSize = {0, 0};
+
+    if (!FPDF_GetPageSizeByIndexF(doc, index, &pageSize))
+        return false;
+
+    size = QSizeF(static_cast<qreal>(pageSize.width), static_cast<qreal>(pageSize.height));
+
+    FPDF_PAGE page = FPDF_LoadNoParsePage(doc, index);
+
+    rotation = (nullptr != page) ? FPDFPage_GetRotation(page) : 0;
+
+    FPDF_ClosePage(page);
+
+    return true;
+}
+
+bool DPdfDocPrivate::isPageDataAvail(int index)
+{
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::isPageDataAvail index = " + QString::number(index));
+
+    return checkPageAvail(index);
+}
+
+bool DPdfDocPrivate::extractPageText(int index, qreal xRes, qreal yRes, QString &text, QVector<QRectF> *rects, QSizeF *size)
+{
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::extractPageText index = " + QString::number(index));
+
+    if (nullptr == m_docHandler || !checkPageAvail(index))
+        return false;
+
+    FPDF_PAGE page = FPDF_LoadPage(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler), index);
+
+    if (nullptr == page)
+        return false;
+
+    FPDF_TEXTPAGE textPage = FPDFText_LoadPage(page);
+
+    if (nullptr == textPage) {
+        FPDF_ClosePage(page);
+        return false;
+    }
+
+    const CPDF_TextPage *pdfiumTextPage = reinterpret_cast<CPDF_TextPage *>(textPage);
+
+    const qreal height = static_cast<qreal>(FPDF_GetPageHeightF(page));
+
+    if (nullptr != size)
+        *size = QSizeF(static_cast<qreal>(FPDF_GetPageWidthF(page)) * xRes / 72, height * yRes / 72);
+
+    QVector<int> charIndices;
+
+    text = pageText(pdfiumTextPage, charIndices);
+
+    if (nullptr != rects) {
+        rects->resize(text.size());
+
+        for (int i = 0; i < text.size(); ++i) {
+            if (charIndices[i] < 0)
+                continue;
+
+            const CFX_FloatRect &box = pdfiumTextPage->GetCharInfo(static_cast<size_t>(charIndices[i])).m_CharBox;
+            (*rects)[i] = QRectF(static_cast<qreal>(box.left) * xRes / 72,
+                                 (height - static_cast<qreal>(box.top)) * yRes / 72,
+                                 static_cast<qreal>(box.right - box.left) * xRes / 72,
+                                 static_cast<qreal>(box.top - box.bottom) * yRes / 72);
+        }
+    }
+
+    FPDFText_ClosePage(textPage);
+
+    FPDF_ClosePage(page);
+
+    return true;
+}
+
+QString DPdfDocPrivate::pageText(const CPDF_TextPage *textPage, QVector<int> &charIndices)
+{
+    //文本缓冲的下标即CharInfo::m_Index,控制字符不在其中
+    const WideString buffer = textPage->GetAllPageText();
+
+    const int length = static_cast<int>(buffer.GetLength());
+
+    QString text;
+    text.reserve(length);
+
+    charIndices.clear();
+    charIndices.reserve(length);
+
+    for (int i = 0; i < length; ++i) {
+        const int charIndex = textPage->CharIndexFromSearchIndex(i);
+
+        uint unicode = static_cast<uint>(buffer[static_cast<size_t>(i)]);
+
+        if (unicode > 0x10FFFF)
+            unicode = QChar::ReplacementCharacter;
+
+        if (QChar::requiresSurrogates(unicode)) {
+            text.append(QChar(QChar::highSurrogate(unicode)));
+            text.append(QChar(QChar::lowSurrogate(unicode)));
+            charIndices.append(charIndex);
+            charIndices.append(charIndex);
+        } else {
+            text.append(QChar(static_cast<ushort>(unicode)));
+            charIndices.append(charIndex);
+        }
+    }
+
+    return text;
+}
+
+QList<QPair<qint64, qint64>> DPdfDocPrivate::takeRequestedSegments()
+{
+    QList<QPair<qint64, qint64>> segments;
+
+    segments.swap(m_requestedSegments);
+
+    return segments;
+}
+
+DPdfDoc::Status DPdfDocPrivate::setDocument(void *doc)
+{
+    m_docHandler = static_cast<DPdfDocHandler *>(doc);
+
+    m_status = m_docHandler ? DPdfDoc::SUCCESS : parseError(static_cast<int>(FPDF_GetLastError()));
+
+    if (m_docHandler) {
+        m_pageCount = FPDF_GetPageCount(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler));
+        m_pages.fill(nullptr, m_pageCount);
+
+        FPDF_SetImageCacheBudget(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler), static_cast<unsigned long>(m_imageCacheBudget));
+    }
+
+    return m_status;
+}
+
+void DPdfDocPrivate::touchPage(DPdfPagePrivate *page)
+{
+    const qint64 cost = page->parsedCost();
+
+    auto it = m_pageCacheEntries.find(page);
+    if (it == m_pageCacheEntries.end()) {
+        m_pageLru.push_front(page);
+        m_pageCacheEntries.insert(page, PageCacheEntry{m_pageLru.begin(), cost});
+    } else {
+        m_pageLru.splice(m_pageLru.begin(), m_pageLru, it->pos);
+        m_pageCacheUsage -= it->cost;
+        it->cost = cost;
+    }
+
+    m_pageCacheUsage += cost;
+
+    shrinkPageCache(page);
+}
+
+void DPdfDocPrivate::removePage(DPdfPagePrivate *page)
+{
+    auto it = m_pageCacheEntries.find(page);
+    if (it == m_pageCacheEntries.end())
+        return;
+
+    m_pageCacheUsage -= it->cost;
+    m_pageLru.erase(it->pos);
+    m_pageCacheEntries.erase(it);
+}
+
+void DPdfDocPrivate::updatePageCost(DPdfPagePrivate *page)
+{
+    auto it = m_pageCacheEntries.find(page);
+    if (it == m_pageCacheEntries.end())
+        return;
+
+    const qint64 cost = page->parsedCost();
+
+    m_pageCacheUsage += cost - it->cost;
+    it->cost = cost;
+}
+
+void DPdfDocPrivate::touchTextPage(DPdfPagePrivate *page)
+{
+    auto it = std::find(m_textPageLru.begin(), m_textPageLru.end(), page);
+    if (it == m_textPageLru.end())
+        m_textPageLru.push_front(page);
+    else
+        m_textPageLru.splice(m_textPageLru.begin(), m_textPageLru, it);
+
+    shrinkTextPageCache(page);
+}
+
+void DPdfDocPrivate::removeTextPage(DPdfPagePrivate *page)
+{
+    m_textPageLru.remove(page);
+}
+
+void DPdfDocPrivate::shrinkTextPageCache(DPdfPagePrivate *keep)
+{
+    //数量上限较小,线性查找即可
+    while (static_cast<int>(m_textPageLru.size()) > qMax(1, m_textPageCacheLimit)) {
+        DPdfPagePrivate *page = m_textPageLru.back();
+        if (page == keep)
+            break;
+
+        page->releaseTextPage();
+    }
+}
+
+void DPdfDocPrivate::shrinkPageCache(DPdfPagePrivate *keep)
+{
+    //正在使用的页面始终保留,即使其自身超出预算
+    while (!m_pageLru.empty() && (m_pageCacheUsage > m_pageCacheBudget
+                                  || (m_pageCacheLimit > 0 && static_cast<int>(m_pageLru.size()) > m_pageCacheLimit))) {
+        DPdfPagePrivate *page = m_pageLru.back();
+        if (page == keep)
+            break;
+
+        removePage(page);
+        page->releaseParsedPage();
+
+        ++m_pageCacheEvictions;
+    }
+}
+
+void DPdfDocPrivate::startRenderTask(DPdfRenderTaskPrivate *task)
+{
+    QMutexLocker locker(&m_renderTasksMutex);
+
+    m_renderTasks.insert(task);
+
+    m_renderPool.start(task);
+}
+
+void DPdfDocPrivate::removeRenderTask(DPdfRenderTaskPrivate *task)
+{
+    QMutexLocker locker(&m_renderTasksMutex);
+
+    m_renderTasks.remove(task);
+}
+
+void DPdfDocPrivate::cancelRenderTasks()
+{
+    QMutexLocker locker(&m_renderTasksMutex);
+
+    for (DPdfRenderTaskPrivate *task : m_renderTasks)
+        task->cancel();
+
+    locker.unlock();
+
+    m_renderPool.waitForDone();
+
+    //与任务析构时的移除互斥,加锁顺序与之相同
+    QMutexLocker detachLocker(DPdfRenderTaskPrivate::detachMutex());
+
+    locker.relock();
+
+    //任务可能比文档存活更久,断开与文档和页面的关联
+    for (DPdfRenderTaskPrivate *task : m_renderTasks)
+        task->detach();
+
+    m_renderTasks.clear();
+}
+
+void DPdfDocPrivate::startSearchTask(DPdfSearchTaskPrivate *task)
 {
-    friend class DPdfDoc;
-public:
-    DPdfDocPrivate();
+    QMutexLocker locker(&m_searchTasksMutex);
 
-    ~DPdfDocPrivate();
+    m_searchTasks.insert(task);
 
-public:
-    DPdfDoc::Status loadFile(const QString &filePath, const QString &password);
+    task->start();
+}
 
-private:
-    DPdfDocHandler *m_docHandler;
+void DPdfDocPrivate::removeSearchTask(DPdfSearchTaskPrivate *task)
+{
+    QMutexLocker locker(&m_searchTasksMutex);
+
+    m_searchTasks.remove(task);
+}
 
-    QVector<DPdfPage *> m_pages;
+void DPdfDocPrivate::cancelSearchTasks()
+{
+    //持有期间任务不会析构,与DPdfSearchTask析构函数的加锁顺序一致
+    QMutexLocker detachLocker(DPdfSearchTaskPrivate::detachMutex());
 
-    QString m_filePath;
+    QMutexLocker locker(&m_searchTasksMutex);
 
-    int m_pageCount = 0;
+    const QSet<DPdfSearchTaskPrivate *> tasks = m_searchTasks;
 
-    DPdfDoc::Status m_status;
-};
+    m_searchTasks.clear();
 
-DPdfDocPrivate::DPdfDocPrivate()
-{
-    m_docHandler = nullptr;
-    m_pageCount = 0;
-    m_status = DPdfDoc::NOT_LOADED;
+    locker.unlock();
+
+    //任务可能比文档存活更久,断开与文档的关联
+    for (DPdfSearchTaskPrivate *task : tasks)
+        task->cancel();
+
+    for (DPdfSearchTaskPrivate *task : tasks)
+        task->detach();
 }
 
-DPdfDocPrivate::~DPdfDocPrivate()
+void DPdfDocPrivate::buildTextIndex(DPdfDoc *q, const QString &indexPath, const DPdfTextIndex::Key &key)
 {
-    DPdfMutexLocker locker("DPdfDocPrivate::~DPdfDocPrivate()");
+    QSharedPointer<DPdfTextIndex> index(new DPdfTextIndex(m_pageCount));
 
-    qDeleteAll(m_pages);
+    QString text;
 
-    if (nullptr != m_docHandler)
-        FPDF_CloseDocument(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler));
+    //每页单独加锁,建立索引期间不影响渲染
+    for (int i = 0; i < m_pageCount && !m_indexCancelled.load(); ++i) {
+        if (extractPageText(i, 72, 72, text, nullptr))
+            index->addPage(i, text);
+    }
+
+    //发布后只读,查询用的词表在此建立
+    if (!m_indexCancelled.load())
+        index->buildVocabulary();
+
+    QMutexLocker locker(&m_textIndexMutex);
+
+    m_textIndexBuilding = false;
+
+    if (m_indexCancelled.load())
+        return;
+
+    m_textIndex = index;
+
+    locker.unlock();
+
+    //渐进加载时未到达的页面不在索引中,这样的索引不保存
+    if (!indexPath.isEmpty() && index->isComplete())
+        index->save(indexPath, key);
+
+    QMetaObject::invokeMethod(q, [q]() {
+        emit q->textIndexReady();
+    }, Qt::QueuedConnection);
 }
 
-DPdfDoc::Status DPdfDocPrivate::loadFile(const QString &filePath, const QString &password)
+QVector<bool> DPdfDocPrivate::candidatePages(const QString &text)
 {
-    m_filePath = filePath;
+    QMutexLocker locker(&m_textIndexMutex);
 
-    m_pages.clear();
+    QSharedPointer<DPdfTextIndex> index = m_textIndex;
 
-    if (!QFile::exists(m_filePath)) {
-        m_status = DPdfDoc::FILE_NOT_FOUND_ERROR;
-        return m_status;
-    }
+    locker.unlock();
 
-    DPdfMutexLocker locker("DPdfDocPrivate::loadFile");
+    if (index.isNull())
+        return QVector<bool>();
 
-    void *ptr = FPDF_LoadDocument(m_filePath.toUtf8().constData(),
-                                  password.toUtf8().constData());
+    return index->candidatePages(text);
+}
 
-    m_docHandler = static_cast<DPdfDocHandler *>(ptr);
+void DPdfDocPrivate::cancelTextIndex()
+{
+    m_indexCancelled.store(1);
 
-    m_status = m_docHandler ? DPdfDoc::SUCCESS : parseError(static_cast<int>(FPDF_GetLastError()));
+    m_indexPool.waitForDone();
+}
 
-    if (m_docHandler) {
-        m_pageCount = FPDF_GetPageCount(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler));
-        m_pages.fill(nullptr, m_pageCount);
-    }
+DPdfDoc::DPdfDoc(QString filename, QString password, LoadMode mode)
+    : d_ptr(new DPdfDocPrivate(this))
+{
+    d_func()->loadFile(filename, password, mode);
+}
 
-    return m_status;
+DPdfDoc::DPdfDoc()
+    : d_ptr(new DPdfDocPrivate(this))
+{
 }
 
+DPdfDoc::DPdfDoc(QIODevice *device, QString password)
+    : d_ptr(new DPdfDocPrivate(this))
+{
+    d_func()->loadDevice(device, password);
+}
 
-DPdfDoc::DPdfDoc(QString filename, QString password)
-    : d_ptr(new DPdfDocPrivate())
+DPdfDoc::DPdfDoc(qint64 totalSize, QString password)
+    : d_ptr(new DPdfDocPrivate(this))
 {
-    d_func()->loadFile(filename, password);
+    d_func()->startProgressive(totalSize, password);
 }
 
 DPdfDoc::~DPdfDoc()
@@ -129,7 +800,7 @@ bool DPdfDoc::isEncrypted() const
     if (!isValid())
         return false;
 
-    DPdfMutexLocker locker("DPdfDoc::isEncrypted()");
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::isEncrypted()");
 
     return FPDF_GetDocPermissions(reinterpret_cast<FPDF_DOCUMENT>(d_func()->m_docHandler)) != 0xFFFFFFFF;
 }
@@ -142,8 +813,7 @@ DPdfDoc::Status DPdfDoc::tryLoadFile(const QString &filename, const QString &pas
         return status;
     }
 
-    DPdfMutexLocker locker("DPdfDoc::tryLoadFile");
-
+    //临时文档不与其他文档共享状态，无需加锁
     void *ptr = FPDF_LoadDocument(filename.toUtf8().constData(),
                                   password.toUtf8().constData());
 
@@ -157,77 +827,152 @@ DPdfDoc::Status DPdfDoc::tryLoadFile(const QString &filename, const QString &pas
     return status;
 }
 
-static QFile saveWriter;
+DPdfDoc *DPdfDoc::fromData(const QByteArray &data, const QString &password)
+{
+    DPdfDoc *doc = new DPdfDoc();
+
+    doc->d_func()->loadData(data, password);
+
+    return doc;
+}
 
-int writeFile(struct FPDF_FILEWRITE_* pThis, const void *pData, unsigned long size)
+int DPdfDocPrivate::writeBlock(FPDF_FILEWRITE *pThis, const void *pData, unsigned long size)
 {
-    Q_UNUSED(pThis)
-    return 0 != saveWriter.write(static_cast<char *>(const_cast<void *>(pData)), static_cast<qint64>(size));
+    QIODevice *device = static_cast<DPdfFileWrite *>(pThis)->device;
+
+    return device->write(static_cast<const char *>(pData), static_cast<qint64>(size)) == static_cast<qint64>(size);
 }
 
-bool DPdfDoc::save()
+bool DPdfDocPrivate::saveTo(QIODevice *device, unsigned long flags)
 {
-    FPDF_FILEWRITE write;
+    if (nullptr == m_docHandler)
+        return false;
 
-    write.WriteBlock = writeFile;
+    //每次保存使用独立的写入上下文,不同文档可同时保存
+    DPdfFileWrite write;
+    write.version = 1;
+    write.WriteBlock = writeBlock;
+    write.device = device;
 
-    QTemporaryDir tempDir;
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::saveTo");
 
-    QString tempFilePath = tempDir.path() + "/" + QUuid::createUuid().toString();
+    return FPDF_SaveAsCopy(reinterpret_cast<FPDF_DOCUMENT>(m_docHandler), &write, flags);
+}
 
-    saveWriter.setFileName(tempFilePath);
+bool DPdfDocPrivate::appendUpdate()
+{
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::appendUpdate");
 
-    if (!saveWriter.open(QIODevice::WriteOnly))
+    if (nullptr == m_docHandler || m_filePath.isEmpty() || m_incrementalDisabled)
         return false;
 
-    DPdfMutexLocker locker("DPdfDoc::save");
-    bool result = FPDF_SaveAsCopy(reinterpret_cast<FPDF_DOCUMENT>(d_func()->m_docHandler), &write, FPDF_NO_INCREMENTAL);
-    locker.unlock();
+    FPDF_DOCUMENT doc = reinterpret_cast<FPDF_DOCUMENT>(m_docHandler);
+
+    if (!m_incrementalInited) {
+        if (!FPDF_InitIncrementalUpdate(doc, &m_incrementalUpdate)) {
+            m_incrementalDisabled = true;
+            return false;
+        }
+
+        m_incrementalInited = true;
+    }
 
-    saveWriter.close();
+    QFile file(m_filePath);
 
-    QFile tempFile(tempFilePath);
+    //文件被外部改写,或文件头前有多余数据导致偏移不一致,无法追加
+    if (file.size() != m_incrementalUpdate.file_size) {
+        m_incrementalDisabled = true;
+        return false;
+    }
 
-    if (!tempFile.open(QIODevice::ReadOnly))
+    if (!file.open(QIODevice::ReadWrite) || !file.seek(m_incrementalUpdate.file_size))
         return false;
 
-    QByteArray array = tempFile.readAll();
+    QList<int> pages = m_modifiedPages.values();
+
+    std::sort(pages.begin(), pages.end());
 
-    tempFile.close();
+    const std::vector<int> pageIndices(pages.begin(), pages.end());
 
-    QFile file(d_func()->m_filePath);
+    DPdfFileWrite write;
+    write.version = 1;
+    write.WriteBlock = writeBlock;
+    write.device = &file;
 
-    file.remove();          //不remove会出现第二次导出丢失数据问题 (保存动作完成之后，如果当前文档是当初打开那个，下一次导出会出错)
+    FPDF_INCREMENTAL_UPDATE update = m_incrementalUpdate;
 
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    bool ok = FPDF_SaveIncrementalUpdate(doc, &write, pageIndices.data(), static_cast<int>(pageIndices.size()), &update);
+
+    ok = ok && file.flush() && file.size() == update.file_size;
+
+    if (!ok) {
+        //截掉写了一半的更新,原文件内容不受影响
+        file.resize(m_incrementalUpdate.file_size);
         return false;
+    }
+
+    m_incrementalUpdate = update;
+
+    m_modifiedPages.clear();
+
+    return true;
+}
+
+void DPdfDocPrivate::markPageModified(int index)
+{
+    m_modifiedPages.insert(index);
+}
+
+void DPdfDocPrivate::disableIncrementalSave()
+{
+    DPdfMutexLocker locker(&m_mutex, "DPdfDocPrivate::disableIncrementalSave");
 
-    if (array.size() != file.write(array))
-        result = false;
+    m_incrementalDisabled = true;
 
-    file.close();
+    m_modifiedPages.clear();
+}
+
+bool DPdfDoc::save()
+{
+    //从内存或设备打开的文档没有可覆盖的文件
+    if (d_func()->m_filePath.isEmpty())
+        return false;
 
-    return result;
+    return saveAs(d_func()->m_filePath);
 }
 
 bool DPdfDoc::saveAs(const QString &filePath)
 {
-    FPDF_FILEWRITE write;
+    //先写入同目录下的临时文件,完成后原子替换目标文件;原文件不会被原地改写,pdfium仍可从已打开的原文件按需读取
+    QSaveFile file(filePath);
 
-    write.WriteBlock = writeFile;
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
 
-    saveWriter.setFileName(filePath);
+    if (!d_func()->saveTo(&file, FPDF_NO_INCREMENTAL)) {
+        file.cancelWriting();
+        return false;
+    }
 
-    if (!saveWriter.open(QIODevice::ReadWrite))
+    if (!file.commit())
         return false;
 
-    DPdfMutexLocker locker("DPdfDoc::saveAs");
-    bool result = FPDF_SaveAsCopy(reinterpret_cast<FPDF_DOCUMENT>(d_func()->m_docHandler), &write, FPDF_NO_INCREMENTAL);
-    locker.unlock();
+    //原文件已被新内容替换,不能再在其后追加
+    if (!d_func()->m_filePath.isEmpty() && QFileInfo(filePath).absoluteFilePath() == QFileInfo(d_func()->m_filePath).absoluteFilePath())
+        d_func()->disableIncrementalSave();
+
+    return true;
+}
+
+bool DPdfDoc::saveIncremental()
+{
+    if (d_func()->m_filePath.isEmpty())
+        return false;
 
-    saveWriter.close();
+    if (d_func()->appendUpdate())
+        return true;
 
-    return result;
+    return save();
 }
 
 QString DPdfDoc::filePath() const
@@ -240,23 +985,355 @@ int DPdfDoc::pageCount() const
     return d_func()->m_pageCount;
 }
 
+QVector<QSizeF> DPdfDoc::pageSizes(qreal xRes, qreal yRes, QVector<int> *rotations)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::pageSizes");
+
+    const int pageCount = d_func()->m_pageCount;
+
+    QVector<QSizeF> sizes(pageCount);
+
+    if (nullptr != rotations)
+        rotations->fill(0, pageCount);
+
+    if (nullptr == d_func()->m_docHandler)
+        return sizes;
+
+    const bool cached = d_func()->cachePageSizes();
+
+    for (int i = 0; i < pageCount; ++i) {
+        //渐进加载时只取已到达的页面,未到达的为空
+        if (!cached && !d_func()->m_availablePages.value(i, false))
+            continue;
+
+        QSizeF size;
+        int rotation = 0;
+
+        if (!d_func()->pageSize(i, size, rotation))
+            continue;
+
+        sizes[i] = QSizeF(size.width() * xRes / 72, size.height() * yRes / 72);
+
+        if (nullptr != rotations)
+            (*rotations)[i] = rotation;
+    }
+
+    return sizes;
+}
+
+bool DPdfDoc::loadPageSizes()
+{
+    DPdfDocPrivate *d = d_func();
+
+    DPdfMutexLocker locker(&d->m_mutex, "DPdfDoc::loadPageSizes");
+
+    if (nullptr == d->m_docHandler || d->m_pageSizes.size() == d->m_pageCount)
+        return true;
+
+    if (d->m_pageSizesLoading)
+        return false;
+
+    d->m_pageSizesLoading = true;
+
+    //不与全文索引共用线程,避免排在整个文档的索引之后
+    d->m_sizePool.start(new DPdfBackgroundJob([d, this]() {
+        DPdfMutexLocker locker(&d->m_mutex, "DPdfDoc::loadPageSizes job");
+
+        d->m_pageSizesLoading = false;
+
+        if (d->m_indexCancelled.load() || !d->cachePageSizes())
+            return;
+
+        QMetaObject::invokeMethod(this, [this]() {
+            emit pageSizesReady();
+        }, Qt::QueuedConnection);
+    }));
+
+    return false;
+}
+
 DPdfDoc::Status DPdfDoc::status() const
 {
     return d_func()->m_status;
 }
 
+void DPdfDoc::setPageCacheBudget(qint64 bytes)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::setPageCacheBudget");
+
+    d_func()->m_pageCacheBudget = bytes;
+
+    d_func()->shrinkPageCache(nullptr);
+}
+
+qint64 DPdfDoc::pageCacheBudget() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::pageCacheBudget");
+
+    return d_func()->m_pageCacheBudget;
+}
+
+void DPdfDoc::setPageCacheLimit(int count)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::setPageCacheLimit");
+
+    d_func()->m_pageCacheLimit = qMax(0, count);
+
+    d_func()->shrinkPageCache(nullptr);
+}
+
+int DPdfDoc::pageCacheLimit() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::pageCacheLimit");
+
+    return d_func()->m_pageCacheLimit;
+}
+
+DPdfDoc::PageCacheStats DPdfDoc::pageCacheStats() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::pageCacheStats");
+
+    PageCacheStats stats;
+    stats.cachedPages = static_cast<int>(d_func()->m_pageLru.size());
+    stats.textPages = static_cast<int>(d_func()->m_textPageLru.size());
+    stats.usage = d_func()->m_pageCacheUsage;
+    stats.budget = d_func()->m_pageCacheBudget;
+    stats.pageLimit = d_func()->m_pageCacheLimit;
+    stats.hits = d_func()->m_pageCacheHits;
+    stats.misses = d_func()->m_pageCacheMisses;
+    stats.evictions = d_func()->m_pageCacheEvictions;
+
+    return stats;
+}
+
+void DPdfDoc::setTextPageCacheLimit(int count)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::setTextPageCacheLimit");
+
+    d_func()->m_textPageCacheLimit = count;
+
+    d_func()->shrinkTextPageCache(nullptr);
+}
+
+int DPdfDoc::textPageCacheLimit() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::textPageCacheLimit");
+
+    return d_func()->m_textPageCacheLimit;
+}
+
+void DPdfDoc::setImageCacheBudget(qint64 bytes)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::setImageCacheBudget");
+
+    d_func()->m_imageCacheBudget = qMax<qint64>(0, bytes);
+
+    if (nullptr != d_func()->m_docHandler)
+        FPDF_SetImageCacheBudget(reinterpret_cast<FPDF_DOCUMENT>(d_func()->m_docHandler), static_cast<unsigned long>(d_func()->m_imageCacheBudget));
+}
+
+qint64 DPdfDoc::imageCacheBudget() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::imageCacheBudget");
+
+    return d_func()->m_imageCacheBudget;
+}
+
+DPdfDoc::ImageCacheStats DPdfDoc::imageCacheStats() const
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::imageCacheStats");
+
+    ImageCacheStats stats;
+    stats.budget = d_func()->m_imageCacheBudget;
+
+    FPDF_IMAGE_CACHE_STATS cacheStats;
+
+    if (nullptr == d_func()->m_docHandler || !FPDF_GetImageCacheStats(reinterpret_cast<FPDF_DOCUMENT>(d_func()->m_docHandler), &cacheStats))
+        return stats;
+
+    stats.images = static_cast<int>(cacheStats.entries);
+    stats.usage = static_cast<qint64>(cacheStats.usage);
+    stats.hits = static_cast<qint64>(cacheStats.hits);
+    stats.misses = static_cast<qint64>(cacheStats.misses);
+    stats.evictions = static_cast<qint64>(cacheStats.evictions);
+
+    return stats;
+}
+
 DPdfPage *DPdfDoc::page(int i, qreal xRes, qreal yRes)
 {
     if (i < 0 || i >= d_func()->m_pageCount)
         return nullptr;
 
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::page index = " + QString::number(i));
+
+    //渐进加载时数据未到达的页面无法解析
+    if (!d_func()->checkPageAvail(i))
+        return nullptr;
+
     if (!d_func()->m_pages[i]) {
-        d_func()->m_pages[i] = new DPdfPage(d_func()->m_docHandler, i, xRes, yRes);
+        d_func()->m_pages[i] = new DPdfPage(d_func(), i, xRes, yRes);
+
+        //可能在渲染线程中创建,归属到文档所在线程
+        d_func()->m_pages[i]->moveToThread(thread());
     }
 
     return d_func()->m_pages[i];
 }
 
+bool DPdfDoc::loadTextIndex(const QString &indexDir)
+{
+    if (nullptr == d_func()->m_docHandler)
+        return false;
+
+    if (hasTextIndex())
+        return true;
+
+    QString indexPath;
+
+    DPdfTextIndex::Key key;
+
+    //从内存,设备或渐进加载打开的文档没有对应的文件,索引只保留在内存中
+    if (!indexDir.isEmpty() && !d_func()->m_filePath.isEmpty() && DPdfTextIndex::fileKey(d_func()->m_filePath, d_func()->m_pageCount, key)) {
+        indexPath = DPdfTextIndex::indexFilePath(indexDir, d_func()->m_filePath);
+
+        QSharedPointer<DPdfTextIndex> index(new DPdfTextIndex);
+
+        if (index->load(indexPath, key)) {
+            QMutexLocker locker(&d_func()->m_textIndexMutex);
+
+            d_func()->m_textIndex = index;
+
+            return true;
+        }
+    }
+
+    QMutexLocker locker(&d_func()->m_textIndexMutex);
+
+    if (d_func()->m_textIndexBuilding)
+        return false;
+
+    d_func()->m_textIndexBuilding = true;
+
+    locker.unlock();
+
+    DPdfDocPrivate *d = d_func();
+
+    d->m_indexPool.start(new DPdfBackgroundJob([d, this, indexPath, key]() {
+        d->buildTextIndex(this, indexPath, key);
+    }));
+
+    return false;
+}
+
+bool DPdfDoc::hasTextIndex() const
+{
+    QMutexLocker locker(&d_func()->m_textIndexMutex);
+
+    return !d_func()->m_textIndex.isNull();
+}
+
+DPdfSearchTask *DPdfDoc::search(const QString &text, DPdfSearchTask::Flags flags, int maxHits, qreal xRes, qreal yRes)
+{
+    if (nullptr == d_func()->m_docHandler || text.isEmpty())
+        return nullptr;
+
+    return new DPdfSearchTask(d_func(), text, flags, maxHits, xRes, yRes);
+}
+
+bool DPdfDoc::exportText(QIODevice *device, TextFormat format, qreal xRes, qreal yRes)
+{
+    if (nullptr == d_func()->m_docHandler || nullptr == device || !device->isWritable())
+        return false;
+
+    //渐进加载时未到达的页面只能导出为空页,与真正的空页无法区分,不导出
+    for (int i = 0; i < d_func()->m_pageCount; ++i) {
+        if (!d_func()->isPageDataAvail(i))
+            return false;
+    }
+
+    DPdfTextExporter exporter(d_func(), device, format, xRes, yRes);
+
+    return exporter.run();
+}
+
+DPdfSearchTask *DPdfDoc::searchPatterns(const QStringList &literals, const QStringList &regexps, DPdfSearchTask::Flags flags, int maxHits, qreal xRes, qreal yRes,
+                                        QStringList *errors)
+{
+    if (nullptr == d_func()->m_docHandler)
+        return nullptr;
+
+    //自动机和编译后的正则只建立一次,由各搜索线程共享
+    QSharedPointer<const DPdfPatternMatcher> matcher(new DPdfPatternMatcher(literals, regexps, flags));
+
+    if (nullptr != errors)
+        *errors = matcher->errors();
+
+    //写错的正则不能当作没有结果,整个搜索失败
+    if (!matcher->errors().isEmpty() || matcher->isEmpty())
+        return nullptr;
+
+    return new DPdfSearchTask(d_func(), matcher, maxHits, xRes, yRes);
+}
+
+void DPdfDoc::addData(qint64 offset, const QByteArray &data)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::addData offset = " + QString::number(offset));
+
+    QList<int> newPages;
+
+    bool isLoaded = d_func()->addData(offset, data, newPages);
+
+    Status status = d_func()->m_status;
+
+    const QList<QPair<qint64, qint64>> &segments = d_func()->takeRequestedSegments();
+
+    locker.unlock();
+
+    //信号在解锁后发出,接收者可以直接访问文档
+    if (isLoaded)
+        emit loaded(status);
+
+    for (int index : newPages)
+        emit pageAvailable(index);
+
+    for (const QPair<qint64, qint64> &segment : segments)
+        emit dataRequested(segment.first, segment.second);
+}
+
+void DPdfDoc::appendData(const QByteArray &data)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::appendData");
+
+    //顺序到达的数据紧接在从0开始的已到达范围之后
+    qint64 offset = d_func()->m_receivedRanges.value(0, 0);
+
+    locker.unlock();
+
+    addData(offset, data);
+}
+
+bool DPdfDoc::isPageAvailable(int index)
+{
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::isPageAvailable index = " + QString::number(index));
+
+    bool wasAvailable = d_func()->m_availablePages.value(index, false);
+
+    bool available = d_func()->checkPageAvail(index);
+
+    const QList<QPair<qint64, qint64>> &segments = d_func()->takeRequestedSegments();
+
+    locker.unlock();
+
+    if (available && !wasAvailable && nullptr != d_func()->m_avail)
+        emit pageAvailable(index);
+
+    for (const QPair<qint64, qint64> &segment : segments)
+        emit dataRequested(segment.first, segment.second);
+
+    return available;
+}
+
 void collectBookmarks(DPdfDoc::Outline &outline, const CPDF_BookmarkTree &tree, CPDF_Bookmark This, qreal xRes, qreal yRes)
 {
     DPdfDoc::Section section;
@@ -287,7 +1364,7 @@ void collectBookmarks(DPdfDoc::Outline &outline, const CPDF_BookmarkTree &tree,
 
 DPdfDoc::Outline DPdfDoc::outline(qreal xRes, qreal yRes)
 {
-    DPdfMutexLocker locker("DPdfDoc::outline");
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::outline");
 
     Outline outline;
     CPDF_BookmarkTree tree(reinterpret_cast<CPDF_Document *>(d_func()->m_docHandler));
@@ -301,7 +1378,7 @@ DPdfDoc::Outline DPdfDoc::outline(qreal xRes, qreal yRes)
 
 DPdfDoc::Properies DPdfDoc::proeries()
 {
-    DPdfMutexLocker locker("DPdfDoc::proeries");
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::proeries");
 
     Properies properies;
     int fileversion = 1;
@@ -343,7 +1420,7 @@ DPdfDoc::Properies DPdfDoc::proeries()
 
 QString DPdfDoc::label(int index) const
 {
-    DPdfMutexLocker locker("DPdfDoc::label index = " + QString::number(index));
+    DPdfMutexLocker locker(&d_func()->m_mutex, "DPdfDoc::label index = " + QString::number(index));
 
     CPDF_PageLabel label(reinterpret_cast<CPDF_Document *>(d_func()->m_docHandler));
     const Optional<WideString> &str = label.GetLabel(index);
@@ -0,0 +1,382 @@
+#ifndef DPDFDOC_P_H
+#define DPDFDOC_P_H
+
+#include "dpdfdoc.h"
+#include "dpdftextindex.h"
+
+#include "public/fpdf_dataavail.h"
+#include "public/fpdf_save.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QRectF>
+#include <QSet>
+#include <QSharedPointer>
+#include <QThreadPool>
+
+#include <list>
+
+class CPDF_TextPage;
+class DPdfPagePrivate;
+class DPdfRenderTaskPrivate;
+class DPdfSearchTaskPrivate;
+class QIODevice;
+class DPdfDocPrivate;
+
+//pdfium回调只传回接口结构体本身,附带文档指针
+struct DPdfFileAvail : public FX_FILEAVAIL {
+    DPdfDocPrivate *doc = nullptr;
+};
+
+struct DPdfDownloadHints : public FX_DOWNLOADHINTS {
+    DPdfDocPrivate *doc = nullptr;
+};
+
+struct DPdfFileWrite : public FPDF_FILEWRITE {
+    QIODevice *device = nullptr;
+};
+
+class DPdfDocPrivate
+{
+    friend class DPdfDoc;
+    friend class DPdfPagePrivate;
+    friend class DPdfRenderTaskPrivate;
+    friend class DPdfSearchTaskPrivate;
+    friend class DPdfTextExporter;
+public:
+    explicit DPdfDocPrivate(DPdfDoc *q);
+
+    ~DPdfDocPrivate();
+
+public:
+    DPdfDoc *q_ptr = nullptr;
+
+    DPdfDoc::Status loadFile(const QString &filePath, const QString &password, DPdfDoc::LoadMode mode = DPdfDoc::READ_FILE);
+
+    DPdfDoc::Status loadData(const QByteArray &data, const QString &password);
+
+    DPdfDoc::Status loadDevice(QIODevice *device, const QString &password);
+
+    /**
+     * @brief 开始渐进加载,数据到达后调用addData()
+     * @param totalSize
+     * @param password
+     */
+    DPdfDoc::Status startProgressive(qint64 totalSize, const QString &password);
+
+    /**
+     * @brief 写入到达的数据并检查文档和页面是否可用 调用者需持有文档锁
+     * @param offset
+     * @param data
+     * @param newPages 新可用的页面
+     * @return 文档本次是否完成加载(成功或失败)
+     */
+    bool addData(qint64 offset, const QByteArray &data, QList<int> &newPages);
+
+    /**
+     * @brief 数据段是否已全部到达
+     */
+    bool isDataAvail(qint64 offset, qint64 size) const;
+
+    /**
+     * @brief 页面数据是否已到达,非渐进加载始终为true 调用者需持有文档锁
+     * @param index
+     * @return
+     */
+    bool checkPageAvail(int index);
+
+    /**
+     * @brief 同checkPageAvail() 内部加文档锁
+     * @param index
+     * @return
+     */
+    bool isPageDataAvail(int index);
+
+    /**
+     * @brief 临时加载一页并提取文字,用完即释放,不为页面保留解析数据 内部加文档锁
+     * @param index
+     * @param xRes 字符区域使用的分辨率
+     * @param yRes
+     * @param text 与DPdfPage::textLayout()的text一致
+     * @param rects 与text一一对应的字符区域 (in pixel),不需要时传nullptr
+     * @param size 页面大小 (in pixel),不需要时传nullptr
+     * @return 页面不可用返回false
+     */
+    bool extractPageText(int index, qreal xRes, qreal yRes, QString &text, QVector<QRectF> *rects, QSizeF *size = nullptr);
+
+    /**
+     * @brief 页面的文本缓冲 与FPDFText_GetText()一致,不含控制字符,超出BMP的字符为代理对
+     * @param textPage
+     * @param charIndices 每个UTF-16单元对应的pdfium字符索引,代理对的两个单元相同
+     * @return
+     */
+    static QString pageText(const CPDF_TextPage *textPage, QVector<int> &charIndices);
+
+    /**
+     * @brief 取出pdfium请求下载的数据段
+     */
+    QList<QPair<qint64, qint64>> takeRequestedSegments();
+
+    /**
+     * @brief 将文档流式写入设备
+     * @param device 已打开的可写设备
+     * @param flags FPDF_SaveAsCopy的保存标志
+     * @return
+     */
+    bool saveTo(QIODevice *device, unsigned long flags);
+
+    /**
+     * @brief 在当前文件末尾追加增量更新,只写入新建对象和已修改页面的注释相关对象
+     * 原文件不满足条件(没有文件,结构被修复,交叉引用流,文件已被替换)或写入失败时返回false,文件保持原样
+     * @return
+     */
+    bool appendUpdate();
+
+    /**
+     * @brief 页面注释被修改,下次增量保存时写入该页 调用者需持有文档锁
+     * @param index
+     */
+    void markPageModified(int index);
+
+    /**
+     * @brief 当前文件已被整体重写,之后无法在其后追加增量更新
+     */
+    void disableIncrementalSave();
+
+    /**
+     * @brief 页面解析数据被使用,移到最近使用位置并更新占用,超出预算时释放最久未使用页面的解析数据
+     * 调用者需持有文档锁
+     * @param page
+     */
+    void touchPage(DPdfPagePrivate *page);
+
+    /**
+     * @brief 页面解析数据已释放或页面被析构,从缓存记录中移除
+     * @param page
+     */
+    void removePage(DPdfPagePrivate *page);
+
+    /**
+     * @brief 重新计算页面占用,不改变其在LRU中的位置 调用者需持有文档锁
+     * @param page
+     */
+    void updatePageCost(DPdfPagePrivate *page);
+
+    /**
+     * @brief 文本页被使用,移到最近使用位置,超出数量上限时释放最久未使用页面的文本页 调用者需持有文档锁
+     * @param page
+     */
+    void touchTextPage(DPdfPagePrivate *page);
+
+    /**
+     * @brief 文本页已释放,从文本页LRU中移除
+     * @param page
+     */
+    void removeTextPage(DPdfPagePrivate *page);
+
+    /**
+     * @brief 将异步渲染任务加入文档的渲染线程池
+     * @param task
+     */
+    void startRenderTask(DPdfRenderTaskPrivate *task);
+
+    /**
+     * @brief 异步渲染任务被释放,不再跟踪
+     * @param task
+     */
+    void removeRenderTask(DPdfRenderTaskPrivate *task);
+
+    /**
+     * @brief 取消所有异步渲染任务并等待渲染线程退出,文档析构前调用,调用者不能持有文档锁
+     */
+    void cancelRenderTasks();
+
+    /**
+     * @brief 记录并启动搜索任务
+     * @param task
+     */
+    void startSearchTask(DPdfSearchTaskPrivate *task);
+
+    /**
+     * @brief 搜索任务被释放,不再跟踪
+     * @param task
+     */
+    void removeSearchTask(DPdfSearchTaskPrivate *task);
+
+    /**
+     * @brief 取消所有搜索任务并等待搜索线程退出,文档析构前调用,调用者不能持有文档锁
+     */
+    void cancelSearchTasks();
+
+    /**
+     * @brief 逐页提取文字建立全文索引,完成后保存到索引文件并触发textIndexReady() 在索引线程中执行
+     * @param q
+     * @param indexPath 为空时不保存
+     * @param key 索引文件对应的文件
+     */
+    void buildTextIndex(DPdfDoc *q, const QString &indexPath, const DPdfTextIndex::Key &key);
+
+    /**
+     * @brief 全文索引判断可能包含text的页面
+     * @param text
+     * @return 按页索引,没有索引时为空
+     */
+    QVector<bool> candidatePages(const QString &text);
+
+    /**
+     * @brief 停止建立索引并等待索引线程退出,文档析构前调用,调用者不能持有文档锁
+     */
+    void cancelTextIndex();
+
+    /**
+     * @brief 遍历页面树得到所有页面的大小和旋转并缓存 调用者需持有文档锁
+     * @return 已缓存或缓存成功返回true;渐进加载时有页面数据未到达返回false
+     */
+    bool cachePageSizes();
+
+    /**
+     * @brief 单个页面的大小和旋转,有缓存时直接使用 调用者需持有文档锁
+     * @param index
+     * @param size 单位point,已受旋转影响
+     * @param rotation
+     * @return 页面不存在返回false
+     */
+    bool pageSize(int index, QSizeF &size, int &rotation);
+
+private:
+    /**
+     * @brief 记录pdfium加载的文档,更新状态和页数
+     * @param doc 加载失败时为nullptr
+     */
+    DPdfDoc::Status setDocument(void *doc);
+
+    /**
+     * @brief 渐进加载的pdfium回调 数据可用检查,下载提示,读取数据
+     */
+    static FPDF_BOOL isAvailDataAvail(FX_FILEAVAIL *pThis, size_t offset, size_t size);
+
+    static void addAvailSegment(FX_DOWNLOADHINTS *pThis, size_t offset, size_t size);
+
+    static int readAvailBlock(void *param, unsigned long position, unsigned char *pBuf, unsigned long size);
+
+    static int writeBlock(FPDF_FILEWRITE *pThis, const void *pData, unsigned long size);
+
+    void shrinkPageCache(DPdfPagePrivate *keep);
+
+    void shrinkTextPageCache(DPdfPagePrivate *keep);
+
+private:
+    DPdfDocHandler *m_docHandler;
+
+    QVector<DPdfPage *> m_pages;
+
+    QString m_filePath;
+
+    //从内存打开时持有数据,pdfium直接读取此缓冲区
+    QByteArray m_data;
+
+    //从设备打开时按需读取
+    QIODevice *m_device = nullptr;
+
+    //渐进加载 数据写入m_data,已到达范围记录在m_receivedRanges
+    FPDF_AVAIL m_avail = nullptr;
+
+    DPdfFileAvail m_fileAvail;
+
+    DPdfDownloadHints m_downloadHints;
+
+    FPDF_FILEACCESS m_fileAccess;
+
+    QString m_password;
+
+    //已到达的数据范围 起始偏移->结束偏移(不含),互不相交
+    QMap<qint64, qint64> m_receivedRanges;
+
+    QVector<bool> m_availablePages;
+
+    QList<QPair<qint64, qint64>> m_requestedSegments;
+
+    int m_pageCount = 0;
+
+    DPdfDoc::Status m_status;
+
+    //文档锁 同一文档的所有pdfium调用都需要持有,不同文档之间互不影响
+    mutable QMutex m_mutex;
+
+    struct PageCacheEntry {
+        std::list<DPdfPagePrivate *>::iterator pos;
+        qint64 cost;
+    };
+
+    //已解析页面LRU front为最近使用
+    std::list<DPdfPagePrivate *> m_pageLru;
+
+    QHash<DPdfPagePrivate *, PageCacheEntry> m_pageCacheEntries;
+
+    qint64 m_pageCacheUsage = 0;
+
+    qint64 m_pageCacheBudget = 0;
+
+    int m_pageCacheLimit = 0;
+
+    qint64 m_pageCacheHits = 0;
+
+    qint64 m_pageCacheMisses = 0;
+
+    qint64 m_pageCacheEvictions = 0;
+
+    //已加载文本页的页面LRU front为最近使用,文本页比页面内容更常被单独使用,单独限制数量
+    std::list<DPdfPagePrivate *> m_textPageLru;
+
+    int m_textPageCacheLimit = 0;
+
+    //文档级解码图片缓存的内存预算 文档加载后交给pdfium
+    qint64 m_imageCacheBudget = 0;
+
+    //异步渲染线程池 同一文档的渲染在文档锁上串行,只需一个线程
+    QThreadPool m_renderPool;
+
+    QMutex m_renderTasksMutex;
+
+    QSet<DPdfRenderTaskPrivate *> m_renderTasks;
+
+    QMutex m_searchTasksMutex;
+
+    QSet<DPdfSearchTaskPrivate *> m_searchTasks;
+
+    //全文索引 建立完成后替换,搜索时只读
+    QMutex m_textIndexMutex;
+
+    QSharedPointer<DPdfTextIndex> m_textIndex;
+
+    bool m_textIndexBuilding = false;
+
+    QThreadPool m_indexPool;
+
+    QAtomicInt m_indexCancelled;
+
+    //页面大小(point)和旋转 一次遍历页面树后缓存,只增不改
+    QVector<QSizeF> m_pageSizes;
+
+    QVector<int> m_pageRotations;
+
+    bool m_pageSizesLoading = false;
+
+    //页面大小的遍历任务
+    QThreadPool m_sizePool;
+
+    //上次保存后注释被修改的页面
+    QSet<int> m_modifiedPages;
+
+    //当前文件的大小和最后一个交叉引用表位置,每次增量保存后更新
+    FPDF_INCREMENTAL_UPDATE m_incrementalUpdate = {0, 0, 0};
+
+    bool m_incrementalInited = false;
+
+    bool m_incrementalDisabled = false;
+};
+
+#endif // DPDFDOC_P_H
@@ -46,9 +46,7 @@ QString DPdfGlobal::textCodeType(const char *text)
     return encodeind;
 }
 
-Q_GLOBAL_STATIC_WITH_ARGS(QMutex, pdfMutex, (QMutex::Recursive));
-
-DPdfMutexLocker::DPdfMutexLocker(const QString &tmpLog): QMutexLocker(pdfMutex())
+DPdfMutexLocker::DPdfMutexLocker(QMutex *docMutex, const QString &tmpLog): QMutexLocker(docMutex)
 {
 //    m_log = tmpLog;
 //    qInfo() << m_log + " begin ";
@@ -0,0 +1,150 @@
+#include "dpdfgridindex.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+namespace {
+
+//平均每个格子登记的区域数
+const int itemsPerCell = 2;
+
+//格子数上限,避免区域过多时格子表本身占用过大
+const int maxCells = 256 * 256;
+
+}
+
+void DPdfGridIndex::build(const QVector<QRectF> &rects)
+{
+    clear();
+
+    m_rects.resize(rects.size());
+
+    int count = 0;
+
+    for (int i = 0; i < rects.size(); ++i) {
+        m_rects[i] = rects[i].normalized();
+
+        if (m_rects[i].isEmpty())
+            continue;
+
+        m_bounds = (0 == count) ? m_rects[i] : m_bounds.united(m_rects[i]);
+
+        ++count;
+    }
+
+    if (0 == count) {
+        m_rects.clear();
+        return;
+    }
+
+    //格子大致为正方形,数量与区域数相当
+    const int cells = qBound(1, count / itemsPerCell, maxCells);
+    const qreal aspect = m_bounds.width() / qMax<qreal>(m_bounds.height(), 1e-6);
+
+    m_columns = qBound(1, qCeil(qSqrt(cells * aspect)), cells);
+    m_rows = qBound(1, qCeil(static_cast<qreal>(cells) / m_columns), maxCells / m_columns);
+
+    m_cellWidth = qMax<qreal>(m_bounds.width() / m_columns, 1e-6);
+    m_cellHeight = qMax<qreal>(m_bounds.height() / m_rows, 1e-6);
+
+    //两遍登记 先统计每个格子的区域数,再按偏移写入,所有格子共用一块连续内存
+    m_cellStart.fill(0, m_columns * m_rows + 1);
+
+    for (const QRectF &rect : m_rects) {
+        if (rect.isEmpty())
+            continue;
+
+        for (int r = row(rect.top()); r <= row(rect.bottom()); ++r) {
+            for (int c = column(rect.left()); c <= column(rect.right()); ++c)
+                ++m_cellStart[r * m_columns + c + 1];
+        }
+    }
+
+    for (int i = 1; i < m_cellStart.size(); ++i)
+        m_cellStart[i] += m_cellStart[i - 1];
+
+    m_cellItems.resize(m_cellStart.last());
+
+    QVector<int> fill = m_cellStart;
+
+    for (int i = 0; i < m_rects.size(); ++i) {
+        const QRectF &rect = m_rects[i];
+
+        if (rect.isEmpty())
+            continue;
+
+        for (int r = row(rect.top()); r <= row(rect.bottom()); ++r) {
+            for (int c = column(rect.left()); c <= column(rect.right()); ++c)
+                m_cellItems[fill[r * m_columns + c]++] = i;
+        }
+    }
+}
+
+void DPdfGridIndex::clear()
+{
+    m_bounds = QRectF();
+    m_columns = 0;
+    m_rows = 0;
+    m_cellStart.clear();
+    m_cellItems.clear();
+    m_rects.clear();
+}
+
+bool DPdfGridIndex::isEmpty() const
+{
+    return m_cellItems.isEmpty();
+}
+
+QVector<int> DPdfGridIndex::itemsAt(const QPointF &pos, qreal tolerance) const
+{
+    QVector<int> items;
+
+    if (isEmpty())
+        return items;
+
+    tolerance = qMax<qreal>(tolerance, 0);
+
+    const QRectF area(pos.x() - tolerance, pos.y() - tolerance, tolerance * 2, tolerance * 2);
+
+    if (!area.intersects(m_bounds) && !m_bounds.contains(pos))
+        return items;
+
+    for (int r = row(area.top()); r <= row(area.bottom()); ++r) {
+        for (int c = column(area.left()); c <= column(area.right()); ++c) {
+            const int cell = r * m_columns + c;
+
+            for (int i = m_cellStart[cell]; i < m_cellStart[cell + 1]; ++i) {
+                const int item = m_cellItems[i];
+
+                const QRectF &rect = m_rects[item].adjusted(-tolerance, -tolerance, tolerance, tolerance);
+
+                //边界上的点也算在内,与CFX_FloatRect::Contains一致
+                if (pos.x() >= rect.left() && pos.x() <= rect.right() && pos.y() >= rect.top() && pos.y() <= rect.bottom())
+                    items.append(item);
+            }
+        }
+    }
+
+    //跨多个格子的区域会重复出现
+    std::sort(items.begin(), items.end());
+    items.erase(std::unique(items.begin(), items.end()), items.end());
+
+    return items;
+}
+
+qint64 DPdfGridIndex::cost() const
+{
+    return static_cast<qint64>(m_rects.size()) * static_cast<qint64>(sizeof(QRectF))
+           + static_cast<qint64>(m_cellStart.size() + m_cellItems.size()) * static_cast<qint64>(sizeof(int));
+}
+
+int DPdfGridIndex::column(qreal x) const
+{
+    return qBound(0, static_cast<int>((x - m_bounds.left()) / m_cellWidth), m_columns - 1);
+}
+
+int DPdfGridIndex::row(qreal y) const
+{
+    return qBound(0, static_cast<int>((y - m_bounds.top()) / m_cellHeight), m_rows - 1);
+}
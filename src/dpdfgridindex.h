@@ -0,0 +1,74 @@
+#ifndef DPDFGRIDINDEX_H
+#define DPDFGRIDINDEX_H
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+/**
+ * @brief 均匀网格空间索引 将区域按所覆盖的格子登记,按点查询时只检查点所在格子内的区域
+ * 建立后只读,区域变化时重新建立
+ */
+class DPdfGridIndex
+{
+public:
+    /**
+     * @brief 建立索引 空区域不登记
+     * @param rects 区域,编号为在rects中的下标
+     */
+    void build(const QVector<QRectF> &rects);
+
+    void clear();
+
+    bool isEmpty() const;
+
+    /**
+     * @brief 外扩tolerance后包含pos的区域
+     * @param pos
+     * @param tolerance
+     * @return 区域编号,升序
+     */
+    QVector<int> itemsAt(const QPointF &pos, qreal tolerance = 0) const;
+
+    /**
+     * @brief 区域 已规范化为正宽高
+     */
+    const QRectF &rect(int item) const
+    {
+        return m_rects[item];
+    }
+
+    /**
+     * @brief 估算占用的内存
+     * @return 字节数
+     */
+    qint64 cost() const;
+
+private:
+    /**
+     * @brief 坐标所在的格子,超出范围时取边缘的格子
+     */
+    int column(qreal x) const;
+
+    int row(qreal y) const;
+
+private:
+    QRectF m_bounds;
+
+    int m_columns = 0;
+
+    int m_rows = 0;
+
+    qreal m_cellWidth = 0;
+
+    qreal m_cellHeight = 0;
+
+    //每个格子的区域在m_cellItems中的起始位置,共m_columns * m_rows + 1项
+    QVector<int> m_cellStart;
+
+    QVector<int> m_cellItems;
+
+    QVector<QRectF> m_rects;
+};
+
+#endif // DPDFGRIDINDEX_H
@@ -1,6 +1,11 @@
 #include "dpdfdoc.h"
+#include "dpdfdoc_p.h"
 #include "dpdfpage.h"
+#include "dpdfpage_p.h"
 #include "dpdfannot.h"
+#include "dpdfrendertask.h"
+#include "dpdfpatternmatcher.h"
+#include "dpdftilerenderer.h"
 
 #include "public/fpdfview.h"
 #include "public/fpdf_text.h"
@@ -9,184 +14,248 @@
 #include "public/fpdf_edit.h"
 
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/render/cpdf_pagerendercache.h"
 #include "core/fpdftext/cpdf_textpage.h"
 #include "core/fpdfdoc/cpdf_linklist.h"
 #include "fpdfsdk/cpdfsdk_helpers.h"
 
-class DPdfPagePrivate
+#include <limits>
+#include <vector>
+
+DPdfPagePrivate::DPdfPagePrivate(DPdfDocPrivate *doc, int index, qreal xRes, qreal yRes):
+    m_docPrivate(doc), m_doc(reinterpret_cast<FPDF_DOCUMENT>(doc->m_docHandler)), m_docMutex(&doc->m_mutex), m_index(index), m_xRes(xRes), m_yRes(yRes)
 {
-    friend class DPdfPage;
-public:
-    DPdfPagePrivate(DPdfDocHandler *handler, int index, qreal xRes, qreal yRes);
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::DPdfPagePrivate index = " + QString::number(index));
+
+    //宽高会受自身旋转值影响 单位:point 1/72inch 高分屏上要乘以系数 已遍历过页面树时直接使用缓存
+    //找不到页面字典的页面无效,遍历结果中大小为空,逐页获取时返回失败
+    if (index < doc->m_pageSizes.size()) {
+        m_width_pt = doc->m_pageSizes[index].width();
+        m_height_pt = doc->m_pageSizes[index].height();
+        m_isValid = !doc->m_pageSizes[index].isEmpty();
+    } else {
+        m_isValid = (0 != FPDF_GetPageSizeByIndex(m_doc, index, &m_width_pt, &m_height_pt));
+    }
+}
 
-    ~DPdfPagePrivate();
+DPdfPagePrivate::~DPdfPagePrivate()
+{
+    releaseParsedPage();
 
-public:
-    void loadPage();
+    qDeleteAll(m_dAnnots);
+}
 
-    void loadTextPage();
+QList<DPdfAnnot *> DPdfPagePrivate::allAnnots()
+{
+    if (m_isLoadAnnots)
+        return m_dAnnots;
 
-    /**
-     * @brief 文档自身旋转
-     * @return
-     */
-    int oriRotation();
+    loadAnnots();
 
-    QSizeF sizeF() const
-    {
-        return QSizeF(m_width_pt * m_xRes / 72, m_height_pt * m_yRes / 72);
-    }
+    return m_dAnnots;
+}
 
-    QRectF transPointToPixel(const QRectF &rect) const
-    {
-        return QRectF(rect.x() * m_xRes / 72, rect.y() * m_yRes / 72, rect.width() * m_xRes / 72, rect.height() * m_yRes / 72);
-    }
-    QSizeF transPointToPixel(const QSizeF &size) const
-    {
-        return QSizeF(size.width() * m_xRes / 72, size.height() * m_yRes / 72);
-    }
-    float transPointToPixelX(const float &x) const
-    {
-        return x * m_xRes / 72;
-    }
-    float transPointToPixelY(const float &y) const
-    {
-        return y * m_yRes / 72;
-    }
+void DPdfPagePrivate::loadPage()
+{
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::loadPage() index = " + QString::number(m_index));//同一文档内多线程调用此函数会崩溃,此处需要加文档锁
 
-    QRectF transPixelToPoint(const QRectF &rect) const
-    {
-        return QRectF(rect.x() * 72 / m_xRes, rect.y() * 72 / m_yRes, rect.width() * 72 / m_xRes, rect.height() * 72 / m_yRes);
-    }
-    QPointF transPixelToPoint(const QPointF &pos) const
-    {
-        return QPointF(pos.x() * 72 / m_xRes, pos.y() * 72 / m_yRes);
-    }
-    QSizeF transPixelToPoint(const QSizeF &size) const
-    {
-        return QSizeF(size.width() * 72 / m_xRes, size.height() * 72 / m_yRes);
+    if (nullptr == m_page) {
+        m_page = FPDF_LoadPage(m_doc, m_index);
+        ++m_docPrivate->m_pageCacheMisses;
+    } else {
+        ++m_docPrivate->m_pageCacheHits;
     }
-private:
-    /**
-     * @brief 加载注释,无需初始化，注释的坐标取值不受页自身旋转影响,goto部分link由于耗时，需要使用时调用initAnnot初始化
-     * @return 加载失败说明该页存在问题
-     */
-    bool loadAnnots();
 
-    /**
-     * @brief 获取所有注释
-     * @return
-     */
-    QList<DPdfAnnot *> allAnnots();
+    m_docPrivate->touchPage(this);
+}
 
-    /**
-     * @brief 初始化需要延时的注释
-     * @param dAnnot
-     * @return
-     */
-    bool initAnnot(DPdfAnnot *dAnnot);
-    /**
-     * @brief 视图坐标转化为文档坐标
-     * @param rotation 文档自身旋转
-     * @param rect
-     * @return
-     */
-    FS_RECTF transRect(const int &rotation, const QRectF &rect);
+void DPdfPagePrivate::loadTextPage()
+{
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::loadTextPage() index = " + QString::number(m_index));
 
-    /**
-     * @brief 文档坐标转化视图坐标
-     * @param rotation 文档自身旋转
-     * @param rect
-     * @return
-     */
-    QRectF transRect(const int &rotation, const FS_RECTF &rect);
+    loadPage();
 
-private:
-    FPDF_DOCUMENT m_doc = nullptr;
+    if (nullptr == m_textPage) {
+        m_textPage = FPDFText_LoadPage(m_page);
+        m_docPrivate->touchPage(this);
+    }
+
+    m_docPrivate->touchTextPage(this);
+}
 
-    int m_index = -1;
+void DPdfPagePrivate::releaseParsedPage()
+{
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::releaseParsedPage() index = " + QString::number(m_index));
 
-    qreal m_width_pt = 0;
+    m_docPrivate->removePage(this);
 
-    qreal m_height_pt = 0;
+    releaseTextPage();
 
-    qreal m_xRes = 72;
+    //注释对象已交给调用者,只释放可重建的区域索引
+    m_annotGrid.clear();
+    m_annotGridOwners.clear();
+    m_isLoadAnnotGrid = false;
 
-    qreal m_yRes = 72;
+    if (m_page) {
+        FPDF_ClosePage(m_page);
+        m_page = nullptr;
+    }
+}
 
-    FPDF_PAGE m_page = nullptr;
+void DPdfPagePrivate::releaseTextPage()
+{
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::releaseTextPage() index = " + QString::number(m_index));
 
-    FPDF_TEXTPAGE m_textPage = nullptr;
+    m_docPrivate->removeTextPage(this);
 
-    QList<DPdfAnnot *> m_dAnnots;
+    if (m_textPage) {
+        FPDFText_ClosePage(m_textPage);
+        m_textPage = nullptr;
+    }
 
-    bool m_isValid = false;
+    m_charGrid.clear();
+    m_isLoadCharGrid = false;
 
-    bool m_isLoadAnnots = false;
-};
+    m_docPrivate->updatePageCost(this);
+}
 
-DPdfPagePrivate::DPdfPagePrivate(DPdfDocHandler *handler, int index, qreal xRes, qreal yRes):
-    m_doc(reinterpret_cast<FPDF_DOCUMENT>(handler)), m_index(index), m_xRes(xRes), m_yRes(yRes)
+bool DPdfPagePrivate::renderImage(QImage &image, int width, int height, const QRect &slice, IFSDK_PAUSE *pause)
 {
-    DPdfMutexLocker locker("DPdfPagePrivate::DPdfPagePrivate index = " + QString::number(index));
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::renderImage() index = " + QString::number(m_index));
+
+    loadPage();
+
+    FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(image.width(), image.height(), FPDFBitmap_BGRA, image.scanLine(0), image.bytesPerLine());
+
+    if (nullptr == bitmap)
+        return false;
 
-    //宽高会受自身旋转值影响 单位:point 1/72inch 高分屏上要乘以系数
-    FPDF_GetPageSizeByIndex(m_doc, index, &m_width_pt, &m_height_pt);
+    int status = FPDF_RenderPageBitmap_Start(bitmap, m_page, slice.x(), slice.y(), slice.width(), slice.height(), width, height, 0, FPDF_ANNOT, pause);
 
-    FPDF_PAGE page = FPDF_LoadNoParsePage(m_doc, m_index);
-    m_isValid = (page != nullptr);
-    FPDF_ClosePage(page);
+    //遇到蒙版图片时也会中断,只有pause要求停止时才放弃
+    while (FPDF_RENDER_TOBECONTINUED == status && !pause->NeedToPauseNow(pause))
+        status = FPDF_RenderPage_Continue(m_page, pause);
+
+    FPDF_RenderPage_Close(m_page);
+
+    FPDFBitmap_Destroy(bitmap);
+
+    //渲染缓存增长后重新计算占用
+    m_docPrivate->touchPage(this);
+
+    return FPDF_RENDER_DONE == status;
 }
 
-DPdfPagePrivate::~DPdfPagePrivate()
+void DPdfPagePrivate::loadCharGrid()
 {
-    if (m_textPage)
-        FPDFText_ClosePage(m_textPage);
+    loadTextPage();
 
-    if (m_page)
-        FPDF_ClosePage(m_page);
+    if (m_isLoadCharGrid)
+        return;
 
-    qDeleteAll(m_dAnnots);
+    const CPDF_TextPage *textPage = reinterpret_cast<CPDF_TextPage *>(m_textPage);
+
+    QVector<QRectF> rects;
+
+    if (nullptr != textPage) {
+        const int charCount = textPage->CountChars();
+
+        rects.resize(charCount);
+
+        for (int i = 0; i < charCount; ++i) {
+            const CFX_FloatRect &rect = textPage->GetCharLooseBounds(static_cast<size_t>(i));
+
+            rects[i] = transPointToPixel(QRectF(static_cast<qreal>(rect.left),
+                                                m_height_pt - static_cast<qreal>(rect.top),
+                                                static_cast<qreal>(rect.right - rect.left),
+                                                static_cast<qreal>(rect.top - rect.bottom)));
+        }
+    }
+
+    m_charGrid.build(rects);
+
+    m_isLoadCharGrid = true;
+
+    //索引计入解析数据占用
+    m_docPrivate->touchPage(this);
 }
 
-QList<DPdfAnnot *> DPdfPagePrivate::allAnnots()
+void DPdfPagePrivate::loadAnnotGrid()
 {
-    if (m_isLoadAnnots)
-        return m_dAnnots;
+    if (m_isLoadAnnotGrid)
+        return;
 
-    loadAnnots();
+    const QList<DPdfAnnot *> &annots = allAnnots();
 
-    return m_dAnnots;
+    QVector<QRectF> rects;
+
+    m_annotGridOwners.clear();
+
+    for (DPdfAnnot *annot : annots) {
+        const QList<QRectF> &boundaries = annot->boundaries();
+
+        for (const QRectF &rect : boundaries) {
+            rects.append(rect);
+            m_annotGridOwners.append(annot);
+        }
+    }
+
+    m_annotGrid.build(rects);
+
+    m_isLoadAnnotGrid = true;
+
+    //索引计入解析数据占用,随页面一起被淘汰
+    m_docPrivate->touchPage(this);
 }
 
-void DPdfPagePrivate::loadPage()
+void DPdfPagePrivate::annotsChanged()
 {
-    if (nullptr == m_page) {
-        DPdfMutexLocker locker("DPdfPagePrivate::loadPage() index = " + QString::number(m_index));//即使其他文档的page在加载时，多线程调用此函数也会崩溃，非常线程不安全,此处需要加锁
-        m_page = FPDF_LoadPage(m_doc, m_index);
-    }
+    m_docPrivate->markPageModified(m_index);
+
+    m_isLoadAnnotGrid = false;
+
+    //共享分块缓存中该页的分块还画着修改前的注释
+    DPdfTileRenderer::clearCache(m_docPrivate->q_ptr, m_index);
 }
 
-void DPdfPagePrivate::loadTextPage()
+qint64 DPdfPagePrivate::parsedCost() const
 {
-    loadPage();
+    //页面对象按平均大小估算,图片按渲染缓存中解码后的实际大小计算,文本页按其紧凑存储的实际大小计算
+    static const qint64 pageObjectCost = 512;
 
-    if (nullptr == m_textPage) {
-        DPdfMutexLocker locker("DPdfPagePrivate::loadTextPage() index = " + QString::number(m_index));
-        m_textPage = FPDFText_LoadPage(m_page);
+    qint64 cost = 0;
+
+    if (m_page) {
+        CPDF_Page *pPage = CPDFPageFromFPDFPage(m_page);
+
+        cost += static_cast<qint64>(pPage->GetPageObjectCount()) * pageObjectCost;
+
+        const CPDF_PageRenderCache *renderCache = static_cast<const CPDF_PageRenderCache *>(pPage->GetRenderCache());
+        if (renderCache)
+            cost += renderCache->GetCacheSize();
     }
+
+    if (m_textPage)
+        cost += static_cast<qint64>(reinterpret_cast<CPDF_TextPage *>(m_textPage)->GetMemoryUsage());
+
+    cost += m_charGrid.cost();
+
+    cost += m_annotGrid.cost() + m_annotGridOwners.size() * static_cast<qint64>(sizeof(DPdfAnnot *));
+
+    return cost;
 }
 
 int DPdfPagePrivate::oriRotation()
 {
-    if (nullptr == m_page) {
-        DPdfMutexLocker locker("DPdfPagePrivate::oriRotation() index = " + QString::number(m_index));
+    //m_page可能被页面缓存在其他线程中释放,判断和使用都需在文档锁内
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::oriRotation() index = " + QString::number(m_index));
 
+    if (nullptr == m_page) {
         FPDF_PAGE page = FPDF_LoadNoParsePage(m_doc, m_index);
 
         CPDF_Page *pPage = CPDFPageFromFPDFPage(page);
 
-        int rotation = pPage->GetPageRotation();
+        int rotation = (nullptr != pPage) ? pPage->GetPageRotation() : 0;
 
         FPDF_ClosePage(page);
 
@@ -198,7 +267,7 @@ int DPdfPagePrivate::oriRotation()
 
 bool DPdfPagePrivate::loadAnnots()
 {
-    DPdfMutexLocker locker("DPdfPagePrivate::allAnnots");
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::allAnnots");
 
     //使用临时page，不完全加载,防止刚开始消耗时间过长
     FPDF_PAGE page = m_page;
@@ -418,7 +487,7 @@ bool DPdfPagePrivate::initAnnot(DPdfAnnot *dAnnot)
     //使用临时page，不完全加载,防止刚开始消耗时间过长
     FPDF_PAGE page = m_page;
 
-    DPdfMutexLocker locker("DPdfPagePrivate::initAnnot index = " + QString::number(m_index));
+    DPdfMutexLocker locker(m_docMutex, "DPdfPagePrivate::initAnnot index = " + QString::number(m_index));
 
     if (page == nullptr)
         page = FPDF_LoadNoParsePage(m_doc, m_index);      //不调用ParseContent，目前观察不会导致多线程崩溃
@@ -525,8 +594,8 @@ QRectF DPdfPagePrivate::transRect(const int &rotation, const FS_RECTF &fs_rect)
                   static_cast<qreal>(fs_rect.top) - static_cast<qreal>(fs_rect.bottom));
 }
 
-DPdfPage::DPdfPage(DPdfDocHandler *handler, int pageIndex, qreal xRes, qreal yRes)
-    : d_ptr(new DPdfPagePrivate(handler, pageIndex, xRes, yRes))
+DPdfPage::DPdfPage(DPdfDocPrivate *doc, int pageIndex, qreal xRes, qreal yRes)
+    : d_ptr(new DPdfPagePrivate(doc, pageIndex, xRes, yRes))
 {
 
 }
@@ -566,18 +635,20 @@ QImage DPdfPage::image(int width, int height, QRect slice)
 
     image.fill(0xFFFFFFFF);
 
-    DPdfMutexLocker locker("DPdfPage::image index = " + QString::number(index()));
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::image index = " + QString::number(index()));
 
-    FPDF_PAGE page = FPDF_LoadPage(d_func()->m_doc, d_func()->m_index);
+    //复用已解析的页面及其渲染缓存(解码后的图片),重复渲染时只需光栅化
+    d_func()->loadPage();
 
     FPDF_BITMAP bitmap = FPDFBitmap_CreateEx(image.width(), image.height(), FPDFBitmap_BGRA, image.scanLine(0), image.bytesPerLine());
 
     if (bitmap != nullptr) {
-        FPDF_RenderPageBitmap(bitmap, page, slice.x(), slice.y(), slice.width(), slice.height(), width, height, 0, FPDF_ANNOT);
+        FPDF_RenderPageBitmap(bitmap, d_func()->m_page, slice.x(), slice.y(), slice.width(), slice.height(), width, height, 0, FPDF_ANNOT);
         FPDFBitmap_Destroy(bitmap);
     }
 
-    FPDF_ClosePage(page);
+    //渲染缓存增长后重新计算占用
+    d_func()->m_docPrivate->touchPage(d_func());
 
     locker.unlock();
 
@@ -594,23 +665,34 @@ QImage DPdfPage::image(int width, int height, QRect slice)
     return image;
 }
 
+DPdfRenderTask *DPdfPage::imageAsync(int width, int height, QRect slice)
+{
+    if (nullptr == d_func()->m_doc)
+        return nullptr;
+
+    if (!slice.isValid())
+        slice = QRect(0, 0, width, height);
+
+    return new DPdfRenderTask(d_func()->m_docPrivate, d_func(), width, height, slice);
+}
+
 int DPdfPage::countChars()
 {
-    d_func()->loadTextPage();
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::countChars index = " + QString::number(index()));
 
-    DPdfMutexLocker locker("DPdfPage::countChars index = " + QString::number(index()));
+    d_func()->loadTextPage();
 
     return FPDFText_CountChars(d_func()->m_textPage);
 }
 
 QVector<QRectF> DPdfPage::textRects(int start, int charCount)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::textRects index = " + QString::number(index()));
+
     d_func()->loadTextPage();
 
     QVector<QRectF> result;
 
-    DPdfMutexLocker locker("DPdfPage::textRects index = " + QString::number(index()));
-
     const std::vector<CFX_FloatRect> &pdfiumRects = reinterpret_cast<CPDF_TextPage *>(d_func()->m_textPage)->GetRectArray(start, charCount);
 
     result.reserve(static_cast<int>(pdfiumRects.size()));
@@ -625,11 +707,53 @@ QVector<QRectF> DPdfPage::textRects(int start, int charCount)
     return result;
 }
 
-void DPdfPage::allTextLooseRects(int &charCount, QStringList &texts, QVector<QRectF> &rects)
+QVector<QRectF> DPdfPage::textRects(const QVector<QPair<int, int>> &ranges, QVector<int> *offsets)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::textRects ranges index = " + QString::number(index()));
+
     d_func()->loadTextPage();
 
-    DPdfMutexLocker locker("DPdfPage::allTextRects index = " + QString::number(index()));
+    const CPDF_TextPage *textPage = reinterpret_cast<CPDF_TextPage *>(d_func()->m_textPage);
+
+    std::vector<CFX_FloatRect> pdfiumRects;
+
+    pdfiumRects.reserve(static_cast<size_t>(ranges.size()));
+
+    if (nullptr != offsets) {
+        offsets->clear();
+        offsets->reserve(ranges.size() + 1);
+    }
+
+    for (const QPair<int, int> &range : ranges) {
+        if (nullptr != offsets)
+            offsets->append(static_cast<int>(pdfiumRects.size()));
+
+        if (nullptr != textPage)
+            textPage->AppendLineRects(range.first, range.second, &pdfiumRects);
+    }
+
+    if (nullptr != offsets)
+        offsets->append(static_cast<int>(pdfiumRects.size()));
+
+    QVector<QRectF> result;
+
+    result.reserve(static_cast<int>(pdfiumRects.size()));
+
+    for (const CFX_FloatRect &rect : pdfiumRects) {
+        result.push_back(d_func()->transPointToPixel(QRectF(static_cast<qreal>(rect.left),
+                                                            d_func()->m_height_pt - static_cast<qreal>(rect.top),
+                                                            static_cast<qreal>(rect.right - rect.left),
+                                                            static_cast<qreal>(rect.top - rect.bottom))));
+    }
+
+    return result;
+}
+
+void DPdfPage::allTextLooseRects(int &charCount, QStringList &texts, QVector<QRectF> &rects)
+{
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::allTextRects index = " + QString::number(index()));
+
+    d_func()->loadTextPage();
 
     charCount = FPDFText_CountChars(d_func()->m_textPage);
 
@@ -659,9 +783,9 @@ void DPdfPage::allTextLooseRects(int &charCount, QStringList &texts, QVector<QRe
 
 void DPdfPage::allTextRects(int &charCount, QStringList &texts, QVector<QRectF> &rects)
 {
-    d_func()->loadTextPage();
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::allTextRects index = " + QString::number(index()));
 
-    DPdfMutexLocker locker("DPdfPage::allTextRects index = " + QString::number(index()));
+    d_func()->loadTextPage();
 
     charCount = FPDFText_CountChars(d_func()->m_textPage);
 
@@ -693,11 +817,109 @@ void DPdfPage::allTextRects(int &charCount, QStringList &texts, QVector<QRectF>
     }
 }
 
-bool DPdfPage::textRect(int index, QRectF &textrect)
+DPdfTextLayout DPdfPage::textLayout()
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::textLayout index = " + QString::number(index()));
+
     d_func()->loadTextPage();
 
-    DPdfMutexLocker locker("DPdfPage::textRect(int index, QRectF &textrect) index = " + QString::number(this->index()));
+    DPdfTextLayout layout;
+
+    const CPDF_TextPage *textPage = reinterpret_cast<CPDF_TextPage *>(d_func()->m_textPage);
+
+    if (nullptr == textPage)
+        return layout;
+
+    layout.text = DPdfDocPrivate::pageText(textPage, layout.charIndices);
+
+    const int count = layout.text.size();
+
+    if (count <= 0)
+        return layout;
+
+    layout.charRects.resize(count);
+    layout.looseRects.resize(count);
+    layout.fontSizes.resize(count);
+
+    const QChar *text = layout.text.constData();
+    QRectF *charRects = layout.charRects.data();
+    QRectF *looseRects = layout.looseRects.data();
+    float *fontSizes = layout.fontSizes.data();
+
+    auto toPixel = [this](const CFX_FloatRect & rect) {
+        return d_func()->transPointToPixel(QRectF(static_cast<qreal>(rect.left),
+                                                  d_func()->m_height_pt - static_cast<qreal>(rect.top),
+                                                  static_cast<qreal>(rect.right - rect.left),
+                                                  static_cast<qreal>(rect.top - rect.bottom)));
+    };
+
+    bool inWord = false;
+
+    for (int i = 0; i < count; ++i) {
+        const QChar ch = text[i];
+
+        //代理对的两个单元取同一字符的区域
+        const int charIndex = layout.charIndices[i];
+
+        if (charIndex >= 0) {
+            const size_t index = static_cast<size_t>(charIndex);
+            charRects[i] = toPixel(textPage->GetCharInfo(index).m_CharBox);
+            looseRects[i] = toPixel(textPage->GetCharLooseBounds(index));
+            fontSizes[i] = textPage->GetCharFontSize(index);
+        }
+
+        const bool isLineEnd = (ch == QLatin1Char('\n') || ch == QLatin1Char('\r'));
+
+        if (i > 0 && !isLineEnd && (text[i - 1] == QLatin1Char('\n') || text[i - 1] == QLatin1Char('\r')))
+            layout.lineBreaks.append(i);
+
+        if (isLineEnd || ch.isSpace()) {
+            inWord = false;
+        } else if (!inWord) {
+            layout.wordBreaks.append(i);
+            inWord = true;
+        }
+    }
+
+    return layout;
+}
+
+int DPdfPage::charAt(const QPointF &pos, qreal tolerance)
+{
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::charAt index = " + QString::number(index()));
+
+    d_func()->loadCharGrid();
+
+    const QVector<int> &items = d_func()->m_charGrid.itemsAt(pos, tolerance);
+
+    int nearest = -1;
+
+    qreal nearestDistance = std::numeric_limits<qreal>::max();
+
+    //与CPDF_TextPage::GetIndexAtPos一致,优先取包含该点的第一个字符,否则取容差范围内边缘最近的字符
+    for (int item : items) {
+        const QRectF &rect = d_func()->m_charGrid.rect(item);
+
+        if (rect.contains(pos))
+            return item;
+
+        const qreal distance = qMin(qAbs(pos.x() - rect.left()), qAbs(pos.x() - rect.right()))
+                               + qMin(qAbs(pos.y() - rect.top()), qAbs(pos.y() - rect.bottom()));
+
+        if (distance < nearestDistance) {
+            nearestDistance = distance;
+            nearest = item;
+        }
+    }
+
+    return nearest;
+}
+
+bool DPdfPage::textRect(int index, QRectF &textrect)
+{
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::textRect(int index, QRectF &textrect) index = " + QString::number(this->index()));
+
+    d_func()->loadTextPage();
 
     if (FPDFText_GetUnicode(d_func()->m_textPage, index) == L' ') {
         textrect = QRectF();
@@ -718,6 +940,8 @@ bool DPdfPage::textRect(int index, QRectF &textrect)
 
 QString DPdfPage::text(const QRectF &rect)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::text(const QRectF &rect) index = " + QString::number(this->index()));
+
     d_func()->loadTextPage();
 
     QRectF pointRect = d_func()->transPixelToPoint(rect);
@@ -729,8 +953,6 @@ QString DPdfPage::text(const QRectF &rect)
     CFX_FloatRect fxRect(static_cast<float>(pointRect.left()), static_cast<float>(std::min(newBottom, newTop)),
                          static_cast<float>(pointRect.right()), static_cast<float>(std::max(newBottom, newTop)));
 
-    DPdfMutexLocker locker("DPdfPage::text(const QRectF &rect) index = " + QString::number(this->index()));
-
     auto text = reinterpret_cast<CPDF_TextPage *>(d_func()->m_textPage)->GetTextByRect(fxRect);
 
     return QString::fromWCharArray(text.c_str(), static_cast<int>(text.GetLength()));
@@ -738,9 +960,9 @@ QString DPdfPage::text(const QRectF &rect)
 
 QString DPdfPage::text(int index, int charCount)
 {
-    d_func()->loadTextPage();
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::text(int index, int charCount) index = " + QString::number(this->index()));
 
-    DPdfMutexLocker locker("DPdfPage::text(int index, int charCount) index = " + QString::number(this->index()));
+    d_func()->loadTextPage();
 
     auto text = reinterpret_cast<CPDF_TextPage *>(d_func()->m_textPage)->GetPageText(index, charCount);
 
@@ -749,14 +971,17 @@ QString DPdfPage::text(int index, int charCount)
 
 DPdfAnnot *DPdfPage::createTextAnnot(QPointF pos, QString text)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::createTextAnnot(QPointF pos, QString text) index = " + QString::number(this->index()));
+
     d_func()->loadPage();
 
+    //失败时页面也可能已被部分修改,一并记录
+    d_func()->annotsChanged();
+
     QPointF pointPos = d_func()->transPixelToPoint(pos);
 
     FPDF_ANNOTATION_SUBTYPE subType = FPDF_ANNOT_TEXT;
 
-    DPdfMutexLocker locker("DPdfPage::createTextAnnot(QPointF pos, QString text) index = " + QString::number(this->index()));
-
     FPDF_ANNOTATION annot = FPDFPage_CreateAnnot(d_func()->m_page, subType);
 
     if (!FPDFAnnot_SetStringValue(annot, "Contents", text.utf16())) {
@@ -793,8 +1018,12 @@ DPdfAnnot *DPdfPage::createTextAnnot(QPointF pos, QString text)
 
 bool DPdfPage::updateTextAnnot(DPdfAnnot *dAnnot, QString text, QPointF pos)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::updateTextAnnot index = " + QString::number(this->index()));
+
     d_func()->loadPage();
 
+    d_func()->annotsChanged();
+
     DPdfTextAnnot *textAnnot = static_cast<DPdfTextAnnot *>(dAnnot);
 
     if (nullptr == textAnnot)
@@ -802,8 +1031,6 @@ bool DPdfPage::updateTextAnnot(DPdfAnnot *dAnnot, QString text, QPointF pos)
 
     int index = d_func()->allAnnots().indexOf(dAnnot);
 
-    DPdfMutexLocker locker("DPdfPage::updateTextAnnot index = " + QString::number(this->index()));
-
     FPDF_ANNOTATION annot = FPDFPage_GetAnnot(d_func()->m_page, index);
 
     if (!FPDFAnnot_SetStringValue(annot, "Contents", text.utf16())) {
@@ -838,11 +1065,13 @@ bool DPdfPage::updateTextAnnot(DPdfAnnot *dAnnot, QString text, QPointF pos)
 
 DPdfAnnot *DPdfPage::createHightLightAnnot(const QList<QRectF> &rects, QString text, QColor color)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::createHightLightAnnot index = " + QString::number(this->index()));
+
     d_func()->loadPage();
 
-    FPDF_ANNOTATION_SUBTYPE subType = FPDF_ANNOT_HIGHLIGHT;
+    d_func()->annotsChanged();
 
-    DPdfMutexLocker locker("DPdfPage::createHightLightAnnot index = " + QString::number(this->index()));
+    FPDF_ANNOTATION_SUBTYPE subType = FPDF_ANNOT_HIGHLIGHT;
 
     FPDF_ANNOTATION annot = FPDFPage_CreateAnnot(d_func()->m_page, subType);
 
@@ -898,8 +1127,12 @@ DPdfAnnot *DPdfPage::createHightLightAnnot(const QList<QRectF> &rects, QString t
 
 bool DPdfPage::updateHightLightAnnot(DPdfAnnot *dAnnot, QColor color, QString text)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::updateHightLightAnnot index = " + QString::number(this->index()));
+
     d_func()->loadPage();
 
+    d_func()->annotsChanged();
+
     DPdfHightLightAnnot *hightLightAnnot = static_cast<DPdfHightLightAnnot *>(dAnnot);
 
     if (nullptr == hightLightAnnot)
@@ -907,8 +1140,6 @@ bool DPdfPage::updateHightLightAnnot(DPdfAnnot *dAnnot, QColor color, QString te
 
     int index = d_func()->allAnnots().indexOf(dAnnot);
 
-    DPdfMutexLocker locker("DPdfPage::updateHightLightAnnot index = " + QString::number(this->index()));
-
     FPDF_ANNOTATION annot = FPDFPage_GetAnnot(d_func()->m_page, index);
 
     if (color.isValid()) {
@@ -938,15 +1169,17 @@ bool DPdfPage::updateHightLightAnnot(DPdfAnnot *dAnnot, QColor color, QString te
 
 bool DPdfPage::removeAnnot(DPdfAnnot *dAnnot)
 {
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::removeAnnot index = " + QString::number(this->index()));
+
     d_func()->loadPage();
 
+    d_func()->annotsChanged();
+
     int index = d_func()->allAnnots().indexOf(dAnnot);
 
     if (index < 0)
         return false;
 
-    DPdfMutexLocker locker("DPdfPage::removeAnnot index = " + QString::number(this->index()));
-
     if (!FPDFPage_RemoveAnnot(d_func()->m_page, index))
         return false;
 
@@ -963,11 +1196,11 @@ bool DPdfPage::removeAnnot(DPdfAnnot *dAnnot)
 
 QVector<QRectF> DPdfPage::search(const QString &text, bool matchCase, bool wholeWords)
 {
-    d_func()->loadTextPage();
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::search index = " + QString::number(this->index()));
 
-    DPdfMutexLocker locker("DPdfPage::search index = " + QString::number(this->index()));
+    d_func()->loadTextPage();
 
-    QVector<QRectF> rectfs;
+    QVector<QPair<int, int>> ranges;
 
     unsigned long flags = 0x00000000;
 
@@ -981,15 +1214,31 @@ QVector<QRectF> DPdfPage::search(const QString &text, bool matchCase, bool whole
     if (schandle) {
         while (FPDFText_FindNext(schandle)) {
             int curSchIndex = FPDFText_GetSchResultIndex(schandle);
-            if (curSchIndex >= 0) {
-                const QVector<QRectF> &textrectfs = textRects(curSchIndex, text.length());
-                rectfs << textrectfs;
-            }
+            if (curSchIndex >= 0)
+                ranges.append(qMakePair(curSchIndex, FPDFText_GetSchCount(schandle)));
         };
     }
 
     FPDFText_FindClose(schandle);
-    return rectfs;
+
+    //所有结果一次取区域
+    return textRects(ranges);
+}
+
+QVector<DPdfSearchHit> DPdfPage::searchPatterns(const QStringList &literals, const QStringList &regexps, DPdfSearchTask::Flags flags, QStringList *errors)
+{
+    const DPdfPatternMatcher matcher(literals, regexps, flags);
+
+    if (nullptr != errors)
+        *errors = matcher.errors();
+
+    if (!matcher.errors().isEmpty() || matcher.isEmpty())
+        return QVector<DPdfSearchHit>();
+
+    //取出文字后匹配在锁外进行
+    const DPdfTextLayout &layout = textLayout();
+
+    return matcher.search(layout.text, layout.charRects);
 }
 
 QList<DPdfAnnot *> DPdfPage::annots()
@@ -1007,6 +1256,26 @@ QList<DPdfAnnot *> DPdfPage::annots()
     return dannots;
 }
 
+QList<DPdfAnnot *> DPdfPage::annotsAt(const QPointF &pos)
+{
+    DPdfMutexLocker locker(d_func()->m_docMutex, "DPdfPage::annotsAt index = " + QString::number(index()));
+
+    d_func()->loadAnnotGrid();
+
+    QList<DPdfAnnot *> annots;
+
+    const QVector<int> &items = d_func()->m_annotGrid.itemsAt(pos);
+
+    for (int item : items) {
+        DPdfAnnot *annot = d_func()->m_annotGridOwners[item];
+
+        if (!annots.contains(annot) && annot->pointIn(pos))
+            annots.append(annot);
+    }
+
+    return annots;
+}
+
 QList<DPdfAnnot *> DPdfPage::links()
 {
     QList<DPdfAnnot *> links;
@@ -0,0 +1,186 @@
+#ifndef DPDFPAGE_P_H
+#define DPDFPAGE_P_H
+
+#include "dpdfpage.h"
+#include "dpdfgridindex.h"
+
+#include "public/fpdfview.h"
+#include "public/fpdf_text.h"
+#include "public/fpdf_progressive.h"
+
+#include <QList>
+#include <QRectF>
+
+class DPdfDocPrivate;
+class DPdfPagePrivate
+{
+    friend class DPdfPage;
+    friend class DPdfRenderTaskPrivate;
+public:
+    DPdfPagePrivate(DPdfDocPrivate *doc, int index, qreal xRes, qreal yRes);
+
+    ~DPdfPagePrivate();
+
+public:
+    void loadPage();
+
+    void loadTextPage();
+
+    /**
+     * @brief 释放解析数据(页面内容,渲染缓存,文本页),再次使用时自动重新加载
+     */
+    void releaseParsedPage();
+
+    /**
+     * @brief 只释放文本页和字符索引,页面内容和渲染缓存保留 调用者需持有文档锁
+     */
+    void releaseTextPage();
+
+    /**
+     * @brief 分段渲染到image,每个检查点通过pause询问是否停止,持有文档锁直到渲染结束或被取消
+     * @param image 目标图片 大小与slice一致
+     * @param width 整页宽度 (in pixel)
+     * @param height 整页高度 (in pixel)
+     * @param slice 要渲染的切片 (in pixel)
+     * @param pause
+     * @return 渲染完成返回true,被取消或失败返回false
+     */
+    bool renderImage(QImage &image, int width, int height, const QRect &slice, IFSDK_PAUSE *pause);
+
+    /**
+     * @brief 按需建立字符区域的空间索引,随文本页一起释放 调用者需持有文档锁
+     */
+    void loadCharGrid();
+
+    /**
+     * @brief 按需建立注释区域的空间索引 调用者需持有文档锁
+     */
+    void loadAnnotGrid();
+
+    /**
+     * @brief 注释被添加,修改或删除,记录页面已修改并重建注释索引 调用者需持有文档锁
+     */
+    void annotsChanged();
+
+    /**
+     * @brief 估算解析数据占用的内存
+     * @return 字节数
+     */
+    qint64 parsedCost() const;
+
+    /**
+     * @brief 文档自身旋转
+     * @return
+     */
+    int oriRotation();
+
+    QSizeF sizeF() const
+    {
+        return QSizeF(m_width_pt * m_xRes / 72, m_height_pt * m_yRes / 72);
+    }
+
+    QRectF transPointToPixel(const QRectF &rect) const
+    {
+        return QRectF(rect.x() * m_xRes / 72, rect.y() * m_yRes / 72, rect.width() * m_xRes / 72, rect.height() * m_yRes / 72);
+    }
+    QSizeF transPointToPixel(const QSizeF &size) const
+    {
+        return QSizeF(size.width() * m_xRes / 72, size.height() * m_yRes / 72);
+    }
+    float transPointToPixelX(const float &x) const
+    {
+        return x * m_xRes / 72;
+    }
+    float transPointToPixelY(const float &y) const
+    {
+        return y * m_yRes / 72;
+    }
+
+    QRectF transPixelToPoint(const QRectF &rect) const
+    {
+        return QRectF(rect.x() * 72 / m_xRes, rect.y() * 72 / m_yRes, rect.width() * 72 / m_xRes, rect.height() * 72 / m_yRes);
+    }
+    QPointF transPixelToPoint(const QPointF &pos) const
+    {
+        return QPointF(pos.x() * 72 / m_xRes, pos.y() * 72 / m_yRes);
+    }
+    QSizeF transPixelToPoint(const QSizeF &size) const
+    {
+        return QSizeF(size.width() * 72 / m_xRes, size.height() * 72 / m_yRes);
+    }
+private:
+    /**
+     * @brief 加载注释,无需初始化，注释的坐标取值不受页自身旋转影响,goto部分link由于耗时，需要使用时调用initAnnot初始化
+     * @return 加载失败说明该页存在问题
+     */
+    bool loadAnnots();
+
+    /**
+     * @brief 获取所有注释
+     * @return
+     */
+    QList<DPdfAnnot *> allAnnots();
+
+    /**
+     * @brief 初始化需要延时的注释
+     * @param dAnnot
+     * @return
+     */
+    bool initAnnot(DPdfAnnot *dAnnot);
+    /**
+     * @brief 视图坐标转化为文档坐标
+     * @param rotation 文档自身旋转
+     * @param rect
+     * @return
+     */
+    FS_RECTF transRect(const int &rotation, const QRectF &rect);
+
+    /**
+     * @brief 文档坐标转化视图坐标
+     * @param rotation 文档自身旋转
+     * @param rect
+     * @return
+     */
+    QRectF transRect(const int &rotation, const FS_RECTF &rect);
+
+private:
+    DPdfDocPrivate *m_docPrivate = nullptr;
+
+    FPDF_DOCUMENT m_doc = nullptr;
+
+    QMutex *m_docMutex = nullptr;
+
+    int m_index = -1;
+
+    qreal m_width_pt = 0;
+
+    qreal m_height_pt = 0;
+
+    qreal m_xRes = 72;
+
+    qreal m_yRes = 72;
+
+    FPDF_PAGE m_page = nullptr;
+
+    FPDF_TEXTPAGE m_textPage = nullptr;
+
+    QList<DPdfAnnot *> m_dAnnots;
+
+    bool m_isValid = false;
+
+    bool m_isLoadAnnots = false;
+
+    //按字体上下沿计算的字符区域 (in pixel)
+    DPdfGridIndex m_charGrid;
+
+    bool m_isLoadCharGrid = false;
+
+    //注释的每个区域一项,m_annotGridOwners为对应的注释
+    DPdfGridIndex m_annotGrid;
+
+    QVector<DPdfAnnot *> m_annotGridOwners;
+
+    bool m_isLoadAnnotGrid = false;
+};
+
+#endif // DPDFPAGE_P_H
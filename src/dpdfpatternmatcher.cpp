@@ -0,0 +1,291 @@
+#include "dpdfpatternmatcher.h"
+
+#include <algorithm>
+
+namespace {
+
+//每扫描这么多字符检查一次取消
+const int cancelCheckInterval = 4096;
+
+inline bool isWordChar(const QChar &ch)
+{
+    return ch.isLetterOrNumber() || ch == QLatin1Char('_');
+}
+
+inline bool isLineBreak(const QChar &ch)
+{
+    return ch == QLatin1Char('\n') || ch == QLatin1Char('\r');
+}
+
+}
+
+DPdfPatternMatcher::DPdfPatternMatcher(const QStringList &literals, const QStringList &regexps, DPdfSearchTask::Flags flags)
+    : m_flags(flags)
+{
+    m_nodes.append(Node());
+
+    m_literalLengths.resize(literals.size());
+
+    for (int i = 0; i < literals.size(); ++i) {
+        if (literals[i].isEmpty())
+            continue;
+
+        addLiteral(literals[i], i);
+
+        m_literals.append(literals[i]);
+
+        m_literalLengths[i] = literals[i].size();
+    }
+
+    buildLinks();
+
+    QRegularExpression::PatternOptions options = QRegularExpression::UseUnicodePropertiesOption;
+
+    if (!m_flags.testFlag(DPdfSearchTask::MATCH_CASE))
+        options |= QRegularExpression::CaseInsensitiveOption;
+
+    for (int i = 0; i < regexps.size(); ++i) {
+        if (regexps[i].isEmpty())
+            continue;
+
+        QRegularExpression regexp(regexps[i], options);
+
+        if (!regexp.isValid()) {
+            m_errors.append(QString("pattern %1: %2 at offset %3")
+                            .arg(literals.size() + i)
+                            .arg(regexp.errorString())
+                            .arg(regexp.patternErrorOffset()));
+            continue;
+        }
+
+        //会被多页多线程反复使用,提前编译
+        regexp.optimize();
+
+        m_regexps.append(regexp);
+        m_regexpPatterns.append(literals.size() + i);
+    }
+}
+
+bool DPdfPatternMatcher::isEmpty() const
+{
+    return m_nodes.size() <= 1 && m_regexps.isEmpty();
+}
+
+QStringList DPdfPatternMatcher::errors() const
+{
+    return m_errors;
+}
+
+bool DPdfPatternMatcher::isLiteralOnly() const
+{
+    return m_regexps.isEmpty();
+}
+
+QStringList DPdfPatternMatcher::literals() const
+{
+    return m_literals;
+}
+
+QVector<DPdfSearchHit> DPdfPatternMatcher::search(const QString &text, const QVector<QRectF> &rects, const QAtomicInt *cancelled) const
+{
+    QVector<DPdfSearchHit> hits;
+
+    const bool wholeWords = m_flags.testFlag(DPdfSearchTask::WHOLE_WORDS);
+
+    if (m_nodes.size() > 1) {
+        //同一模式上一个结果的结束位置,保证同一模式的结果不重叠
+        QVector<int> lastEnds(m_literalLengths.size(), 0);
+
+        int node = 0;
+
+        for (int i = 0; i < text.size(); ++i) {
+            if (nullptr != cancelled && 0 == i % cancelCheckInterval && cancelled->load())
+                return QVector<DPdfSearchHit>();
+
+            const ushort ch = fold(text[i].unicode());
+
+            int next = child(node, ch);
+
+            while (next < 0 && node != 0) {
+                node = m_nodes[node].fail;
+                next = child(node, ch);
+            }
+
+            node = qMax(0, next);
+
+            for (int out = node; out >= 0; out = m_nodes[out].output) {
+                for (int pattern : m_nodes[out].patterns) {
+                    const int end = i + 1;
+                    const int start = end - m_literalLengths[pattern];
+
+                    if (start < lastEnds[pattern] || (wholeWords && !isWholeWord(text, start, end)))
+                        continue;
+
+                    lastEnds[pattern] = end;
+
+                    DPdfSearchHit hit;
+                    hit.charIndex = start;
+                    hit.charCount = end - start;
+                    hit.pattern = pattern;
+
+                    hits.append(hit);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < m_regexps.size(); ++i) {
+        QRegularExpressionMatchIterator it = m_regexps[i].globalMatch(text);
+
+        while (it.hasNext()) {
+            if (nullptr != cancelled && cancelled->load())
+                return QVector<DPdfSearchHit>();
+
+            const QRegularExpressionMatch &match = it.next();
+
+            const int start = match.capturedStart();
+            const int end = match.capturedEnd();
+
+            if (start >= end || (wholeWords && !isWholeWord(text, start, end)))
+                continue;
+
+            DPdfSearchHit hit;
+            hit.charIndex = start;
+            hit.charCount = end - start;
+            hit.pattern = m_regexpPatterns[i];
+
+            hits.append(hit);
+        }
+    }
+
+    std::sort(hits.begin(), hits.end(), [](const DPdfSearchHit &a, const DPdfSearchHit &b) {
+        if (a.charIndex != b.charIndex)
+            return a.charIndex < b.charIndex;
+
+        return a.pattern < b.pattern;
+    });
+
+    for (DPdfSearchHit &hit : hits)
+        hit.rects = lineRects(text, rects, hit.charIndex, hit.charIndex + hit.charCount);
+
+    return hits;
+}
+
+QVector<QRectF> DPdfPatternMatcher::lineRects(const QString &text, const QVector<QRectF> &rects, int start, int end)
+{
+    QVector<QRectF> lines;
+
+    QRectF line;
+
+    end = qMin(end, rects.size());
+
+    for (int i = start; i < end; ++i) {
+        const QRectF &rect = rects[i];
+
+        if (isLineBreak(text[i]) || rect.isNull())
+            continue;
+
+        if (!line.isNull() && rect.top() < line.bottom() && rect.bottom() > line.top()) {
+            line |= rect;
+        } else {
+            if (!line.isNull())
+                lines.append(line);
+
+            line = rect;
+        }
+    }
+
+    if (!line.isNull())
+        lines.append(line);
+
+    return lines;
+}
+
+bool DPdfPatternMatcher::isWholeWord(const QString &text, int start, int end)
+{
+    return !(start > 0 && isWordChar(text[start - 1])) && !(end < text.size() && isWordChar(text[end]));
+}
+
+int DPdfPatternMatcher::child(int node, ushort ch) const
+{
+    const QVector<Edge> &edges = m_nodes[node].edges;
+
+    auto it = std::lower_bound(edges.begin(), edges.end(), ch, [](const Edge &edge, ushort value) {
+        return edge.ch < value;
+    });
+
+    return (it != edges.end() && it->ch == ch) ? it->node : -1;
+}
+
+ushort DPdfPatternMatcher::fold(ushort ch) const
+{
+    if (m_flags.testFlag(DPdfSearchTask::MATCH_CASE))
+        return ch;
+
+    //逐个UTF-16单元折叠,与QString的不区分大小写比较一致
+    return static_cast<ushort>(QChar::toCaseFolded(ch));
+}
+
+void DPdfPatternMatcher::addLiteral(const QString &literal, int pattern)
+{
+    int node = 0;
+
+    for (const QChar &c : literal) {
+        const ushort ch = fold(c.unicode());
+
+        int next = child(node, ch);
+
+        if (next < 0) {
+            next = m_nodes.size();
+            m_nodes.append(Node());
+
+            QVector<Edge> &edges = m_nodes[node].edges;
+
+            auto it = std::lower_bound(edges.begin(), edges.end(), ch, [](const Edge &edge, ushort value) {
+                return edge.ch < value;
+            });
+
+            edges.insert(it, Edge{ch, next});
+        }
+
+        node = next;
+    }
+
+    m_nodes[node].patterns.append(pattern);
+}
+
+void DPdfPatternMatcher::buildLinks()
+{
+    //按层次遍历,父节点的链接总是先于子节点建立
+    QVector<int> queue;
+
+    queue.append(0);
+
+    for (int i = 0; i < queue.size(); ++i) {
+        const int node = queue[i];
+
+        const QVector<Edge> edges = m_nodes[node].edges;
+
+        for (const Edge &edge : edges) {
+            int fail = 0;
+
+            if (node != 0) {
+                int state = m_nodes[node].fail;
+                int next = child(state, edge.ch);
+
+                while (next < 0 && state != 0) {
+                    state = m_nodes[state].fail;
+                    next = child(state, edge.ch);
+                }
+
+                fail = qMax(0, next);
+            }
+
+            Node &target = m_nodes[edge.node];
+            target.fail = fail;
+            target.output = m_nodes[fail].patterns.isEmpty() ? m_nodes[fail].output : fail;
+
+            queue.append(edge.node);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+#ifndef DPDFPATTERNMATCHER_H
+#define DPDFPATTERNMATCHER_H
+
+#include "dpdfsearchtask.h"
+
+#include <QAtomicInt>
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 多模式匹配 字面模式建立Aho-Corasick自动机,一遍扫描找出所有模式的所有位置;正则模式逐个扫描
+ * 建立后只读,可在多个线程中同时使用
+ */
+class DPdfPatternMatcher
+{
+public:
+    /**
+     * @brief 建立匹配器 空模式被忽略,无效的正则不参与匹配并记录在errors()中
+     * @param literals 字面模式
+     * @param regexps 正则模式 (QRegularExpression语法)
+     * @param flags 区分大小写,整个单词 对两类模式都生效
+     */
+    DPdfPatternMatcher(const QStringList &literals, const QStringList &regexps, DPdfSearchTask::Flags flags);
+
+    /**
+     * @brief 没有任何有效模式
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief 无效的正则 每个一条,包含模式编号,错误原因和位置
+     */
+    QStringList errors() const;
+
+    /**
+     * @brief 只有字面模式,可以用全文索引排除页面
+     */
+    bool isLiteralOnly() const;
+
+    /**
+     * @brief 有效的字面模式
+     */
+    QStringList literals() const;
+
+    /**
+     * @brief 在一页文字中查找所有模式,结果按位置排序,同一位置按模式编号排序
+     * 不同模式的结果可以重叠,同一模式的结果互不重叠
+     * @param text 每个字符一个QChar
+     * @param rects 与text一一对应的字符区域
+     * @param cancelled 不为空且被置位时提前返回
+     * @return
+     */
+    QVector<DPdfSearchHit> search(const QString &text, const QVector<QRectF> &rects, const QAtomicInt *cancelled = nullptr) const;
+
+    /**
+     * @brief 字符范围按行合并的区域,跳过换行和没有区域的字符
+     * @param text
+     * @param rects
+     * @param start
+     * @param end 不含
+     * @return
+     */
+    static QVector<QRectF> lineRects(const QString &text, const QVector<QRectF> &rects, int start, int end);
+
+    /**
+     * @brief 范围两侧不是单词字符
+     */
+    static bool isWholeWord(const QString &text, int start, int end);
+
+private:
+    struct Edge {
+        ushort ch;
+        int node;
+    };
+
+    struct Node {
+        //按ch升序
+        QVector<Edge> edges;
+
+        //最长的真后缀所在节点
+        int fail = 0;
+
+        //后缀链上下一个有模式结束的节点
+        int output = -1;
+
+        //在此结束的模式编号
+        QVector<int> patterns;
+    };
+
+    int child(int node, ushort ch) const;
+
+    ushort fold(ushort ch) const;
+
+    void addLiteral(const QString &literal, int pattern);
+
+    void buildLinks();
+
+private:
+    DPdfSearchTask::Flags m_flags;
+
+    QVector<Node> m_nodes;
+
+    QStringList m_literals;
+
+    //字面模式长度 编号即下标
+    QVector<int> m_literalLengths;
+
+    QVector<QRegularExpression> m_regexps;
+
+    //正则的模式编号 字面模式在前,正则在后,编号与传入顺序一致
+    QVector<int> m_regexpPatterns;
+
+    QStringList m_errors;
+};
+
+#endif // DPDFPATTERNMATCHER_H
@@ -0,0 +1,231 @@
+#include "dpdfrendertask.h"
+#include "dpdfrendertask_p.h"
+#include "dpdfdoc_p.h"
+#include "dpdfpage_p.h"
+
+#include <QElapsedTimer>
+
+DPdfRenderTaskPrivate::DPdfRenderTaskPrivate(DPdfRenderTask *q, DPdfDocPrivate *doc, DPdfPagePrivate *page, int width, int height, const QRect &slice)
+    : q_ptr(q), m_docPrivate(doc), m_pagePrivate(page), m_pageIndex(page->m_index), m_width(width), m_height(height), m_slice(slice)
+{
+    //任务对象由DPdfRenderTask持有,线程池不负责释放
+    setAutoDelete(false);
+
+    m_pause.version = 1;
+    m_pause.NeedToPauseNow = &DPdfRenderTaskPrivate::needToPauseNow;
+    m_pause.user = this;
+}
+
+void DPdfRenderTaskPrivate::run()
+{
+    if (m_cancelled.load()) {
+        finish(DPdfRenderTask::CANCELLED, QImage());
+    } else {
+        m_mutex.lock();
+        m_status = DPdfRenderTask::RUNNING;
+        m_mutex.unlock();
+
+        QImage image(m_slice.width(), m_slice.height(), QImage::Format_ARGB32);
+
+        bool done = false;
+
+        if (!image.isNull()) {
+            image.fill(0xFFFFFFFF);
+            done = m_pagePrivate->renderImage(image, m_width, m_height, m_slice, &m_pause);
+        }
+
+        if (m_cancelled.load())
+            finish(DPdfRenderTask::CANCELLED, QImage());
+        else if (done)
+            finish(DPdfRenderTask::FINISHED, image);
+        else
+            finish(DPdfRenderTask::FAILED, QImage());
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_exited = true;
+    m_condition.wakeAll();
+}
+
+void DPdfRenderTaskPrivate::cancel()
+{
+    m_cancelled.store(1);
+
+    QMutexLocker locker(&m_mutex);
+
+    if (nullptr == m_docPrivate || m_exited)
+        return;
+
+    //尚未开始执行的任务直接移出队列,不再等待前面的任务
+    if (m_docPrivate->m_renderPool.tryTake(this)) {
+        locker.unlock();
+
+        finish(DPdfRenderTask::CANCELLED, QImage());
+
+        locker.relock();
+        m_exited = true;
+        m_condition.wakeAll();
+    }
+}
+
+void DPdfRenderTaskPrivate::detach()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_docPrivate = nullptr;
+    m_pagePrivate = nullptr;
+
+    const bool cancelled = (DPdfRenderTask::WAITING == m_status || DPdfRenderTask::RUNNING == m_status);
+
+    if (cancelled)
+        m_status = DPdfRenderTask::CANCELLED;
+
+    m_exited = true;
+    m_condition.wakeAll();
+
+    locker.unlock();
+
+    //与正常取消一致通知等待者,调用方持有detachMutex(),任务此时不会析构
+    if (cancelled) {
+        DPdfRenderTask *q = q_ptr;
+
+        QMetaObject::invokeMethod(q, [q]() {
+            emit q->finished();
+        }, Qt::QueuedConnection);
+    }
+}
+
+QMutex *DPdfRenderTaskPrivate::detachMutex()
+{
+    static QMutex mutex;
+
+    return &mutex;
+}
+
+void DPdfRenderTaskPrivate::waitForExit()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_exited)
+        m_condition.wait(&m_mutex);
+}
+
+FPDF_BOOL DPdfRenderTaskPrivate::needToPauseNow(IFSDK_PAUSE *pause)
+{
+    DPdfRenderTaskPrivate *task = static_cast<DPdfRenderTaskPrivate *>(pause->user);
+
+    if (task->m_cancelled.load())
+        return true;
+
+    //回调发生在渲染过程中,文档锁已由渲染线程持有
+    task->setProgress(FPDF_RenderPage_GetProgress(task->m_pagePrivate->m_page));
+
+    return false;
+}
+
+void DPdfRenderTaskPrivate::setProgress(int progress)
+{
+    if (progress <= m_progress.load())
+        return;
+
+    m_progress.store(progress);
+
+    DPdfRenderTask *q = q_ptr;
+
+    //在任务所在线程触发,任务析构后未处理的事件会被丢弃
+    QMetaObject::invokeMethod(q, [q, progress]() {
+        emit q->progressChanged(progress);
+    }, Qt::QueuedConnection);
+}
+
+void DPdfRenderTaskPrivate::finish(DPdfRenderTask::Status status, const QImage &image)
+{
+    if (DPdfRenderTask::FINISHED == status)
+        setProgress(100);
+
+    m_mutex.lock();
+    m_status = status;
+    m_image = image;
+    m_condition.wakeAll();
+    m_mutex.unlock();
+
+    DPdfRenderTask *q = q_ptr;
+
+    QMetaObject::invokeMethod(q, [q]() {
+        emit q->finished();
+    }, Qt::QueuedConnection);
+}
+
+DPdfRenderTask::DPdfRenderTask(DPdfDocPrivate *doc, DPdfPagePrivate *page, int width, int height, const QRect &slice)
+    : d_ptr(new DPdfRenderTaskPrivate(this, doc, page, width, height, slice))
+{
+    doc->startRenderTask(d_func());
+}
+
+DPdfRenderTask::~DPdfRenderTask()
+{
+    d_func()->cancel();
+
+    d_func()->waitForExit();
+
+    //文档可能正在另一线程析构并断开任务,持有detachMutex()期间文档不会越过断开这一步
+    QMutexLocker detachLocker(DPdfRenderTaskPrivate::detachMutex());
+
+    d_func()->m_mutex.lock();
+    DPdfDocPrivate *doc = d_func()->m_docPrivate;
+    d_func()->m_mutex.unlock();
+
+    if (nullptr != doc)
+        doc->removeRenderTask(d_func());
+}
+
+int DPdfRenderTask::pageIndex() const
+{
+    return d_func()->m_pageIndex;
+}
+
+DPdfRenderTask::Status DPdfRenderTask::status() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_status;
+}
+
+int DPdfRenderTask::progress() const
+{
+    return d_func()->m_progress.load();
+}
+
+QImage DPdfRenderTask::image() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_image;
+}
+
+void DPdfRenderTask::cancel()
+{
+    d_func()->cancel();
+}
+
+bool DPdfRenderTask::wait(int msecs)
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (WAITING == d_func()->m_status || RUNNING == d_func()->m_status) {
+        if (msecs < 0) {
+            d_func()->m_condition.wait(&d_func()->m_mutex);
+            continue;
+        }
+
+        qint64 remaining = msecs - timer.elapsed();
+
+        if (remaining <= 0 || !d_func()->m_condition.wait(&d_func()->m_mutex, static_cast<unsigned long>(remaining)))
+            return WAITING != d_func()->m_status && RUNNING != d_func()->m_status;
+    }
+
+    return true;
+}
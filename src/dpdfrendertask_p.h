@@ -0,0 +1,88 @@
+#ifndef DPDFRENDERTASK_P_H
+#define DPDFRENDERTASK_P_H
+
+#include "dpdfrendertask.h"
+
+#include "public/fpdf_progressive.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QRect>
+#include <QRunnable>
+#include <QWaitCondition>
+
+class DPdfDocPrivate;
+class DPdfPagePrivate;
+class DPdfRenderTaskPrivate : public QRunnable
+{
+    friend class DPdfRenderTask;
+public:
+    DPdfRenderTaskPrivate(DPdfRenderTask *q, DPdfDocPrivate *doc, DPdfPagePrivate *page, int width, int height, const QRect &slice);
+
+    void run() override;
+
+    /**
+     * @brief 标记取消,仍在队列中的任务直接移出并结束
+     */
+    void cancel();
+
+    /**
+     * @brief 文档即将析构,任务不再访问文档和页面 未完成的任务置为取消并触发finished() 调用者需持有detachMutex()
+     */
+    void detach();
+
+    /**
+     * @brief 保护任务与文档的关联 文档断开任务和任务析构时从文档移除自身都需持有,
+     * 保证任务看到关联时文档尚未析构;先于文档的m_renderTasksMutex加锁
+     */
+    static QMutex *detachMutex();
+
+    /**
+     * @brief 等待run()退出,之后可以安全释放任务
+     */
+    void waitForExit();
+
+private:
+    /**
+     * @brief IFSDK_PAUSE回调 在渲染的检查点被调用,取消时要求pdfium停止,同时上报进度
+     */
+    static FPDF_BOOL needToPauseNow(IFSDK_PAUSE *pause);
+
+    void setProgress(int progress);
+
+    void finish(DPdfRenderTask::Status status, const QImage &image);
+
+private:
+    DPdfRenderTask *q_ptr = nullptr;
+
+    DPdfDocPrivate *m_docPrivate = nullptr;
+
+    DPdfPagePrivate *m_pagePrivate = nullptr;
+
+    int m_pageIndex = -1;
+
+    int m_width = 0;
+
+    int m_height = 0;
+
+    QRect m_slice;
+
+    IFSDK_PAUSE m_pause;
+
+    QAtomicInt m_cancelled;
+
+    QAtomicInt m_progress;
+
+    mutable QMutex m_mutex;
+
+    QWaitCondition m_condition;
+
+    DPdfRenderTask::Status m_status = DPdfRenderTask::WAITING;
+
+    QImage m_image;
+
+    //run()已退出或任务未曾执行
+    bool m_exited = false;
+};
+
+#endif // DPDFRENDERTASK_P_H
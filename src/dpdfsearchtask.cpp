@@ -0,0 +1,329 @@
+#include "dpdfsearchtask.h"
+#include "dpdfsearchtask_p.h"
+#include "dpdfdoc_p.h"
+#include "dpdfpatternmatcher.h"
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+
+//文字提取在文档锁上串行,线程再多也只能并行匹配
+const int maxSearchThreads = 4;
+
+class DPdfSearchWorker : public QRunnable
+{
+public:
+    explicit DPdfSearchWorker(DPdfSearchTaskPrivate *task) : m_task(task)
+    {
+    }
+
+    void run() override
+    {
+        m_task->searchPages();
+    }
+
+private:
+    DPdfSearchTaskPrivate *m_task = nullptr;
+};
+
+}
+
+DPdfSearchTaskPrivate::DPdfSearchTaskPrivate(DPdfSearchTask *q, DPdfDocPrivate *doc, const QString &text, DPdfSearchTask::Flags flags, int maxHits, qreal xRes, qreal yRes)
+    : q_ptr(q), m_docPrivate(doc), m_text(text), m_flags(flags), m_maxHits(maxHits), m_xRes(xRes), m_yRes(yRes), m_pageCount(doc->m_pageCount)
+{
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), maxSearchThreads));
+
+    m_candidates = doc->candidatePages(text);
+}
+
+DPdfSearchTaskPrivate::DPdfSearchTaskPrivate(DPdfSearchTask *q, DPdfDocPrivate *doc, const QSharedPointer<const DPdfPatternMatcher> &matcher, int maxHits, qreal xRes, qreal yRes)
+    : q_ptr(q), m_docPrivate(doc), m_matcher(matcher), m_maxHits(maxHits), m_xRes(xRes), m_yRes(yRes), m_pageCount(doc->m_pageCount)
+{
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), maxSearchThreads));
+
+    //正则无法用索引判断,只有字面模式时取各模式候选页的并集
+    if (!matcher->isLiteralOnly())
+        return;
+
+    const QStringList &literals = matcher->literals();
+
+    for (const QString &literal : literals) {
+        const QVector<bool> &candidates = doc->candidatePages(literal);
+
+        if (candidates.isEmpty()) {
+            m_candidates.clear();
+            return;
+        }
+
+        if (m_candidates.isEmpty())
+            m_candidates.fill(false, m_pageCount);
+
+        for (int i = 0; i < m_pageCount && i < candidates.size(); ++i)
+            m_candidates[i] = m_candidates[i] || candidates[i];
+    }
+}
+
+void DPdfSearchTaskPrivate::start()
+{
+    const int workers = qMax(1, qMin(m_pool.maxThreadCount(), m_pageCount));
+
+    m_runningWorkers.store(workers);
+
+    for (int i = 0; i < workers; ++i)
+        m_pool.start(new DPdfSearchWorker(this));
+}
+
+void DPdfSearchTaskPrivate::cancel()
+{
+    m_cancelled.store(1);
+}
+
+void DPdfSearchTaskPrivate::detach()
+{
+    cancel();
+
+    m_pool.waitForDone();
+
+    QMutexLocker locker(&m_mutex);
+
+    m_docPrivate = nullptr;
+}
+
+QMutex *DPdfSearchTaskPrivate::detachMutex()
+{
+    static QMutex mutex;
+
+    return &mutex;
+}
+
+void DPdfSearchTaskPrivate::searchPages()
+{
+    while (!m_cancelled.load() && !m_stopped.load()) {
+        const int index = m_nextIndex.fetchAndAddOrdered(1);
+
+        if (index >= m_pageCount)
+            break;
+
+        //索引表明不可能命中的页面不再提取文字
+        if (!m_candidates.isEmpty() && !m_candidates[index]) {
+            pageDone(index, QVector<DPdfSearchHit>());
+            continue;
+        }
+
+        QString text;
+        QVector<QRectF> rects;
+
+        QVector<DPdfSearchHit> hits;
+
+        if (!m_cancelled.load()) {
+            if (m_docPrivate->extractPageText(index, m_xRes, m_yRes, text, &rects)) {
+                hits = m_matcher.isNull() ? match(text, rects) : m_matcher->search(text, rects, &m_cancelled);
+            } else if (!m_docPrivate->isPageDataAvail(index)) {
+                QMutexLocker locker(&m_mutex);
+                m_unsearchedPages.append(index);
+            }
+        }
+
+        pageDone(index, hits);
+    }
+
+    //最后退出的线程结束任务
+    if (!m_runningWorkers.deref())
+        finish();
+}
+
+QVector<DPdfSearchHit> DPdfSearchTaskPrivate::match(const QString &text, const QVector<QRectF> &rects) const
+{
+    QVector<DPdfSearchHit> hits;
+
+    const Qt::CaseSensitivity cs = m_flags.testFlag(DPdfSearchTask::MATCH_CASE) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    const bool wholeWords = m_flags.testFlag(DPdfSearchTask::WHOLE_WORDS);
+
+    const int length = m_text.size();
+
+    int from = 0;
+
+    while (!m_cancelled.load()) {
+        const int start = text.indexOf(m_text, from, cs);
+
+        if (start < 0)
+            break;
+
+        const int end = start + length;
+
+        if (wholeWords && !DPdfPatternMatcher::isWholeWord(text, start, end)) {
+            from = start + 1;
+            continue;
+        }
+
+        DPdfSearchHit hit;
+        hit.charIndex = start;
+        hit.charCount = length;
+
+        //同一行的字符合并为一个区域
+        hit.rects = DPdfPatternMatcher::lineRects(text, rects, start, end);
+
+        hits.append(hit);
+
+        from = end;
+    }
+
+    return hits;
+}
+
+void DPdfSearchTaskPrivate::pageDone(int index, const QVector<DPdfSearchHit> &hits)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_donePages.insert(index, hits);
+
+    while (!m_stopped.load() && m_donePages.contains(m_nextEmitIndex)) {
+        const int pageIndex = m_nextEmitIndex++;
+
+        QVector<DPdfSearchHit> pageHits = m_donePages.take(pageIndex);
+
+        if (m_maxHits > 0 && m_hitCount + pageHits.size() >= m_maxHits) {
+            pageHits.resize(m_maxHits - m_hitCount);
+            m_stopped.store(1);
+        }
+
+        if (pageHits.isEmpty())
+            continue;
+
+        m_hitCount += pageHits.size();
+
+        m_results.insert(pageIndex, pageHits);
+
+        DPdfSearchTask *q = q_ptr;
+
+        //在任务所在线程触发,任务析构后未处理的事件会被丢弃
+        QMetaObject::invokeMethod(q, [q, pageIndex, pageHits]() {
+            emit q->found(pageIndex, pageHits);
+        }, Qt::QueuedConnection);
+    }
+
+    if (m_stopped.load())
+        m_donePages.clear();
+}
+
+void DPdfSearchTaskPrivate::finish()
+{
+    m_mutex.lock();
+    const bool complete = m_stopped.load() || m_nextEmitIndex >= m_pageCount;
+    if (!complete)
+        m_status = DPdfSearchTask::CANCELLED;
+    else if (!m_stopped.load() && !m_unsearchedPages.isEmpty())
+        m_status = DPdfSearchTask::INCOMPLETE;
+    else
+        m_status = DPdfSearchTask::FINISHED;
+    std::sort(m_unsearchedPages.begin(), m_unsearchedPages.end());
+    m_donePages.clear();
+    m_condition.wakeAll();
+    m_mutex.unlock();
+
+    DPdfSearchTask *q = q_ptr;
+
+    QMetaObject::invokeMethod(q, [q]() {
+        emit q->finished();
+    }, Qt::QueuedConnection);
+}
+
+DPdfSearchTask::DPdfSearchTask(DPdfDocPrivate *doc, const QString &text, Flags flags, int maxHits, qreal xRes, qreal yRes)
+    : d_ptr(new DPdfSearchTaskPrivate(this, doc, text, flags, maxHits, xRes, yRes))
+{
+    qRegisterMetaType<QVector<DPdfSearchHit>>("QVector<DPdfSearchHit>");
+
+    doc->startSearchTask(d_func());
+}
+
+DPdfSearchTask::DPdfSearchTask(DPdfDocPrivate *doc, const QSharedPointer<const DPdfPatternMatcher> &matcher, int maxHits, qreal xRes, qreal yRes)
+    : d_ptr(new DPdfSearchTaskPrivate(this, doc, matcher, maxHits, xRes, yRes))
+{
+    qRegisterMetaType<QVector<DPdfSearchHit>>("QVector<DPdfSearchHit>");
+
+    doc->startSearchTask(d_func());
+}
+
+DPdfSearchTask::~DPdfSearchTask()
+{
+    d_func()->cancel();
+
+    d_func()->m_pool.waitForDone();
+
+    //文档可能正在另一线程析构并断开任务,持有detachMutex()期间文档不会越过断开这一步
+    QMutexLocker detachLocker(DPdfSearchTaskPrivate::detachMutex());
+
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    DPdfDocPrivate *doc = d_func()->m_docPrivate;
+
+    locker.unlock();
+
+    if (nullptr != doc)
+        doc->removeSearchTask(d_func());
+}
+
+QString DPdfSearchTask::text() const
+{
+    return d_func()->m_text;
+}
+
+DPdfSearchTask::Status DPdfSearchTask::status() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_status;
+}
+
+int DPdfSearchTask::hitCount() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_hitCount;
+}
+
+QMap<int, QVector<DPdfSearchHit>> DPdfSearchTask::results() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_results;
+}
+
+QList<int> DPdfSearchTask::unsearchedPages() const
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    return d_func()->m_unsearchedPages;
+}
+
+void DPdfSearchTask::cancel()
+{
+    d_func()->cancel();
+}
+
+bool DPdfSearchTask::wait(int msecs)
+{
+    QMutexLocker locker(&d_func()->m_mutex);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while (RUNNING == d_func()->m_status) {
+        if (msecs < 0) {
+            d_func()->m_condition.wait(&d_func()->m_mutex);
+            continue;
+        }
+
+        qint64 remaining = msecs - timer.elapsed();
+
+        if (remaining <= 0 || !d_func()->m_condition.wait(&d_func()->m_mutex, static_cast<unsigned long>(remaining)))
+            return RUNNING != d_func()->m_status;
+    }
+
+    return true;
+}
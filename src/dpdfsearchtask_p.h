@@ -0,0 +1,113 @@
+#ifndef DPDFSEARCHTASK_P_H
+#define DPDFSEARCHTASK_P_H
+
+#include "dpdfsearchtask.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class DPdfDocPrivate;
+class DPdfSearchTaskPrivate
+{
+    friend class DPdfSearchTask;
+public:
+    DPdfSearchTaskPrivate(DPdfSearchTask *q, DPdfDocPrivate *doc, const QString &text, DPdfSearchTask::Flags flags, int maxHits, qreal xRes, qreal yRes);
+
+    DPdfSearchTaskPrivate(DPdfSearchTask *q, DPdfDocPrivate *doc, const QSharedPointer<const DPdfPatternMatcher> &matcher, int maxHits, qreal xRes, qreal yRes);
+
+    /**
+     * @brief 启动搜索线程
+     */
+    void start();
+
+    /**
+     * @brief 标记取消,搜索线程在当前页完成后退出
+     */
+    void cancel();
+
+    /**
+     * @brief 文档即将析构,取消并等待搜索线程退出,之后不再访问文档 调用者需持有detachMutex()
+     */
+    void detach();
+
+    /**
+     * @brief 串行化文档断开任务与任务析构,先于文档的m_searchTasksMutex加锁
+     */
+    static QMutex *detachMutex();
+
+    /**
+     * @brief 搜索线程 依次领取页面,持文档锁提取文字,锁外匹配
+     */
+    void searchPages();
+
+private:
+    /**
+     * @brief 在一页文字中查找所有结果
+     */
+    QVector<DPdfSearchHit> match(const QString &text, const QVector<QRectF> &rects) const;
+
+    /**
+     * @brief 一页搜索完成,按页序送出已完成的连续页面,达到结果数上限后停止
+     */
+    void pageDone(int index, const QVector<DPdfSearchHit> &hits);
+
+    void finish();
+
+private:
+    DPdfSearchTask *q_ptr = nullptr;
+
+    DPdfDocPrivate *m_docPrivate = nullptr;
+
+    QString m_text;
+
+    DPdfSearchTask::Flags m_flags;
+
+    //多模式搜索时不为空,代替m_text
+    QSharedPointer<const DPdfPatternMatcher> m_matcher;
+
+    int m_maxHits = -1;
+
+    qreal m_xRes = 72;
+
+    qreal m_yRes = 72;
+
+    int m_pageCount = 0;
+
+    //全文索引判断可能命中的页面,没有索引时为空
+    QVector<bool> m_candidates;
+
+    QThreadPool m_pool;
+
+    //下一个待领取的页面
+    QAtomicInt m_nextIndex;
+
+    QAtomicInt m_runningWorkers;
+
+    QAtomicInt m_cancelled;
+
+    //已达到结果数上限
+    QAtomicInt m_stopped;
+
+    mutable QMutex m_mutex;
+
+    QWaitCondition m_condition;
+
+    DPdfSearchTask::Status m_status = DPdfSearchTask::RUNNING;
+
+    //已完成但前面还有页面未完成,暂不送出
+    QMap<int, QVector<DPdfSearchHit>> m_donePages;
+
+    //下一个送出的页面
+    int m_nextEmitIndex = 0;
+
+    int m_hitCount = 0;
+
+    QMap<int, QVector<DPdfSearchHit>> m_results;
+
+    //数据未到达的页面 不计为没有结果
+    QList<int> m_unsearchedPages;
+};
+
+#endif // DPDFSEARCHTASK_P_H
@@ -0,0 +1,247 @@
+#include "dpdftextexporter.h"
+#include "dpdfdoc_p.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRunnable>
+#include <QThread>
+
+namespace {
+
+//文字提取在文档锁上串行,线程再多也只能并行格式化
+const int maxExportThreads = 4;
+
+//每个线程最多领先写入位置的页数
+const int pagesPerThread = 2;
+
+class DPdfTextExportWorker : public QRunnable
+{
+public:
+    explicit DPdfTextExportWorker(DPdfTextExporter *exporter) : m_exporter(exporter)
+    {
+    }
+
+    void run() override
+    {
+        m_exporter->exportPages();
+    }
+
+private:
+    DPdfTextExporter *m_exporter = nullptr;
+};
+
+QJsonArray rectToJson(const QRectF &rect)
+{
+    return QJsonArray{rect.x(), rect.y(), rect.width(), rect.height()};
+}
+
+struct TextLine {
+    QString text;
+    QRectF rect;
+};
+
+/**
+ * @brief 按pdfium生成的换行拆分为行,行区域为字符区域的并集
+ */
+QVector<TextLine> splitLines(const QString &text, const QVector<QRectF> &rects)
+{
+    QVector<TextLine> lines;
+
+    TextLine line;
+
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar &ch = text[i];
+
+        if (ch == QLatin1Char('\r') || ch == QLatin1Char('\n')) {
+            //\r\n为一个换行
+            if (ch == QLatin1Char('\r') && i + 1 < text.size() && text[i + 1] == QLatin1Char('\n'))
+                ++i;
+
+            if (!line.text.isEmpty())
+                lines.append(line);
+
+            line = TextLine();
+            continue;
+        }
+
+        line.text.append(ch);
+
+        if (i < rects.size() && !rects[i].isNull())
+            line.rect |= rects[i];
+    }
+
+    if (!line.text.isEmpty())
+        lines.append(line);
+
+    return lines;
+}
+
+/**
+ * @brief 相邻行间距不超过行高且水平方向有重叠时属于同一块
+ */
+bool isSameBlock(const QRectF &block, const QRectF &last, const QRectF &line)
+{
+    if (block.isNull() || line.isNull())
+        return false;
+
+    const qreal lineHeight = qMax(last.height(), line.height());
+
+    const qreal gap = line.top() - last.bottom();
+
+    if (gap > lineHeight || gap < -lineHeight)
+        return false;
+
+    return line.left() < block.right() && line.right() > block.left();
+}
+
+}
+
+DPdfTextExporter::DPdfTextExporter(DPdfDocPrivate *doc, QIODevice *device, DPdfDoc::TextFormat format, qreal xRes, qreal yRes)
+    : m_docPrivate(doc), m_device(device), m_format(format), m_xRes(xRes), m_yRes(yRes), m_pageCount(doc->m_pageCount)
+{
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), maxExportThreads));
+
+    m_window = m_pool.maxThreadCount() * pagesPerThread;
+}
+
+DPdfTextExporter::~DPdfTextExporter()
+{
+    m_cancelled.store(1);
+
+    m_mutex.lock();
+    m_condition.wakeAll();
+    m_mutex.unlock();
+
+    m_pool.waitForDone();
+}
+
+bool DPdfTextExporter::run()
+{
+    const int workers = qMin(m_pool.maxThreadCount(), m_pageCount);
+
+    for (int i = 0; i < workers; ++i)
+        m_pool.start(new DPdfTextExportWorker(this));
+
+    QMutexLocker locker(&m_mutex);
+
+    while (m_nextWriteIndex < m_pageCount) {
+        if (!m_donePages.contains(m_nextWriteIndex)) {
+            m_condition.wait(&m_mutex);
+            continue;
+        }
+
+        const QByteArray &data = m_donePages.take(m_nextWriteIndex);
+
+        ++m_nextWriteIndex;
+
+        m_condition.wakeAll();
+
+        //写入时不阻塞工作线程
+        locker.unlock();
+
+        const bool written = m_device->write(data) == data.size();
+
+        locker.relock();
+
+        if (!written) {
+            m_cancelled.store(1);
+            m_condition.wakeAll();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DPdfTextExporter::exportPages()
+{
+    while (!m_cancelled.load()) {
+        const int index = m_nextIndex.fetchAndAddOrdered(1);
+
+        if (index >= m_pageCount)
+            break;
+
+        {
+            //领先写入位置过多时等待,已完成的页面不会无限堆积
+            QMutexLocker locker(&m_mutex);
+
+            while (!m_cancelled.load() && index >= m_nextWriteIndex + m_window)
+                m_condition.wait(&m_mutex);
+        }
+
+        if (m_cancelled.load())
+            break;
+
+        const QByteArray &data = formatPage(index);
+
+        QMutexLocker locker(&m_mutex);
+
+        m_donePages.insert(index, data);
+
+        m_condition.wakeAll();
+    }
+}
+
+QByteArray DPdfTextExporter::formatPage(int index) const
+{
+    QString text;
+    QVector<QRectF> rects;
+    QSizeF size;
+
+    const bool isJson = (DPdfDoc::TEXT_JSON == m_format);
+
+    //页面不可用时输出空页,保持页序
+    if (!m_docPrivate->extractPageText(index, m_xRes, m_yRes, text, isJson ? &rects : nullptr, isJson ? &size : nullptr))
+        text.clear();
+
+    if (isJson)
+        return formatJson(index, text, rects, size);
+
+    text.replace(QLatin1String("\r\n"), QLatin1String("\n"));
+
+    //与pdftotext一致,每页以换页符结束
+    text.append(QLatin1Char('\f'));
+
+    return text.toUtf8();
+}
+
+QByteArray DPdfTextExporter::formatJson(int index, const QString &text, const QVector<QRectF> &rects, const QSizeF &size) const
+{
+    const QVector<TextLine> &lines = splitLines(text, rects);
+
+    QJsonArray blocks;
+
+    QJsonArray blockLines;
+
+    QRectF blockRect;
+
+    QRectF lastRect;
+
+    for (const TextLine &line : lines) {
+        if (!blockLines.isEmpty() && !isSameBlock(blockRect, lastRect, line.rect)) {
+            blocks.append(QJsonObject{{"rect", rectToJson(blockRect)}, {"lines", blockLines}});
+
+            blockLines = QJsonArray();
+            blockRect = QRectF();
+        }
+
+        blockLines.append(QJsonObject{{"rect", rectToJson(line.rect)}, {"text", line.text}});
+
+        blockRect |= line.rect;
+
+        lastRect = line.rect;
+    }
+
+    if (!blockLines.isEmpty())
+        blocks.append(QJsonObject{{"rect", rectToJson(blockRect)}, {"lines", blockLines}});
+
+    const QJsonObject page{{"page", index},
+                           {"width", size.width()},
+                           {"height", size.height()},
+                           {"blocks", blocks}};
+
+    //JSON Lines 每页一行
+    return QJsonDocument(page).toJson(QJsonDocument::Compact) + '\n';
+}
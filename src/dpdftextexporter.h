@@ -0,0 +1,77 @@
+#ifndef DPDFTEXTEXPORTER_H
+#define DPDFTEXTEXPORTER_H
+
+#include "dpdfdoc.h"
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class QIODevice;
+class DPdfDocPrivate;
+/**
+ * @brief 整个文档的文字导出 多个线程逐页提取和格式化,调用线程按页序写入设备
+ * 页面临时加载,提取后立即释放;已完成未写入的页面数有上限,内存占用与页数无关
+ */
+class DPdfTextExporter
+{
+public:
+    DPdfTextExporter(DPdfDocPrivate *doc, QIODevice *device, DPdfDoc::TextFormat format, qreal xRes, qreal yRes);
+
+    ~DPdfTextExporter();
+
+    /**
+     * @brief 阻塞直到所有页面写入或写入失败
+     * @return 写入失败返回false
+     */
+    bool run();
+
+    /**
+     * @brief 工作线程 依次领取页面,领先写入位置过多时等待
+     */
+    void exportPages();
+
+private:
+    /**
+     * @brief 一页的输出内容
+     */
+    QByteArray formatPage(int index) const;
+
+    QByteArray formatJson(int index, const QString &text, const QVector<QRectF> &rects, const QSizeF &size) const;
+
+private:
+    DPdfDocPrivate *m_docPrivate = nullptr;
+
+    QIODevice *m_device = nullptr;
+
+    DPdfDoc::TextFormat m_format;
+
+    qreal m_xRes = 72;
+
+    qreal m_yRes = 72;
+
+    int m_pageCount = 0;
+
+    //已完成未写入的页面数上限
+    int m_window = 0;
+
+    QThreadPool m_pool;
+
+    QAtomicInt m_nextIndex;
+
+    QAtomicInt m_cancelled;
+
+    QMutex m_mutex;
+
+    //页面完成或写入位置前进
+    QWaitCondition m_condition;
+
+    QMap<int, QByteArray> m_donePages;
+
+    int m_nextWriteIndex = 0;
+};
+
+#endif // DPDFTEXTEXPORTER_H
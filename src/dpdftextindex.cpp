@@ -0,0 +1,388 @@
+#include "dpdftextindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+
+#include <algorithm>
+
+namespace {
+
+const quint32 indexMagic = 0x44504958;
+
+const quint32 indexVersion = 1;
+
+//计算摘要时读取的文件首尾大小
+const qint64 hashBlockSize = 64 * 1024;
+
+//词表n元组的最大长度 更长的关键字取各三元组候选词中最少的一组再确认
+const int gramSize = 3;
+
+//这些文字词之间通常没有空格,每个字单独成词
+inline bool isSingleCharTerm(const QChar &ch)
+{
+    switch (ch.script()) {
+    case QChar::Script_Han:
+    case QChar::Script_Hiragana:
+    case QChar::Script_Katakana:
+        return true;
+    default:
+        return false;
+    }
+}
+
+inline bool isTermChar(const QChar &ch)
+{
+    return ch.isLetterOrNumber() || ch.isMark() || ch == QLatin1Char('_');
+}
+
+/**
+ * @brief 切分词 对每个词回调callback(start, end)
+ */
+template<typename Callback>
+void tokenize(const QString &text, Callback callback)
+{
+    const int size = text.size();
+
+    int start = -1;
+
+    for (int i = 0; i < size; ++i) {
+        const QChar &ch = text[i];
+
+        if (isSingleCharTerm(ch)) {
+            if (start >= 0)
+                callback(start, i);
+
+            callback(i, i + 1);
+            start = -1;
+        } else if (isTermChar(ch)) {
+            if (start < 0)
+                start = i;
+        } else if (start >= 0) {
+            callback(start, i);
+            start = -1;
+        }
+    }
+
+    if (start >= 0)
+        callback(start, size);
+}
+
+//与QString::indexOf(Qt::CaseInsensitive)一致,逐字符折叠
+QString foldCase(const QChar *data, int length)
+{
+    QString term(length, Qt::Uninitialized);
+
+    QChar *out = term.data();
+
+    for (int i = 0; i < length; ++i)
+        out[i] = data[i].toCaseFolded();
+
+    return term;
+}
+
+void appendVarint(QByteArray &data, quint32 value)
+{
+    while (value >= 0x80) {
+        data.append(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    data.append(static_cast<char>(value));
+}
+
+bool readVarint(const char *&pos, const char *end, quint32 &value)
+{
+    value = 0;
+
+    for (int shift = 0; pos < end && shift < 32; shift += 7) {
+        const quint8 byte = static_cast<quint8>(*pos++);
+
+        value |= static_cast<quint32>(byte & 0x7F) << shift;
+
+        if (!(byte & 0x80))
+            return true;
+    }
+
+    return false;
+}
+
+}
+
+DPdfTextIndex::DPdfTextIndex(int pageCount)
+    : m_pageCount(pageCount), m_indexedPages(pageCount, false)
+{
+}
+
+bool DPdfTextIndex::fileKey(const QString &filePath, int pageCount, Key &key)
+{
+    QFile file(filePath);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    key.size = file.size();
+    key.modified = QFileInfo(file).lastModified().toMSecsSinceEpoch();
+    key.pageCount = pageCount;
+
+    //对大文件计算完整摘要耗时过长,取首尾内容,配合大小和修改时间识别文件
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData(file.read(hashBlockSize));
+
+    if (key.size > hashBlockSize) {
+        if (!file.seek(qMax(hashBlockSize, key.size - hashBlockSize)))
+            return false;
+
+        hash.addData(file.read(hashBlockSize));
+    }
+
+    key.hash = hash.result();
+
+    return true;
+}
+
+QString DPdfTextIndex::indexFilePath(const QString &indexDir, const QString &filePath)
+{
+    const QByteArray &name = QCryptographicHash::hash(QFileInfo(filePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+
+    return QDir(indexDir).filePath(QString::fromLatin1(name) + QStringLiteral(".idx"));
+}
+
+void DPdfTextIndex::addPage(int page, const QString &text)
+{
+    if (page < 0 || page >= m_pageCount)
+        return;
+
+    tokenize(text, [&](int start, int end) {
+        Postings &postings = m_terms[foldCase(text.constData() + start, end - start)];
+
+        if (postings.lastPage != page) {
+            appendVarint(postings.data, static_cast<quint32>(page - postings.lastPage));
+            appendVarint(postings.data, static_cast<quint32>(start));
+        } else {
+            appendVarint(postings.data, 0);
+            appendVarint(postings.data, static_cast<quint32>(start - postings.lastChar));
+        }
+
+        postings.lastPage = page;
+        postings.lastChar = start;
+    });
+
+    m_indexedPages[page] = true;
+}
+
+bool DPdfTextIndex::isComplete() const
+{
+    return !m_indexedPages.contains(false);
+}
+
+void DPdfTextIndex::buildVocabulary()
+{
+    m_vocabulary = m_terms.keys().toVector();
+
+    std::sort(m_vocabulary.begin(), m_vocabulary.end());
+
+    m_grams.clear();
+
+    for (int id = 0; id < m_vocabulary.size(); ++id) {
+        const QString &term = m_vocabulary[id];
+
+        for (int length = 1; length <= gramSize; ++length) {
+            for (int start = 0; start + length <= term.size(); ++start) {
+                QVector<int> &ids = m_grams[term.mid(start, length)];
+
+                //同一词中重复的子串只记一次,词按下标递增加入,列表保持升序
+                if (ids.isEmpty() || ids.last() != id)
+                    ids.append(id);
+            }
+        }
+    }
+
+    for (auto it = m_grams.begin(); it != m_grams.end(); ++it)
+        it.value().squeeze();
+}
+
+const QVector<int> *DPdfTextIndex::gramCandidates(const QString &term) const
+{
+    if (term.size() <= gramSize) {
+        auto it = m_grams.constFind(term);
+
+        return it != m_grams.constEnd() ? &it.value() : nullptr;
+    }
+
+    const QVector<int> *smallest = nullptr;
+
+    for (int start = 0; start + gramSize <= term.size(); ++start) {
+        auto it = m_grams.constFind(term.mid(start, gramSize));
+
+        //任一三元组不在词表中,不可能有词包含term
+        if (it == m_grams.constEnd())
+            return nullptr;
+
+        if (nullptr == smallest || it.value().size() < smallest->size())
+            smallest = &it.value();
+    }
+
+    return smallest;
+}
+
+void DPdfTextIndex::markPages(const Postings &postings, QVector<bool> &pages) const
+{
+    const char *pos = postings.data.constData();
+    const char *end = pos + postings.data.size();
+
+    int page = -1;
+
+    quint32 pageDelta = 0;
+    quint32 charIndex = 0;
+
+    while (readVarint(pos, end, pageDelta) && readVarint(pos, end, charIndex)) {
+        page += static_cast<int>(pageDelta);
+
+        if (page >= 0 && page < pages.size())
+            pages[page] = true;
+    }
+}
+
+QVector<bool> DPdfTextIndex::candidatePages(const QString &text) const
+{
+    QVector<bool> result(m_pageCount, true);
+
+    //关键字在页面中出现时,关键字内部以分隔符为界的词在页面中必为完整的词,首尾的词可能只是页面中词的后缀或前缀
+    tokenize(text, [&](int start, int end) {
+        const QString &term = foldCase(text.constData() + start, end - start);
+
+        const bool single = (end - start == 1 && isSingleCharTerm(text[start]));
+        const bool boundedLeft = single || start > 0;
+        const bool boundedRight = single || end < text.size();
+
+        QVector<bool> pages(m_pageCount, false);
+
+        if (boundedLeft && boundedRight) {
+            auto it = m_terms.constFind(term);
+
+            if (it != m_terms.constEnd())
+                markPages(it.value(), pages);
+        } else if (boundedLeft) {
+            //以term为前缀的词在有序词表中连续
+            for (auto it = std::lower_bound(m_vocabulary.constBegin(), m_vocabulary.constEnd(), term);
+                    it != m_vocabulary.constEnd() && it->startsWith(term); ++it)
+                markPages(m_terms.value(*it), pages);
+        } else {
+            const QVector<int> *candidates = gramCandidates(term);
+
+            //不超过gramSize的term,候选词都包含它,无需再确认
+            const bool exact = (term.size() <= gramSize);
+
+            if (nullptr != candidates) {
+                for (int id : *candidates) {
+                    const QString &key = m_vocabulary[id];
+
+                    const bool matched = boundedRight ? key.endsWith(term) : (exact || key.contains(term));
+
+                    if (matched)
+                        markPages(m_terms.value(key), pages);
+                }
+            }
+        }
+
+        for (int i = 0; i < m_pageCount; ++i)
+            result[i] = result[i] && (pages[i] || !m_indexedPages[i]);
+    });
+
+    return result;
+}
+
+bool DPdfTextIndex::save(const QString &path, const Key &key) const
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+
+    QSaveFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << indexMagic << indexVersion;
+    stream << key.size << key.modified << key.hash << static_cast<qint32>(key.pageCount);
+    stream << m_indexedPages;
+    stream << static_cast<quint32>(m_terms.size());
+
+    for (auto it = m_terms.constBegin(); it != m_terms.constEnd(); ++it)
+        stream << it.key() << it.value().data;
+
+    if (QDataStream::Ok != stream.status()) {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
+
+bool DPdfTextIndex::load(const QString &path, const Key &key)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+
+    stream >> magic >> version;
+
+    if (indexMagic != magic || indexVersion != version)
+        return false;
+
+    Key fileKey;
+    qint32 pageCount = 0;
+
+    stream >> fileKey.size >> fileKey.modified >> fileKey.hash >> pageCount;
+
+    fileKey.pageCount = pageCount;
+
+    //文件已改变,索引作废
+    if (!(fileKey == key))
+        return false;
+
+    QVector<bool> indexedPages;
+    quint32 termCount = 0;
+
+    stream >> indexedPages >> termCount;
+
+    if (QDataStream::Ok != stream.status() || indexedPages.size() != key.pageCount)
+        return false;
+
+    QHash<QString, Postings> terms;
+    terms.reserve(static_cast<int>(qMin<quint32>(termCount, 1 << 24)));
+
+    for (quint32 i = 0; i < termCount; ++i) {
+        QString term;
+        Postings postings;
+
+        stream >> term >> postings.data;
+
+        if (QDataStream::Ok != stream.status())
+            return false;
+
+        terms.insert(term, postings);
+    }
+
+    m_pageCount = key.pageCount;
+    m_indexedPages = indexedPages;
+    m_terms.swap(terms);
+
+    buildVocabulary();
+
+    return true;
+}
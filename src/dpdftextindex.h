@@ -0,0 +1,106 @@
+#ifndef DPDFTEXTINDEX_H
+#define DPDFTEXTINDEX_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 全文倒排索引 词->(页索引,页内字符索引)
+ * 连续的字母数字为一个词,汉字假名等每个字单独成词,按字符做大小写折叠,与搜索时的匹配规则一致
+ * 索引只用于排除不可能命中的页面,命中位置仍以实际匹配为准
+ */
+class DPdfTextIndex
+{
+public:
+    /**
+     * @brief 索引对应的文件 文件大小,修改时间和首尾内容的摘要都一致时索引才有效
+     */
+    struct Key {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray hash;
+        int pageCount = 0;
+
+        bool operator==(const Key &other) const
+        {
+            return size == other.size && modified == other.modified && hash == other.hash && pageCount == other.pageCount;
+        }
+    };
+
+    explicit DPdfTextIndex(int pageCount = 0);
+
+    /**
+     * @brief 计算文件的索引键
+     * @return 文件无法读取时返回false
+     */
+    static bool fileKey(const QString &filePath, int pageCount, Key &key);
+
+    /**
+     * @brief 索引文件路径 按文档绝对路径命名
+     */
+    static QString indexFilePath(const QString &indexDir, const QString &filePath);
+
+    /**
+     * @brief 加入一页文字,页面需按索引递增的顺序加入
+     * @param page
+     * @param text 每个字符一个QChar
+     */
+    void addPage(int page, const QString &text);
+
+    /**
+     * @brief 所有页面都已加入索引
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief 建立查询用的有序词表和词的n元组表 加入页面后,开始查询前调用一次,load()会自动调用
+     */
+    void buildVocabulary();
+
+    /**
+     * @brief 可能包含text的页面 未加入索引的页面视为可能包含
+     * 关键字首尾的词只是页面中词的一部分时,前缀在有序词表中二分查找,后缀和子串通过n元组表取候选词,不遍历词表
+     * @param text 搜索关键字
+     * @return 按页索引
+     */
+    QVector<bool> candidatePages(const QString &text) const;
+
+    bool save(const QString &path, const Key &key) const;
+
+    bool load(const QString &path, const Key &key);
+
+private:
+    struct Postings {
+        //变长整数编码 每项为(页索引差值,字符索引或同页内的差值)
+        QByteArray data;
+        int lastPage = -1;
+        int lastChar = 0;
+    };
+
+    /**
+     * @brief 将term的所有页面标记到pages
+     */
+    void markPages(const Postings &postings, QVector<bool> &pages) const;
+
+    /**
+     * @brief 词表中包含term的候选词 长度不超过gramSize时全部包含term,更长时还需逐个确认
+     */
+    const QVector<int> *gramCandidates(const QString &term) const;
+
+private:
+    int m_pageCount = 0;
+
+    QVector<bool> m_indexedPages;
+
+    QHash<QString, Postings> m_terms;
+
+    //折叠后的所有词 升序
+    QVector<QString> m_vocabulary;
+
+    //长度1到gramSize的子串->包含它的词在m_vocabulary中的下标 升序
+    QHash<QString, QVector<int>> m_grams;
+};
+
+#endif // DPDFTEXTINDEX_H
@@ -0,0 +1,435 @@
+#include "dpdftilerenderer.h"
+#include "dpdfdoc.h"
+#include "dpdfpage.h"
+
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QPointer>
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+
+#include <climits>
+
+namespace {
+
+//缩放比例取整后参与比较,避免浮点误差导致缓存不命中
+const int scalePrecision = 10000;
+
+const int defaultTileSize = 256;
+
+//QCache的cost为int,以KB为单位记录
+const qint64 defaultCacheBudget = 128 * 1024 * 1024;
+
+struct DPdfTileKey {
+    const DPdfDoc *doc;
+    int pageIndex;
+    //缩放1.0对应的分辨率,同一文档的不同渲染器可以使用不同分辨率
+    int xRes;
+    int yRes;
+    int scale;
+    int tileSize;
+    int column;
+    int row;
+
+    bool operator==(const DPdfTileKey &other) const
+    {
+        return doc == other.doc && pageIndex == other.pageIndex && xRes == other.xRes && yRes == other.yRes && scale == other.scale
+               && tileSize == other.tileSize && column == other.column && row == other.row;
+    }
+};
+
+inline uint qHash(const DPdfTileKey &key, uint seed = 0)
+{
+    seed = ::qHash(key.doc, seed);
+    seed = ::qHash(key.pageIndex, seed) ^ (seed << 1);
+    seed = ::qHash(key.xRes, seed) ^ (seed << 1);
+    seed = ::qHash(key.yRes, seed) ^ (seed << 1);
+    seed = ::qHash(key.scale, seed) ^ (seed << 1);
+    seed = ::qHash(key.tileSize, seed) ^ (seed << 1);
+    seed = ::qHash(key.column, seed) ^ (seed << 1);
+    return ::qHash(key.row, seed) ^ (seed << 1);
+}
+
+/**
+ * @brief 进程内共享的分块缓存,按最近使用淘汰
+ */
+class DPdfTileCache
+{
+public:
+    DPdfTileCache()
+    {
+        m_cache.setMaxCost(static_cast<int>(defaultCacheBudget / 1024));
+    }
+
+    bool find(const DPdfTileKey &key, QImage &image)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        QImage *cached = m_cache.object(key);
+
+        if (nullptr == cached)
+            return false;
+
+        image = *cached;
+
+        return true;
+    }
+
+    /**
+     * @brief 每次清除后递增,渲染开始前取得,插入时不一致说明渲染期间缓存已被清除
+     */
+    quint64 generation()
+    {
+        QMutexLocker locker(&m_mutex);
+
+        return m_generation;
+    }
+
+    void insert(const DPdfTileKey &key, const QImage &image, quint64 generation)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        //渲染期间文档内容已改变,结果可能已过期
+        if (generation != m_generation)
+            return;
+
+        int cost = qMax(1, static_cast<int>(image.sizeInBytes() / 1024));
+
+        m_cache.insert(key, new QImage(image), cost);
+    }
+
+    /**
+     * @brief pageIndex小于0时清除整个文档
+     */
+    void clear(const DPdfDoc *doc, int pageIndex)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        ++m_generation;
+
+        const QList<DPdfTileKey> &keys = m_cache.keys();
+
+        for (const DPdfTileKey &key : keys) {
+            if (key.doc == doc && (pageIndex < 0 || key.pageIndex == pageIndex))
+                m_cache.remove(key);
+        }
+    }
+
+    void setBudget(qint64 bytes)
+    {
+        QMutexLocker locker(&m_mutex);
+
+        m_cache.setMaxCost(static_cast<int>(qBound<qint64>(0, bytes / 1024, INT_MAX)));
+    }
+
+    qint64 budget()
+    {
+        QMutexLocker locker(&m_mutex);
+
+        return static_cast<qint64>(m_cache.maxCost()) * 1024;
+    }
+
+private:
+    QMutex m_mutex;
+    QCache<DPdfTileKey, QImage> m_cache;
+    quint64 m_generation = 0;
+};
+
+Q_GLOBAL_STATIC(DPdfTileCache, tileCache)
+
+}
+
+class DPdfTileRendererPrivate
+{
+    friend class DPdfTileRenderer;
+    friend class DPdfTilePrefetchTask;
+
+public:
+    DPdfTileRendererPrivate(DPdfTileRenderer *q, DPdfDoc *doc, qreal xRes, qreal yRes);
+
+    DPdfTileKey key(int pageIndex, qreal scale, int column, int row) const;
+
+    /**
+     * @brief 页面缩放后的像素大小
+     */
+    QSize pageSize(DPdfPage *page, qreal scale) const;
+
+    /**
+     * @brief 渲染单个分块并存入缓存
+     */
+    QImage renderTile(const DPdfTileKey &key, qreal scale);
+
+    /**
+     * @brief 分块已在缓存或已排队预取时返回false
+     */
+    bool schedule(const DPdfTileKey &key, qreal scale);
+
+    void finished(const DPdfTileKey &key);
+
+private:
+    DPdfTileRenderer *q_ptr = nullptr;
+    DPdfDoc *m_doc = nullptr;
+    qreal m_xRes = 72;
+    qreal m_yRes = 72;
+    int m_tileSize = defaultTileSize;
+
+    QThreadPool m_pool;
+    QMutex m_pendingMutex;
+    QSet<DPdfTileKey> m_pending;
+};
+
+class DPdfTilePrefetchTask : public QRunnable
+{
+public:
+    DPdfTilePrefetchTask(DPdfTileRendererPrivate *renderer, const DPdfTileKey &key, qreal scale)
+        : m_renderer(renderer), m_key(key), m_scale(scale)
+    {
+    }
+
+    void run() override
+    {
+        m_renderer->renderTile(m_key, m_scale);
+
+        m_renderer->finished(m_key);
+
+        emit m_renderer->q_ptr->tileReady(m_key.pageIndex, m_scale, m_key.column, m_key.row);
+    }
+
+private:
+    DPdfTileRendererPrivate *m_renderer = nullptr;
+    DPdfTileKey m_key;
+    qreal m_scale = 1;
+};
+
+DPdfTileRendererPrivate::DPdfTileRendererPrivate(DPdfTileRenderer *q, DPdfDoc *doc, qreal xRes, qreal yRes)
+    : q_ptr(q), m_doc(doc), m_xRes(xRes), m_yRes(yRes)
+{
+    //同一文档的渲染在文档锁上串行,过多线程只会等待
+    m_pool.setMaxThreadCount(1);
+}
+
+DPdfTileKey DPdfTileRendererPrivate::key(int pageIndex, qreal scale, int column, int row) const
+{
+    return DPdfTileKey{m_doc, pageIndex, qRound(m_xRes * scalePrecision), qRound(m_yRes * scalePrecision),
+                       qRound(scale * scalePrecision), m_tileSize, column, row};
+}
+
+QSize DPdfTileRendererPrivate::pageSize(DPdfPage *page, qreal scale) const
+{
+    const QSizeF &size = page->sizeF();
+
+    return QSize(qRound(size.width() * scale), qRound(size.height() * scale));
+}
+
+QImage DPdfTileRendererPrivate::renderTile(const DPdfTileKey &key, qreal scale)
+{
+    QImage image;
+
+    if (tileCache->find(key, image))
+        return image;
+
+    const quint64 generation = tileCache->generation();
+
+    DPdfPage *page = m_doc->page(key.pageIndex, m_xRes, m_yRes);
+
+    if (nullptr == page)
+        return QImage();
+
+    const QSize &size = pageSize(page, scale);
+
+    const QRect &tileRect = QRect(key.column * key.tileSize, key.row * key.tileSize, key.tileSize, key.tileSize)
+                            & QRect(QPoint(0, 0), size);
+
+    if (tileRect.isEmpty())
+        return QImage();
+
+    image = page->image(size.width(), size.height(), tileRect);
+
+    if (!image.isNull())
+        tileCache->insert(key, image, generation);
+
+    return image;
+}
+
+bool DPdfTileRendererPrivate::schedule(const DPdfTileKey &key, qreal scale)
+{
+    QImage image;
+
+    if (tileCache->find(key, image))
+        return false;
+
+    QMutexLocker locker(&m_pendingMutex);
+
+    if (m_pending.contains(key))
+        return false;
+
+    m_pending.insert(key);
+
+    locker.unlock();
+
+    m_pool.start(new DPdfTilePrefetchTask(this, key, scale));
+
+    return true;
+}
+
+void DPdfTileRendererPrivate::finished(const DPdfTileKey &key)
+{
+    QMutexLocker locker(&m_pendingMutex);
+
+    m_pending.remove(key);
+}
+
+DPdfTileRenderer::DPdfTileRenderer(DPdfDoc *doc, qreal xRes, qreal yRes, QObject *parent)
+    : QObject(parent), d_ptr(new DPdfTileRendererPrivate(this, doc, xRes, yRes))
+{
+    if (nullptr != doc) {
+        //文档销毁后其分块不会再命中,及时释放
+        connect(doc, &QObject::destroyed, [doc]() {
+            DPdfTileRenderer::clearCache(doc);
+        });
+    }
+}
+
+DPdfTileRenderer::~DPdfTileRenderer()
+{
+    cancelPrefetch();
+
+    d_func()->m_pool.waitForDone();
+}
+
+void DPdfTileRenderer::setTileSize(int size)
+{
+    if (size <= 0 || size == d_func()->m_tileSize)
+        return;
+
+    cancelPrefetch();
+
+    d_func()->m_tileSize = size;
+}
+
+int DPdfTileRenderer::tileSize() const
+{
+    return d_func()->m_tileSize;
+}
+
+QImage DPdfTileRenderer::tile(int pageIndex, qreal scale, int column, int row)
+{
+    if (nullptr == d_func()->m_doc || scale <= 0 || column < 0 || row < 0)
+        return QImage();
+
+    return d_func()->renderTile(d_func()->key(pageIndex, scale, column, row), scale);
+}
+
+QImage DPdfTileRenderer::image(int pageIndex, qreal scale, const QRect &rect)
+{
+    if (nullptr == d_func()->m_doc || scale <= 0)
+        return QImage();
+
+    DPdfPage *page = d_func()->m_doc->page(pageIndex, d_func()->m_xRes, d_func()->m_yRes);
+
+    if (nullptr == page)
+        return QImage();
+
+    const QRect &area = rect & QRect(QPoint(0, 0), d_func()->pageSize(page, scale));
+
+    if (area.isEmpty())
+        return QImage();
+
+    QImage image(area.size(), QImage::Format_ARGB32);
+
+    if (image.isNull())
+        return QImage();
+
+    image.fill(0xFFFFFFFF);
+
+    const int tileSize = d_func()->m_tileSize;
+
+    QPainter painter(&image);
+
+    for (int row = area.top() / tileSize; row <= area.bottom() / tileSize; ++row) {
+        for (int column = area.left() / tileSize; column <= area.right() / tileSize; ++column) {
+            const QImage &tileImage = tile(pageIndex, scale, column, row);
+
+            if (!tileImage.isNull())
+                painter.drawImage(QPoint(column * tileSize, row * tileSize) - area.topLeft(), tileImage);
+        }
+    }
+
+    painter.end();
+
+    prefetch(pageIndex, scale, area);
+
+    return image;
+}
+
+void DPdfTileRenderer::prefetch(int pageIndex, qreal scale, const QRect &rect)
+{
+    if (nullptr == d_func()->m_doc || scale <= 0 || rect.isEmpty())
+        return;
+
+    const int tileSize = d_func()->m_tileSize;
+
+    const int pageCount = d_func()->m_doc->pageCount();
+
+    //当前页周边一圈,相邻页面同一区域
+    const QList<int> pageIndexes = {pageIndex, pageIndex + 1, pageIndex - 1};
+
+    for (int index : pageIndexes) {
+        if (index < 0 || index >= pageCount)
+            continue;
+
+        DPdfPage *page = d_func()->m_doc->page(index, d_func()->m_xRes, d_func()->m_yRes);
+
+        if (nullptr == page)
+            continue;
+
+        const QSize &size = d_func()->pageSize(page, scale);
+
+        const int margin = (index == pageIndex) ? 1 : 0;
+
+        const int firstColumn = qMax(0, rect.left() / tileSize - margin);
+        const int lastColumn = qMin((size.width() - 1) / tileSize, rect.right() / tileSize + margin);
+        const int firstRow = qMax(0, rect.top() / tileSize - margin);
+        const int lastRow = qMin((size.height() - 1) / tileSize, rect.bottom() / tileSize + margin);
+
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                d_func()->schedule(d_func()->key(index, scale, column, row), scale);
+            }
+        }
+    }
+}
+
+void DPdfTileRenderer::cancelPrefetch()
+{
+    d_func()->m_pool.clear();
+
+    //已移除的任务不会再执行,正在执行的任务结束时自行移除
+    QMutexLocker locker(&d_func()->m_pendingMutex);
+
+    d_func()->m_pending.clear();
+}
+
+void DPdfTileRenderer::setCacheBudget(qint64 bytes)
+{
+    tileCache->setBudget(bytes);
+}
+
+qint64 DPdfTileRenderer::cacheBudget()
+{
+    return tileCache->budget();
+}
+
+void DPdfTileRenderer::clearCache(const DPdfDoc *doc)
+{
+    tileCache->clear(doc, -1);
+}
+
+void DPdfTileRenderer::clearCache(const DPdfDoc *doc, int pageIndex)
+{
+    tileCache->clear(doc, pageIndex);
+}
@@ -24,15 +24,33 @@ public_headers += \
     $$PWD/../include/dpdfglobal.h \
     $$PWD/../include/dpdfdoc.h \
     $$PWD/../include/dpdfpage.h \
-    $$PWD/../include/dpdfannot.h
-
-HEADERS += $$public_headers
+    $$PWD/../include/dpdfannot.h \
+    $$PWD/../include/dpdftilerenderer.h \
+    $$PWD/../include/dpdfrendertask.h \
+    $$PWD/../include/dpdfsearchtask.h
+
+HEADERS += $$public_headers \
+    $$PWD/dpdfdoc_p.h \
+    $$PWD/dpdfpage_p.h \
+    $$PWD/dpdfrendertask_p.h \
+    $$PWD/dpdfsearchtask_p.h \
+    $$PWD/dpdftextindex.h \
+    $$PWD/dpdfgridindex.h \
+    $$PWD/dpdfpatternmatcher.h \
+    $$PWD/dpdftextexporter.h
 
 SOURCES += \
     $$PWD/dpdfglobal.cpp \
     $$PWD/dpdfdoc.cpp \
     $$PWD/dpdfpage.cpp \
-    $$PWD/dpdfannot.cpp
+    $$PWD/dpdfannot.cpp \
+    $$PWD/dpdftilerenderer.cpp \
+    $$PWD/dpdfrendertask.cpp \
+    $$PWD/dpdfsearchtask.cpp \
+    $$PWD/dpdftextindex.cpp \
+    $$PWD/dpdfgridindex.cpp \
+    $$PWD/dpdfpatternmatcher.cpp \
+    $$PWD/dpdftextexporter.cpp
 
 target.path  = /usr/lib
 